@@ -0,0 +1,102 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+#include "certificate_chain.h"
+#include "decrypted_kdm.h"
+#include "encrypted_kdm.h"
+#include "util.h"
+#include <sys/time.h>
+#include <iostream>
+
+
+using std::cerr;
+using std::cout;
+using std::make_shared;
+using std::vector;
+
+
+static double
+now()
+{
+	struct timeval t;
+	gettimeofday(&t, 0);
+	return t.tv_sec + t.tv_usec / 1e6;
+}
+
+
+/** Run some basic benchmarks of KDM generation.  This must be run from the top of the libdcp source tree
+ *  as it uses KDMs and certificates from test/data.
+ */
+int
+main(int argc, char* argv[])
+{
+	if (argc > 2) {
+		cerr << "Syntax: " << argv[0] << " [number-of-kdms]\n";
+		exit(EXIT_FAILURE);
+	}
+
+	int const count = argc == 2 ? atoi(argv[1]) : 1000;
+
+	dcp::init();
+
+	dcp::DecryptedKDM decrypted(
+		dcp::EncryptedKDM(
+			dcp::file_to_string("test/data/kdm_TONEPLATES-SMPTE-ENC_.smpte-430-2.ROOT.NOT_FOR_PRODUCTION_20130706_20230702_CAR_OV_t1_8971c838.xml")
+			),
+		dcp::file_to_string("test/data/private.key")
+		);
+
+	auto signer = make_shared<dcp::CertificateChain>(dcp::file_to_string("test/data/certificate_chain"));
+	signer->set_key(dcp::file_to_string("test/data/private.key"));
+
+	vector<dcp::KDMRecipient> recipients;
+	for (int i = 0; i < count; ++i) {
+		recipients.push_back(dcp::KDMRecipient(signer->leaf()));
+	}
+
+	auto start = now();
+	for (int i = 0; i < count; ++i) {
+		decrypted.encrypt(signer, signer->leaf(), {}, dcp::Formulation::MODIFIED_TRANSITIONAL_1, true, 0);
+	}
+	cout << "One at a time: " << count / (now() - start) << " KDMs/s.\n";
+
+	start = now();
+	decrypted.encrypt(signer, recipients, dcp::Formulation::MODIFIED_TRANSITIONAL_1, true, 0, 1);
+	cout << "Batch, 1 thread: " << count / (now() - start) << " KDMs/s.\n";
+
+	start = now();
+	decrypted.encrypt(signer, recipients, dcp::Formulation::MODIFIED_TRANSITIONAL_1, true, 0);
+	cout << "Batch, all threads: " << count / (now() - start) << " KDMs/s.\n";
+}
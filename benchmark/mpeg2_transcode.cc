@@ -0,0 +1,122 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+#include "ffmpeg_image.h"
+#include "mono_mpeg2_picture_asset.h"
+#include "mono_mpeg2_picture_asset_reader.h"
+#include "mono_mpeg2_picture_frame.h"
+#include "mpeg2_transcode.h"
+#include "util.h"
+#include <sys/time.h>
+#include <iostream>
+#include <vector>
+
+
+using std::cerr;
+using std::cout;
+using std::shared_ptr;
+using std::vector;
+
+
+class Timer
+{
+public:
+	void start()
+	{
+		gettimeofday(&_start, 0);
+	}
+
+	void stop()
+	{
+		struct timeval stop;
+		gettimeofday(&stop, 0);
+		_total += (stop.tv_sec + stop.tv_usec / 1e6) - (_start.tv_sec + _start.tv_usec / 1e6);
+	}
+
+	double get() const
+	{
+		return _total;
+	}
+
+private:
+	double _total = 0;
+	struct timeval _start;
+};
+
+
+static void
+run(dcp::MonoMPEG2PictureAsset& asset, int threads, bool frame_threading)
+{
+	auto reader = asset.start_read();
+	dcp::MPEG2Decompressor decompressor(threads, frame_threading);
+
+	Timer read;
+	Timer decode;
+	int decoded = 0;
+
+	auto const count = asset.intrinsic_duration();
+	for (int64_t i = 0; i < count; ++i) {
+		read.start();
+		auto frame = reader->get_frame(i);
+		read.stop();
+		decode.start();
+		decoded += decompressor.decompress_frame(frame).size();
+		decode.stop();
+	}
+
+	decode.start();
+	decoded += decompressor.flush().size();
+	decode.stop();
+
+	cout << "threads=" << threads << (frame_threading ? " (frame+slice)" : " (slice)") << ":\n";
+	cout << "\tRead:   " << count / read.get() << " fps.\n";
+	cout << "\tDecode: " << decoded / decode.get() << " fps.\n";
+}
+
+
+/** Run some basic benchmarks of MPEG2 reading / decoding */
+int
+main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		cerr << "Syntax: " << argv[0] << " private-test-path\n";
+		exit(EXIT_FAILURE);
+	}
+
+	dcp::MonoMPEG2PictureAsset asset(boost::filesystem::path(argv[1]) / "data" / "mas" / "r2.mxf");
+
+	run(asset, 1, false);
+	run(asset, 0, false);
+	run(asset, 0, true);
+}
@@ -0,0 +1,98 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+#include "interop_text_asset.h"
+#include "text_string.h"
+#include <sys/time.h>
+#include <iostream>
+
+
+using std::cerr;
+using std::cout;
+using std::make_shared;
+using std::vector;
+
+
+static double
+now()
+{
+	struct timeval t;
+	gettimeofday(&t, 0);
+	return t.tv_sec + t.tv_usec / 1e6;
+}
+
+
+/** Time TextAsset::texts_during() being called for every frame of a long feature with lots of subtitles */
+int
+main(int argc, char* argv[])
+{
+	if (argc > 2) {
+		cerr << "Syntax: " << argv[0] << " [number-of-subtitles]\n";
+		exit(EXIT_FAILURE);
+	}
+
+	int const count = argc == 2 ? atoi(argv[1]) : 2500;
+	int const fps = 24;
+	/* Two hours */
+	int const frames = 2 * 60 * 60 * fps;
+
+	srand(1);
+
+	dcp::InteropTextAsset asset;
+	for (int i = 0; i < count; ++i) {
+		/* Spread the subtitles evenly over the feature, each lasting between 1 and 5 seconds */
+		int const in = static_cast<int64_t>(i) * frames / count;
+		int const out = in + fps + rand() % (fps * 4);
+		asset.add(
+			make_shared<dcp::TextString>(
+				boost::optional<std::string>(), false, false, false, dcp::Colour(255, 255, 255), 42, 1,
+				dcp::Time(in, fps, fps), dcp::Time(out, fps, fps),
+				0, dcp::HAlign::CENTER, 0.8, dcp::VAlign::TOP, 0, vector<dcp::Text::VariableZPosition>(),
+				dcp::Direction::LTR, "Hello world", dcp::Effect::NONE, dcp::Colour(0, 0, 0),
+				dcp::Time(), dcp::Time(), 0, vector<dcp::Ruby>()
+				)
+			);
+	}
+
+	for (auto starting: { false, true }) {
+		size_t found = 0;
+		auto const start = now();
+		for (int i = 0; i < frames; ++i) {
+			found += asset.texts_during(dcp::Time(i, fps, fps), dcp::Time(i + 1, fps, fps), starting).size();
+		}
+		auto const taken = now() - start;
+		cout << (starting ? "Starting" : "Overlapping") << ": " << frames / taken << " frames/s (" << found << " texts found).\n";
+	}
+}
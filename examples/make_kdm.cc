@@ -96,7 +96,7 @@ int main()
 		);
 
 	/* Make a certificate chain to sign the KDM */
-	auto signer = std::make_shared<dcp::CertificateChain>("/usr/bin/openssl", 365);
+	auto signer = std::make_shared<dcp::CertificateChain>(365);
 
 	/* Certificate of the recipient projector/media block */
 	dcp::Certificate recipient(recipient_certificate);
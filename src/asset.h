@@ -134,6 +134,11 @@ public:
 	 */
 	std::string hash(boost::function<void (int64_t, int64_t)> progress = {}) const;
 
+	/** @return the hash of this asset's file if it has already been calculated or set, otherwise boost::none */
+	boost::optional<std::string> known_hash() const {
+		return _hash;
+	}
+
 	void set_hash (std::string hash);
 	void unset_hash();
 
@@ -144,14 +149,14 @@ protected:
 
 	static void add_file_to_assetmap (AssetMap& asset_map, boost::filesystem::path root, boost::filesystem::path file, std::string id);
 
+	/** Hash of _file if it has been computed */
+	mutable boost::optional<std::string> _hash;
+
 private:
 	friend struct ::asset_test;
 
 	/** @return type string for PKLs for this asset */
 	virtual std::string pkl_type (Standard standard) const = 0;
-
-	/** Hash of _file if it has been computed */
-	mutable boost::optional<std::string> _hash;
 };
 
 
@@ -0,0 +1,154 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/asset_equality.cc
+ *  @brief Helpers for the equals() methods of assets whose content is in frames.
+ */
+
+
+#include "asset.h"
+#include "asset_equality.h"
+#include "compose.hpp"
+#include "dcp_assert.h"
+#include "equality_options.h"
+#include "filesystem.h"
+#include "mxf.h"
+#include "parallel.h"
+#include "util.h"
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <list>
+#include <mutex>
+
+
+using std::function;
+using std::list;
+using std::make_pair;
+using std::min;
+using std::pair;
+using std::string;
+using namespace dcp;
+
+
+bool
+dcp::asset_files_identical(Asset const& a, Asset const& b, EqualityOptions const& opt, NoteHandler note)
+{
+	DCP_ASSERT(a.file());
+	DCP_ASSERT(b.file());
+
+	boost::system::error_code ec;
+	if (boost::filesystem::equivalent(filesystem::fix_long_path(*a.file()), filesystem::fix_long_path(*b.file()), ec)) {
+		note(NoteType::NOTE, "Asset files are the same file");
+		return true;
+	}
+
+	if (opt.trust_known_hashes && a.known_hash() && b.known_hash()) {
+		if (*a.known_hash() == *b.known_hash()) {
+			note(NoteType::NOTE, "Asset hashes are the same");
+			return true;
+		}
+		return false;
+	}
+
+	auto const size_a = filesystem::file_size(*a.file(), ec);
+	if (ec) {
+		return false;
+	}
+	auto const size_b = filesystem::file_size(*b.file(), ec);
+	if (ec || size_a != size_b) {
+		return false;
+	}
+
+	/* Asset::hash() may be the hash from the PKL rather than one of the file itself,
+	 * so we must hash the files here unless we have been told to trust known hashes.
+	 */
+	auto no_progress = [](int64_t, int64_t) {};
+	if (make_digest(*a.file(), no_progress) == make_digest(*b.file(), no_progress)) {
+		note(NoteType::NOTE, "Asset files are identical");
+		return true;
+	}
+
+	return false;
+}
+
+
+bool
+dcp::same_key_id(MXF const& a, MXF const& b)
+{
+	return a.key_id() && b.key_id() && *a.key_id() == *b.key_id();
+}
+
+
+bool
+dcp::frames_equal(
+	int frames,
+	string name,
+	EqualityOptions const& opt,
+	NoteHandler note,
+	function<function<bool (int, NoteHandler)> ()> make_comparer
+	)
+{
+	/* Each range of frames gets its own readers, so the ranges are big enough that opening
+	 * those readers does not take long compared to reading the frames.
+	 */
+	int const frames_per_range = 48;
+	int const ranges = (frames + frames_per_range - 1) / frames_per_range;
+
+	std::atomic<bool> result(true);
+	std::mutex note_mutex;
+
+	parallel_for(ranges, 0, [&](int range) {
+		auto compare = make_comparer();
+		int const end = min(frames, (range + 1) * frames_per_range);
+		for (int i = range * frames_per_range; i < end; ++i) {
+			if (!result && !opt.keep_going) {
+				return;
+			}
+
+			list<pair<NoteType, string>> notes;
+			if (!compare(i, [&notes](NoteType type, string message) { notes.push_back(make_pair(type, message)); })) {
+				result = false;
+			}
+
+			std::lock_guard<std::mutex> lm(note_mutex);
+			note(NoteType::PROGRESS, String::compose("Compared %1 frame %2 of %3", name, i, frames));
+			for (auto const& j: notes) {
+				note(j.first, j.second);
+			}
+		}
+	});
+
+	return result;
+}
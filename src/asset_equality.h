@@ -0,0 +1,95 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/asset_equality.h
+ *  @brief Helpers for the equals() methods of assets whose content is in frames.
+ */
+
+
+#ifndef LIBDCP_ASSET_EQUALITY_H
+#define LIBDCP_ASSET_EQUALITY_H
+
+
+#include "types.h"
+#include <functional>
+
+
+namespace dcp {
+
+
+class Asset;
+class EqualityOptions;
+class MXF;
+
+
+/** Find out if two assets' files are identical without looking at their content frame by frame.
+ *  This is so if they are the same file, or if both have the same hash.  Hashes that the assets
+ *  already know (perhaps from a PKL) are used only if opt.trust_known_hashes is set; otherwise
+ *  hashes are calculated, but only if the files are the same size.
+ *
+ *  @return true if the files are known to be identical, false if they are not, or we can't tell.
+ */
+bool asset_files_identical(Asset const& a, Asset const& b, EqualityOptions const& opt, NoteHandler note);
+
+
+/** @return true if two MXFs are encrypted with the same key, so that a frame whose encrypted data are the
+ *  same in both must be the same when decrypted.
+ */
+bool same_key_id(MXF const& a, MXF const& b);
+
+
+/** Compare frames 0 to frames - 1 of two assets, dividing the frames into ranges to be compared by different threads.
+ *
+ *  @param frames Number of frames to compare.
+ *  @param name Name of the frames to use in progress notes, e.g. "video".
+ *  @param make_comparer Function which is called once for each range of frames, and returns a function which compares one frame
+ *  of the two assets, giving notes to the supplied handler and returning true if the frames are equal.  All calls to a returned
+ *  function will be made from the same thread, so it can own any readers that it needs.
+ *
+ *  @return true if all frames are equal.
+ */
+bool frames_equal(
+	int frames,
+	std::string name,
+	EqualityOptions const& opt,
+	NoteHandler note,
+	std::function<std::function<bool (int, NoteHandler)> ()> make_comparer
+	);
+
+
+}
+
+
+#endif
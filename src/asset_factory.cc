@@ -42,20 +42,24 @@
 #include "compose.hpp"
 #include "mono_j2k_picture_asset.h"
 #include "mono_mpeg2_picture_asset.h"
+#include "reel_atmos_asset.h"
+#include "reel_mono_picture_asset.h"
+#include "reel_smpte_text_asset.h"
+#include "reel_sound_asset.h"
 #include "smpte_text_asset.h"
 #include "sound_asset.h"
 #include "stereo_j2k_picture_asset.h"
-#include "stereo_j2k_picture_asset.h"
 #include <memory>
 
 
+using std::dynamic_pointer_cast;
 using std::shared_ptr;
 using std::make_shared;
 using namespace dcp;
 
 
 shared_ptr<Asset>
-dcp::asset_factory (boost::filesystem::path path, bool ignore_incorrect_picture_mxf_type, bool* found_threed_marked_as_twod)
+dcp::asset_factory (boost::filesystem::path path, bool ignore_incorrect_picture_mxf_type, bool* found_threed_marked_as_twod, bool lazy)
 {
 	/* XXX: asdcplib does not appear to support discovery of read MXFs standard
 	   (Interop / SMPTE)
@@ -93,7 +97,7 @@ dcp::asset_factory (boost::filesystem::path path, bool ignore_incorrect_picture_
 	case ASDCP::ESS_JPEG_2000_S:
 		return make_shared<StereoJ2KPictureAsset>(path);
 	case ASDCP::ESS_TIMED_TEXT:
-		return make_shared<SMPTETextAsset>(path);
+		return make_shared<SMPTETextAsset>(path, lazy);
 	case ASDCP::ESS_DCDATA_DOLBY_ATMOS:
 		return make_shared<AtmosAsset>(path);
 	default:
@@ -102,3 +106,34 @@ dcp::asset_factory (boost::filesystem::path path, bool ignore_incorrect_picture_
 
 	return {};
 }
+
+
+shared_ptr<Asset>
+dcp::asset_factory (
+	boost::filesystem::path path,
+	shared_ptr<const ReelFileAsset> reference,
+	bool ignore_incorrect_picture_mxf_type,
+	bool* found_threed_marked_as_twod,
+	bool lazy
+	)
+{
+	/* Stereo assets are left to the other asset_factory() so that it can spot 3D assets which are marked as 2D,
+	 * and MPEG2 is rare enough not to be worth guessing.  Any failure here could be because our guess was wrong,
+	 * so it just sends us back to the slow path, which will report any real problem.
+	 */
+	try {
+		if (dynamic_pointer_cast<const ReelMonoPictureAsset>(reference)) {
+			return make_shared<MonoJ2KPictureAsset>(path);
+		} else if (dynamic_pointer_cast<const ReelSoundAsset>(reference)) {
+			return make_shared<SoundAsset>(path);
+		} else if (dynamic_pointer_cast<const ReelSMPTETextAsset>(reference)) {
+			return make_shared<SMPTETextAsset>(path, lazy);
+		} else if (dynamic_pointer_cast<const ReelAtmosAsset>(reference)) {
+			return make_shared<AtmosAsset>(path);
+		}
+	} catch (std::exception&) {
+
+	}
+
+	return asset_factory(path, ignore_incorrect_picture_mxf_type, found_threed_marked_as_twod, lazy);
+}
@@ -45,6 +45,7 @@ namespace dcp {
 
 
 class Asset;
+class ReelFileAsset;
 
 
 /** Create an Asset from a file.
@@ -52,8 +53,28 @@ class Asset;
  *  as 2D; if this is false an exception will be thrown in that case.
  *  @param ignored_incorrect_picture_mxf_type if this is non-null it will be set to true if a 3D asset was
  *  marked as 2D, otherwise it will be left alone.
+ *  @param lazy true to make text assets read their font and image data only when it is first needed.
  */
-std::shared_ptr<Asset> asset_factory (boost::filesystem::path path, bool ignore_incorrect_picture_mxf_type, bool* found_threed_marked_as_twod = nullptr);
+std::shared_ptr<Asset> asset_factory (
+	boost::filesystem::path path,
+	bool ignore_incorrect_picture_mxf_type,
+	bool* found_threed_marked_as_twod = nullptr,
+	bool lazy = false
+	);
+
+
+/** Create an Asset from a file, using a reference to it from a CPL as a hint as to what sort of asset it is.
+ *  If the hint is right the file is opened only once, rather than once to find its type and again to read it.
+ *  If the hint is wrong, or missing, this behaves exactly like the version above.
+ *  @param reference Reel asset from a CPL which refers to this file, or nullptr.
+ */
+std::shared_ptr<Asset> asset_factory (
+	boost::filesystem::path path,
+	std::shared_ptr<const ReelFileAsset> reference,
+	bool ignore_incorrect_picture_mxf_type,
+	bool* found_threed_marked_as_twod = nullptr,
+	bool lazy = false
+	);
 
 
 }
@@ -0,0 +1,97 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/asset_index.cc
+ *  @brief AssetIndex class
+ */
+
+
+#include "asset.h"
+#include "asset_index.h"
+#include "font_asset.h"
+#include <boost/algorithm/string.hpp>
+
+
+using std::dynamic_pointer_cast;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using namespace dcp;
+
+
+static string
+normalise_id(string id)
+{
+	boost::algorithm::to_lower(id);
+	boost::algorithm::trim(id);
+	return id;
+}
+
+
+AssetIndex::AssetIndex(vector<shared_ptr<Asset>> const& assets)
+{
+	add(assets);
+}
+
+
+void
+AssetIndex::add(shared_ptr<Asset> asset)
+{
+	_assets.insert(make_pair(normalise_id(asset->id()), asset));
+	if (dynamic_pointer_cast<FontAsset>(asset)) {
+		_fonts.push_back(asset);
+	}
+}
+
+
+void
+AssetIndex::add(vector<shared_ptr<Asset>> const& assets)
+{
+	for (auto asset: assets) {
+		add(asset);
+	}
+}
+
+
+shared_ptr<Asset>
+AssetIndex::find(string const& id) const
+{
+	auto iter = _assets.find(normalise_id(id));
+	if (iter == _assets.end()) {
+		return {};
+	}
+
+	return iter->second;
+}
@@ -0,0 +1,95 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/asset_index.h
+ *  @brief AssetIndex class
+ */
+
+
+#ifndef LIBDCP_ASSET_INDEX_H
+#define LIBDCP_ASSET_INDEX_H
+
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace dcp {
+
+
+class Asset;
+class FontAsset;
+
+
+/** @class AssetIndex
+ *  @brief A set of assets which can be looked up quickly by ID.
+ *
+ *  IDs are compared in the same way as ids_equal() does, so case and surrounding
+ *  whitespace are ignored.  If more than one asset with the same ID is added, the
+ *  first one is kept.
+ */
+class AssetIndex
+{
+public:
+	AssetIndex() = default;
+
+	explicit AssetIndex(std::vector<std::shared_ptr<Asset>> const& assets);
+
+	void add(std::shared_ptr<Asset> asset);
+
+	void add(std::vector<std::shared_ptr<Asset>> const& assets);
+
+	/** @return the asset with a given ID, or nullptr */
+	std::shared_ptr<Asset> find(std::string const& id) const;
+
+	/** @return all font assets that have been added, in the order they were added (including any
+	 *  which were not kept because of a duplicate ID)
+	 */
+	std::vector<std::shared_ptr<Asset>> const& fonts() const {
+		return _fonts;
+	}
+
+private:
+	std::unordered_map<std::string, std::shared_ptr<Asset>> _assets;
+	std::vector<std::shared_ptr<Asset>> _fonts;
+};
+
+
+}
+
+
+#endif
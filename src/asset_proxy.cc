@@ -0,0 +1,93 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/asset_proxy.cc
+ *  @brief AssetProxy class
+ */
+
+
+#include "asset_proxy.h"
+
+
+using std::function;
+using std::shared_ptr;
+using std::string;
+using namespace dcp;
+
+
+AssetProxy::AssetProxy(string id, boost::filesystem::path file, string pkl_type, function<shared_ptr<Asset> ()> loader)
+	: Asset(id, file)
+	, _pkl_type(pkl_type)
+	, _loader(loader)
+{
+
+}
+
+
+shared_ptr<Asset>
+AssetProxy::load() const
+{
+	std::lock_guard<std::mutex> lm(_mutex);
+
+	if (!_asset) {
+		auto asset = _loader();
+		/* Pass on any hash that we were given from a CPL or PKL */
+		if (_hash) {
+			asset->set_hash(*_hash);
+		}
+		_asset = asset;
+	}
+
+	return _asset;
+}
+
+
+bool
+AssetProxy::loaded() const
+{
+	std::lock_guard<std::mutex> lm(_mutex);
+	return static_cast<bool>(_asset);
+}
+
+
+bool
+AssetProxy::equals(shared_ptr<const Asset> other, EqualityOptions const& opt, NoteHandler note) const
+{
+	if (auto other_proxy = std::dynamic_pointer_cast<const AssetProxy>(other)) {
+		other = other_proxy->load();
+	}
+
+	return load()->equals(other, opt, note);
+}
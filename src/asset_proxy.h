@@ -0,0 +1,97 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/asset_proxy.h
+ *  @brief AssetProxy class
+ */
+
+
+#ifndef LIBDCP_ASSET_PROXY_H
+#define LIBDCP_ASSET_PROXY_H
+
+
+#include "asset.h"
+#include <functional>
+#include <mutex>
+
+
+namespace dcp {
+
+
+/** @class AssetProxy
+ *  @brief A stand-in for an asset which has not yet been read from disk.
+ *
+ *  An AssetProxy knows the ID, file and PKL type of the asset that it stands for, which is
+ *  enough to write it to an ASSETMAP or PKL.  The first time anything else is needed load()
+ *  creates the real asset (which will usually mean opening and parsing an MXF).  Ref::asset()
+ *  does this automatically, so code which goes through a Ref never sees the proxy.
+ */
+class AssetProxy : public Asset
+{
+public:
+	/** @param id Asset ID.
+	 *  @param file File containing the asset.
+	 *  @param pkl_type Type of the asset as given in its PKL.
+	 *  @param loader Function to create the real asset.
+	 */
+	AssetProxy(std::string id, boost::filesystem::path file, std::string pkl_type, std::function<std::shared_ptr<Asset> ()> loader);
+
+	/** @return the real asset, creating it if this has not already been done.  Any exception
+	 *  thrown when creating it will be passed on, and creation will be tried again next time.
+	 */
+	std::shared_ptr<Asset> load() const;
+
+	/** @return true if load() has successfully created the real asset */
+	bool loaded() const;
+
+	bool equals(std::shared_ptr<const Asset> other, EqualityOptions const& opt, NoteHandler note) const override;
+
+private:
+	std::string pkl_type(Standard) const override {
+		return _pkl_type;
+	}
+
+	std::string _pkl_type;
+	std::function<std::shared_ptr<Asset> ()> _loader;
+
+	mutable std::mutex _mutex;
+	mutable std::shared_ptr<Asset> _asset;
+};
+
+
+}
+
+
+#endif
@@ -42,6 +42,7 @@
 #include "dcp_assert.h"
 #include "exceptions.h"
 #include "filesystem.h"
+#include "parallel.h"
 #include "scope_guard.h"
 #include "util.h"
 #include "warnings.h"
@@ -62,69 +63,19 @@ LIBDCP_ENABLE_WARNINGS
 #include <openssl/pem.h>
 #include <openssl/rsa.h>
 #include <openssl/x509.h>
+#include <openssl/x509v3.h>
 #include <boost/algorithm/string.hpp>
-#include <fstream>
 #include <iostream>
 
 
 using std::string;
-using std::ofstream;
-using std::ifstream;
 using std::runtime_error;
 using namespace dcp;
 
 
-/** Run a shell command.
- *  @param cmd Command to run (UTF8-encoded).
- */
-static void
-command (string cmd)
-{
-#ifdef LIBDCP_WINDOWS
-	/* We need to use CreateProcessW on Windows so that the UTF-8/16 mess
-	   is handled correctly.
-	*/
-	int const wn = MultiByteToWideChar (CP_UTF8, 0, cmd.c_str(), -1, 0, 0);
-	auto buffer = new wchar_t[wn];
-	if (MultiByteToWideChar (CP_UTF8, 0, cmd.c_str(), -1, buffer, wn) == 0) {
-		delete[] buffer;
-		return;
-	}
-
-	int code = 1;
-
-	STARTUPINFOW startup_info;
-	memset (&startup_info, 0, sizeof (startup_info));
-	startup_info.cb = sizeof (startup_info);
-	PROCESS_INFORMATION process_info;
-
-	/* XXX: this doesn't actually seem to work; failing commands end up with
-	   a return code of 0
-	*/
-	if (CreateProcessW (0, buffer, 0, 0, FALSE, CREATE_NO_WINDOW, 0, 0, &startup_info, &process_info)) {
-		WaitForSingleObject (process_info.hProcess, INFINITE);
-		DWORD c;
-		if (GetExitCodeProcess (process_info.hProcess, &c)) {
-			code = c;
-		}
-		CloseHandle (process_info.hProcess);
-		CloseHandle (process_info.hThread);
-	}
-
-	delete[] buffer;
-#else
-	cmd += " 2> /dev/null";
-	int const r = system (cmd.c_str ());
-	int const code = WEXITSTATUS (r);
-#endif
-	if (code) {
-		throw dcp::MiscError(String::compose("error %1 in %2 within %3", code, cmd, filesystem::current_path().string()));
-	}
-}
-
-
-string
-dcp::public_key_digest(RSA* public_key)
+/** @return SHA1 digest of a public key, without any escaping */
+static string
+unescaped_public_key_digest(RSA* public_key)
 {
 	/* Convert public key to DER (binary) format */
 	unsigned char buffer[512];
@@ -151,8 +102,14 @@ dcp::public_key_digest(RSA* public_key)
 	}
 
 	char digest_base64[64];
-	string dig = Kumu::base64encode (digest, SHA_DIGEST_LENGTH, digest_base64, 64);
-	return escape_digest(dig);
+	return Kumu::base64encode (digest, SHA_DIGEST_LENGTH, digest_base64, 64);
+}
+
+
+string
+dcp::public_key_digest(RSA* public_key)
+{
+	return escape_digest(unescaped_public_key_digest(public_key));
 }
 
 
@@ -199,8 +156,148 @@ dcp::public_key_digest(boost::filesystem::path private_key_file)
 }
 
 
+/** Generate a 2048-bit RSA key */
+static std::shared_ptr<EVP_PKEY>
+make_key()
+{
+	auto context = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+	if (!context) {
+		throw MiscError("Could not create key generation context");
+	}
+	dcp::ScopeGuard sg_context([context]() { EVP_PKEY_CTX_free(context); });
+
+	if (EVP_PKEY_keygen_init(context) <= 0 || EVP_PKEY_CTX_set_rsa_keygen_bits(context, 2048) <= 0) {
+		throw MiscError("Could not set up key generation");
+	}
+
+	EVP_PKEY* key = nullptr;
+	if (EVP_PKEY_keygen(context, &key) <= 0) {
+		throw MiscError("Could not generate key");
+	}
+
+	return std::shared_ptr<EVP_PKEY>(key, EVP_PKEY_free);
+}
+
+
+static string
+key_digest(EVP_PKEY* key)
+{
+	auto rsa = EVP_PKEY_get1_RSA(key);
+	if (!rsa) {
+		throw MiscError("Could not obtain public key");
+	}
+	dcp::ScopeGuard sg_rsa([rsa]() { RSA_free(rsa); });
+
+	return unescaped_public_key_digest(rsa);
+}
+
+
+static void
+add_name_entry(X509_NAME* name, int nid, string const& value)
+{
+	/* This is what `string_mask = nombstr' in an openssl config file would give us: PrintableString
+	 * if the value allows it, otherwise T61String.
+	 */
+	auto const data = reinterpret_cast<unsigned char const*>(value.c_str());
+	auto const type = ASN1_PRINTABLE_type(data, value.length()) == V_ASN1_PRINTABLESTRING ? V_ASN1_PRINTABLESTRING : V_ASN1_T61STRING;
+	if (!X509_NAME_add_entry_by_NID(name, nid, type, const_cast<unsigned char*>(data), value.length(), -1, 0)) {
+		throw MiscError(String::compose("Could not add %1 to certificate subject", OBJ_nid2sn(nid)));
+	}
+}
+
+
+static void
+add_extension(X509* certificate, X509* issuer, int nid, char const* value)
+{
+	X509V3_CTX context;
+	X509V3_set_ctx(&context, issuer, certificate, nullptr, nullptr, 0);
+	auto extension = X509V3_EXT_conf_nid(nullptr, &context, nid, const_cast<char*>(value));
+	if (!extension) {
+		throw MiscError(String::compose("Could not create %1 certificate extension", OBJ_nid2sn(nid)));
+	}
+	dcp::ScopeGuard sg_extension([extension]() { X509_EXTENSION_free(extension); });
+
+	if (!X509_add_ext(certificate, extension, -1)) {
+		throw MiscError(String::compose("Could not add %1 certificate extension", OBJ_nid2sn(nid)));
+	}
+}
+
+
+/** Make a certificate, using the same profile as was previously used when calling `openssl req' and `openssl x509'.
+ *  @param key Key pair for the new certificate.
+ *  @param issuer Issuer's certificate, or nullptr to make a self-signed certificate.
+ *  @param issuer_key Issuer's key pair, or nullptr to make a self-signed certificate.
+ *  @param ca true to make a CA certificate, false to make a leaf.
+ *  @param path_length Path length constraint to use if this is a CA certificate.
+ */
+static X509*
+make_certificate(
+	EVP_PKEY* key,
+	X509* issuer,
+	EVP_PKEY* issuer_key,
+	long serial,
+	int validity_in_days,
+	string const& organisation,
+	string const& organisational_unit,
+	string const& common_name,
+	bool ca,
+	int path_length
+	)
+{
+	auto certificate = X509_new();
+	if (!certificate) {
+		throw MiscError("Could not create certificate");
+	}
+	dcp::ScopeGuard sg_certificate([certificate]() { X509_free(certificate); });
+
+	/* version 3 */
+	X509_set_version(certificate, 2);
+	ASN1_INTEGER_set(X509_get_serialNumber(certificate), serial);
+	X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+	X509_time_adj_ex(X509_getm_notAfter(certificate), validity_in_days, 0, nullptr);
+
+	if (!X509_set_pubkey(certificate, key)) {
+		throw MiscError("Could not set certificate public key");
+	}
+
+	auto name = X509_get_subject_name(certificate);
+	add_name_entry(name, NID_organizationName, organisation);
+	add_name_entry(name, NID_organizationalUnitName, organisational_unit);
+	add_name_entry(name, NID_commonName, common_name);
+	add_name_entry(name, NID_dnQualifier, key_digest(key));
+
+	if (!issuer) {
+		issuer = certificate;
+		issuer_key = key;
+	}
+
+	if (!X509_set_issuer_name(certificate, X509_get_subject_name(issuer))) {
+		throw MiscError("Could not set certificate issuer");
+	}
+
+	if (ca) {
+		add_extension(certificate, issuer, NID_basic_constraints, String::compose("critical,CA:true,pathlen:%1", path_length).c_str());
+		add_extension(certificate, issuer, NID_key_usage, "keyCertSign,cRLSign");
+		add_extension(certificate, issuer, NID_subject_key_identifier, "hash");
+		add_extension(certificate, issuer, NID_authority_key_identifier, "keyid:always,issuer:always");
+	} else {
+		add_extension(certificate, issuer, NID_basic_constraints, "critical,CA:false");
+		add_extension(certificate, issuer, NID_key_usage, "digitalSignature,keyEncipherment");
+		add_extension(certificate, issuer, NID_subject_key_identifier, "hash");
+		add_extension(certificate, issuer, NID_authority_key_identifier, "keyid,issuer:always");
+	}
+
+	if (!X509_sign(certificate, issuer_key, EVP_sha256())) {
+		throw MiscError("Could not sign certificate");
+	}
+
+	sg_certificate.cancel();
+	return certificate;
+}
+
+
 CertificateChain::CertificateChain (
-	boost::filesystem::path openssl,
+	boost::filesystem::path,
 	int validity_in_days,
 	string organisation,
 	string organisational_unit,
@@ -208,150 +305,97 @@ CertificateChain::CertificateChain (
 	string intermediate_common_name,
 	string leaf_common_name
 	)
+	: CertificateChain(validity_in_days, organisation, organisational_unit, root_common_name, intermediate_common_name, leaf_common_name)
 {
-	auto directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path ();
-	filesystem::create_directories(directory);
 
-	auto const cwd = boost::filesystem::current_path();
-	/* On Windows we will use cmd.exe here, and that doesn't work with UNC paths, so make sure
-	 * we don't use our own filesystem::current_path() as it will make the current working
-	 * directory a UNC path.
+}
+
+
+CertificateChain::CertificateChain (
+	int validity_in_days,
+	string organisation,
+	string organisational_unit,
+	string root_common_name,
+	string intermediate_common_name,
+	string leaf_common_name
+	)
+{
+	/* Each certificate is needed to sign the next, so keep our own references to them
+	 * until they are all made; dcp::Certificate takes ownership of what it is given.
 	 */
-	boost::filesystem::current_path(directory);
-
-	string quoted_openssl = "\"" + openssl.string() + "\"";
-
-	command (quoted_openssl + " genrsa -out ca.key 2048");
-
-	{
-		ofstream f ("ca.cnf");
-		f << "[ req ]\n"
-		  << "distinguished_name = req_distinguished_name\n"
-		  << "x509_extensions	= v3_ca\n"
-		  << "string_mask = nombstr\n"
-		  << "[ v3_ca ]\n"
-		  << "basicConstraints = critical,CA:true,pathlen:3\n"
-		  << "keyUsage = keyCertSign,cRLSign\n"
-		  << "subjectKeyIdentifier = hash\n"
-		  << "authorityKeyIdentifier = keyid:always,issuer:always\n"
-		  << "[ req_distinguished_name ]\n"
-		  << "O = Unique organization name\n"
-		  << "OU = Organization unit\n"
-		  << "CN = Entity and dnQualifier\n";
-	}
-
-	string const ca_subject = "/O=" + organisation +
-		"/OU=" + organisational_unit +
-		"/CN=" + root_common_name +
-		"/dnQualifier=" + public_key_digest ("ca.key");
-
-	{
-		command (
-			String::compose (
-				"%1 req -new -x509 -sha256 -config ca.cnf -days %2 -set_serial 5"
-				" -subj \"%3\" -key ca.key -outform PEM -out ca.self-signed.pem",
-				quoted_openssl, validity_in_days, ca_subject
-				)
-			);
-	}
+	auto root_key = make_key();
+	auto root = std::shared_ptr<X509>(
+		make_certificate(
+			root_key.get(), nullptr, nullptr, 5, validity_in_days,
+			organisation, organisational_unit, root_common_name, true, 3
+			),
+		X509_free
+		);
 
-	command (quoted_openssl + " genrsa -out intermediate.key 2048");
-
-	{
-		ofstream f ("intermediate.cnf");
-		f << "[ default ]\n"
-		  << "distinguished_name = req_distinguished_name\n"
-		  << "x509_extensions = v3_ca\n"
-		  << "string_mask = nombstr\n"
-		  << "[ v3_ca ]\n"
-		  << "basicConstraints = critical,CA:true,pathlen:2\n"
-		  << "keyUsage = keyCertSign,cRLSign\n"
-		  << "subjectKeyIdentifier = hash\n"
-		  << "authorityKeyIdentifier = keyid:always,issuer:always\n"
-		  << "[ req_distinguished_name ]\n"
-		  << "O = Unique organization name\n"
-		  << "OU = Organization unit\n"
-		  << "CN = Entity and dnQualifier\n";
-	}
-
-	string const inter_subject = "/O=" + organisation +
-		"/OU=" + organisational_unit +
-		"/CN=" + intermediate_common_name +
-		"/dnQualifier="	+ public_key_digest ("intermediate.key");
-
-	{
-		command (
-			String::compose (
-				"%1 req -new -config intermediate.cnf -days %2 -subj \"%3\" -key intermediate.key -out intermediate.csr",
-				quoted_openssl, validity_in_days - 1, inter_subject
-				)
-			);
-	}
+	auto intermediate_key = make_key();
+	auto intermediate = std::shared_ptr<X509>(
+		make_certificate(
+			intermediate_key.get(), root.get(), root_key.get(), 6, validity_in_days - 1,
+			organisation, organisational_unit, intermediate_common_name, true, 2
+			),
+		X509_free
+		);
 
-	command (
-		String::compose (
-			"%1 x509 -req -sha256 -days %2 -CA ca.self-signed.pem -CAkey ca.key -set_serial 6"
-			" -in intermediate.csr -extfile intermediate.cnf -extensions v3_ca -out intermediate.signed.pem",
-			quoted_openssl, validity_in_days - 1
-			)
+	auto leaf_key = make_key();
+	auto leaf = std::shared_ptr<X509>(
+		make_certificate(
+			leaf_key.get(), intermediate.get(), intermediate_key.get(), 7, validity_in_days - 2,
+			organisation, organisational_unit, leaf_common_name, false, 0
+			),
+		X509_free
 		);
 
-	command (quoted_openssl + " genrsa -out leaf.key 2048");
-
-	{
-		ofstream f ("leaf.cnf");
-		f << "[ default ]\n"
-		  << "distinguished_name = req_distinguished_name\n"
-		  << "x509_extensions	= v3_ca\n"
-		  << "string_mask = nombstr\n"
-		  << "[ v3_ca ]\n"
-		  << "basicConstraints = critical,CA:false\n"
-		  << "keyUsage = digitalSignature,keyEncipherment\n"
-		  << "subjectKeyIdentifier = hash\n"
-		  << "authorityKeyIdentifier = keyid,issuer:always\n"
-		  << "[ req_distinguished_name ]\n"
-		  << "O = Unique organization name\n"
-		  << "OU = Organization unit\n"
-		  << "CN = Entity and dnQualifier\n";
-	}
-
-	string const leaf_subject = "/O=" + organisation +
-		"/OU=" + organisational_unit +
-		"/CN=" + leaf_common_name +
-		"/dnQualifier="	+ public_key_digest ("leaf.key");
-
-	{
-		command (
-			String::compose (
-				"%1 req -new -config leaf.cnf -days %2 -subj \"%3\" -key leaf.key -outform PEM -out leaf.csr",
-				quoted_openssl, validity_in_days - 2, leaf_subject
-				)
-			);
+	for (auto certificate: { root, intermediate, leaf }) {
+		auto copy = X509_dup(certificate.get());
+		if (!copy) {
+			throw MiscError("Could not copy certificate");
+		}
+		_certificates.push_back(dcp::Certificate(copy));
 	}
 
-	command (
-		String::compose (
-			"%1 x509 -req -sha256 -days %2 -CA intermediate.signed.pem -CAkey intermediate.key"
-			" -set_serial 7 -in leaf.csr -extfile leaf.cnf -extensions v3_ca -out leaf.signed.pem",
-			quoted_openssl, validity_in_days - 2
-			)
-		);
+	auto bio = BIO_new(BIO_s_mem());
+	if (!bio) {
+		throw MiscError("Could not create memory BIO");
+	}
+	dcp::ScopeGuard sg_bio([bio]() { BIO_free(bio); });
 
-	/* Use boost:: rather than dcp:: here so we don't force UNC into the current path if it
-	 * wasn't there before.
-	 */
-	boost::filesystem::current_path(cwd);
+	if (!PEM_write_bio_PrivateKey(bio, leaf_key.get(), nullptr, nullptr, 0, nullptr, nullptr)) {
+		throw MiscError("Could not write private key");
+	}
 
-	_certificates.push_back (dcp::Certificate(dcp::file_to_string(directory / "ca.self-signed.pem")));
-	_certificates.push_back (dcp::Certificate(dcp::file_to_string(directory / "intermediate.signed.pem")));
-	_certificates.push_back (dcp::Certificate(dcp::file_to_string(directory / "leaf.signed.pem")));
+	char* data;
+	auto const length = BIO_get_mem_data(bio, &data);
+	_key = string(data, length);
+}
 
-	_key = dcp::file_to_string (directory / "leaf.key");
 
-	filesystem::remove_all(directory);
+std::vector<CertificateChain>
+CertificateChain::generate (
+	int count,
+	int validity_in_days,
+	string organisation,
+	string organisational_unit,
+	string root_common_name,
+	string intermediate_common_name,
+	string leaf_common_name,
+	int threads
+	)
+{
+	std::vector<CertificateChain> chains(count);
+	dcp::parallel_for(count, threads, [&](int i) {
+		chains[i] = CertificateChain(validity_in_days, organisation, organisational_unit, root_common_name, intermediate_common_name, leaf_common_name);
+	});
+	return chains;
 }
 
 
+
+
 CertificateChain::CertificateChain (string s)
 {
 	while (true) {
@@ -686,14 +730,12 @@ CertificateChain::add_signature_value (xmlpp::Element* parent, string ns, bool a
 		throw MiscError ("could not create signature context");
 	}
 
-	DCP_ASSERT(_key);
-	signature_context->signKey = xmlSecCryptoAppKeyLoadMemory (
-		reinterpret_cast<const unsigned char *> (_key->c_str()), _key->size(), xmlSecKeyDataFormatPem, 0, 0, 0
-		);
+	ScopeGuard sg = [signature_context]() {
+		/* This also destroys signKey */
+		xmlSecDSigCtxDestroy (signature_context);
+	};
 
-	if (signature_context->signKey == 0) {
-		throw runtime_error ("could not read private key");
-	}
+	signature_context->signKey = signing_key ();
 
 	if (add_indentation) {
 		indent (parent, 2);
@@ -702,8 +744,33 @@ CertificateChain::add_signature_value (xmlpp::Element* parent, string ns, bool a
 	if (r < 0) {
 		throw MiscError (String::compose ("could not sign (%1)", r));
 	}
+}
+
+
+/** @return A copy of our private key, parsed by xmlsec, which the caller must free with xmlSecKeyDestroy */
+_xmlSecKey*
+CertificateChain::signing_key () const
+{
+	DCP_ASSERT(_key);
+
+	std::lock_guard<std::mutex> lm (_signing_key_cache->mutex);
+
+	if (!_signing_key_cache->key) {
+		auto key = xmlSecCryptoAppKeyLoadMemory (
+			reinterpret_cast<const unsigned char *> (_key->c_str()), _key->size(), xmlSecKeyDataFormatPem, 0, 0, 0
+			);
+		if (key == 0) {
+			throw runtime_error ("could not read private key");
+		}
+		_signing_key_cache->key.reset (key, xmlSecKeyDestroy);
+	}
+
+	auto copy = xmlSecKeyDuplicate (_signing_key_cache->key.get());
+	if (copy == 0) {
+		throw MiscError ("could not copy private key");
+	}
 
-	xmlSecDSigCtxDestroy (signature_context);
+	return copy;
 }
 
 
@@ -45,12 +45,16 @@
 #include "types.h"
 #include <boost/filesystem.hpp>
 #include <boost/optional.hpp>
+#include <memory>
+#include <mutex>
 
 
 namespace xmlpp {
 	class Node;
 }
 
+struct _xmlSecKey;
+
 
 struct certificates_validation1;
 struct certificates_validation2;
@@ -77,12 +81,7 @@ public:
 	CertificateChain () {}
 
 	/** Create a chain of certificates for signing things.
-	 *  @param openssl Name of openssl binary (if it is on the path) or full path.
-	 *  @return Directory (which should be deleted by the caller) containing:
-	 *    - ca.self-signed.pem      self-signed root certificate
-	 *    - intermediate.signed.pem intermediate certificate
-	 *    - leaf.key                leaf certificate private key
-	 *    - leaf.signed.pem         leaf certificate
+	 *  @param openssl Ignored; the certificates are now made in-process rather than with the openssl binary.
 	 */
 	CertificateChain (
 		boost::filesystem::path openssl,
@@ -94,6 +93,34 @@ public:
 		std::string leaf_common_name = "CS.smpte-430-2.LEAF.NOT_FOR_PRODUCTION"
 		);
 
+	/** Create a chain of certificates for signing things: a self-signed root, an intermediate and a leaf,
+	 *  each with a new 2048-bit RSA key.  The chain holds the leaf's private key.
+	 *  @param validity_in_days Validity period of the root; the intermediate's is one day shorter and the leaf's two.
+	 */
+	explicit CertificateChain (
+		int validity_in_days,
+		std::string organisation = "example.org",
+		std::string organisational_unit = "example.org",
+		std::string root_common_name = ".smpte-430-2.ROOT.NOT_FOR_PRODUCTION",
+		std::string intermediate_common_name = ".smpte-430-2.INTERMEDIATE.NOT_FOR_PRODUCTION",
+		std::string leaf_common_name = "CS.smpte-430-2.LEAF.NOT_FOR_PRODUCTION"
+		);
+
+	/** Create a number of independent chains, as the constructor above would, using several threads.
+	 *  @param count Number of chains to create.
+	 *  @param threads Number of threads to use, or 0 to use one per CPU.
+	 */
+	static std::vector<CertificateChain> generate (
+		int count,
+		int validity_in_days,
+		std::string organisation = "example.org",
+		std::string organisational_unit = "example.org",
+		std::string root_common_name = ".smpte-430-2.ROOT.NOT_FOR_PRODUCTION",
+		std::string intermediate_common_name = ".smpte-430-2.INTERMEDIATE.NOT_FOR_PRODUCTION",
+		std::string leaf_common_name = "CS.smpte-430-2.LEAF.NOT_FOR_PRODUCTION",
+		int threads = 0
+		);
+
 	/** Read a CertificateChain from a string.
 	 *  @param s A string containing one or more PEM-encoded certificates.
 	 */
@@ -167,6 +194,7 @@ public:
 
 	void set_key (std::string k) {
 		_key = k;
+		_signing_key_cache = std::make_shared<SigningKeyCache>();
 	}
 
 	std::string chain () const;
@@ -182,11 +210,24 @@ private:
 	friend struct ::certificates_validation8;
 
 	bool chain_valid(List const & chain, std::string* error = nullptr) const;
+	_xmlSecKey* signing_key () const;
 
 	/** Our certificates, not in any particular order */
 	List _certificates;
 	/** Leaf certificate's private key, if known, in PEM format */
 	boost::optional<std::string> _key;
+
+	struct SigningKeyCache
+	{
+		std::mutex mutex;
+		std::shared_ptr<_xmlSecKey> key;
+	};
+
+	/** _key parsed by xmlsec, made when it is first needed so that we don't parse the
+	 *  PEM every time we sign something.  This is shared between copies of the chain
+	 *  (as they have the same _key) and replaced when _key changes.
+	 */
+	std::shared_ptr<SigningKeyCache> _signing_key_cache = std::make_shared<SigningKeyCache>();
 };
 
 
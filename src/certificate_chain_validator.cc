@@ -0,0 +1,244 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/certificate_chain_validator.cc
+ *  @brief CertificateChainValidator class
+ */
+
+
+#include "certificate_chain.h"
+#include "certificate_chain_validator.h"
+#include "exceptions.h"
+#include "parallel.h"
+#include "scope_guard.h"
+#include <openssl/x509_vfy.h>
+#include <algorithm>
+#include <numeric>
+
+
+using std::string;
+using std::vector;
+using namespace dcp;
+
+
+CertificateChainValidator::CertificateChainValidator ()
+	: _store (X509_STORE_new())
+{
+	if (!_store) {
+		throw MiscError ("could not create X509 store");
+	}
+}
+
+
+CertificateChainValidator::~CertificateChainValidator ()
+{
+	X509_STORE_free (_store);
+}
+
+
+void
+CertificateChainValidator::add_trusted (Certificate const& certificate)
+{
+	std::lock_guard<std::mutex> lm (_mutex);
+
+	if (!X509_STORE_add_cert(_store, certificate.x509())) {
+		throw MiscError ("could not add certificate to X509 store");
+	}
+
+	_trusted.push_back (certificate);
+	/* Anything we remembered may now be different */
+	_links.clear ();
+}
+
+
+/** Check certificate index in a chain against its issuer (the one before it), or against our
+ *  trusted certificates if index is 0.
+ */
+CertificateChainValidator::LinkResult
+CertificateChainValidator::check_link (vector<Certificate> const& root_to_leaf, int index) const
+{
+	auto const& certificate = root_to_leaf[index];
+
+	auto ctx = X509_STORE_CTX_new ();
+	if (!ctx) {
+		throw MiscError ("could not create X509 store context");
+	}
+	ScopeGuard sg_ctx([ctx]() { X509_STORE_CTX_free(ctx); });
+
+	auto others = sk_X509_new_null ();
+	if (!others) {
+		throw MiscError ("could not create X509 stack");
+	}
+	ScopeGuard sg_others([others]() { sk_X509_free(others); });
+
+	for (auto const& i: root_to_leaf) {
+		sk_X509_push (others, i.x509());
+	}
+
+	if (!X509_STORE_CTX_init(ctx, _store, certificate.x509(), others)) {
+		throw MiscError ("could not initialise X509 store context");
+	}
+
+	bool trusted_empty;
+	{
+		std::lock_guard<std::mutex> lm (_mutex);
+		trusted_empty = _trusted.empty();
+	}
+
+	if (trusted_empty) {
+		/* Trust all the certificates in the chain, as CertificateChain::chain_valid() does */
+#if OPENSSL_VERSION_NUMBER > 0x10100000L
+		X509_STORE_CTX_set0_trusted_stack (ctx, others);
+#else
+		X509_STORE_CTX_trusted_stack (ctx, others);
+#endif
+	}
+
+	/* Check at the same time as CertificateChain::chain_valid() */
+	auto const& time_reference = index > 0 ? root_to_leaf[index - 1] : certificate;
+#ifdef LIBDCP_HAVE_NO_CHECK_TIME
+	X509_STORE_CTX_set_flags (ctx, X509_V_FLAG_NO_CHECK_TIME);
+#else
+	X509_VERIFY_PARAM_set_time (X509_STORE_CTX_get0_param(ctx), time_reference.not_before().as_time_t() + 60);
+#endif
+
+	if (X509_verify_cert(ctx) != 1) {
+		return { false, X509_verify_cert_error_string(X509_STORE_CTX_get_error(ctx)) };
+	}
+
+	if (index > 0) {
+		auto const& issuer = root_to_leaf[index - 1];
+		if (certificate.issuer() != issuer.subject() || certificate.subject() == issuer.subject()) {
+			return { false, "" };
+		}
+	}
+
+	return { true, "" };
+}
+
+
+bool
+CertificateChainValidator::order_valid (vector<Certificate> const& root_to_leaf, vector<string> const& thumbprints, string* error) const
+{
+	bool trusted_empty;
+	{
+		std::lock_guard<std::mutex> lm (_mutex);
+		trusted_empty = _trusted.empty();
+	}
+
+	string key;
+	for (size_t i = 0; i < root_to_leaf.size(); ++i) {
+		key += thumbprints[i];
+		if (i == 0 && trusted_empty) {
+			/* There's nothing to check the root against */
+			continue;
+		}
+
+		LinkResult result = { false, "" };
+		bool found = false;
+		{
+			std::lock_guard<std::mutex> lm (_mutex);
+			auto j = _links.find (key);
+			if (j != _links.end()) {
+				result = j->second;
+				found = true;
+			}
+		}
+
+		if (!found) {
+			result = check_link (root_to_leaf, i);
+			std::lock_guard<std::mutex> lm (_mutex);
+			_links[key] = result;
+		}
+
+		if (!result.valid) {
+			if (error && !result.error.empty()) {
+				*error = result.error;
+			}
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+bool
+CertificateChainValidator::valid (CertificateChain const& chain, string* error) const
+{
+	auto const certificates = chain.unordered ();
+
+	vector<string> thumbprints;
+	for (auto const& i: certificates) {
+		thumbprints.push_back (i.thumbprint());
+	}
+
+	/* Try every order of the certificates, as CertificateChain::root_to_leaf() does; the
+	 * results of checking each link are remembered, so this is cheap after the first time.
+	 */
+	vector<int> order (certificates.size());
+	std::iota (order.begin(), order.end(), 0);
+	string last_error;
+	do {
+		vector<Certificate> ordered;
+		vector<string> ordered_thumbprints;
+		for (auto i: order) {
+			ordered.push_back (certificates[i]);
+			ordered_thumbprints.push_back (thumbprints[i]);
+		}
+		if (order_valid(ordered, ordered_thumbprints, &last_error)) {
+			return true;
+		}
+	} while (std::next_permutation(order.begin(), order.end()));
+
+	if (error) {
+		*error = last_error.empty() ? string("certificates do not form a chain") : last_error;
+	}
+
+	return false;
+}
+
+
+vector<bool>
+CertificateChainValidator::valid (vector<CertificateChain> const& chains, int threads) const
+{
+	/* vector<bool> can't be written to safely from several threads */
+	vector<uint8_t> results (chains.size());
+	parallel_for (chains.size(), threads, [this, &chains, &results](int index) {
+		results[index] = valid(chains[index]);
+	});
+
+	return vector<bool>(results.begin(), results.end());
+}
@@ -0,0 +1,119 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/certificate_chain_validator.h
+ *  @brief CertificateChainValidator class
+ */
+
+
+#ifndef LIBDCP_CERTIFICATE_CHAIN_VALIDATOR_H
+#define LIBDCP_CERTIFICATE_CHAIN_VALIDATOR_H
+
+
+#include "certificate.h"
+#include <openssl/x509.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace dcp {
+
+
+class CertificateChain;
+
+
+/** @class CertificateChainValidator
+ *  @brief Checks any number of certificate chains, remembering results to make repeated checks cheap.
+ *
+ *  The validator keeps a store of trusted certificates, and remembers the result of checking each
+ *  link in a chain by the thumbprints of the certificates from the root down to that link.  Chains
+ *  which share roots and intermediates (as KDM signer chains and screen certificates from the same
+ *  issuer do) therefore only need their new links checked.  All methods may be called from
+ *  several threads at once.
+ */
+class CertificateChainValidator
+{
+public:
+	CertificateChainValidator ();
+	~CertificateChainValidator ();
+
+	CertificateChainValidator (CertificateChainValidator const&) = delete;
+	CertificateChainValidator& operator= (CertificateChainValidator const&) = delete;
+
+	/** Add a certificate (usually a root) which chains must lead to.  If no trusted certificates
+	 *  are added the root of each chain is trusted, as in CertificateChain::valid().
+	 */
+	void add_trusted (Certificate const& certificate);
+
+	/** Check that the certificates in chain can be put in an order where each one is signed by the
+	 *  one before, in the same way as CertificateChain::valid().  Any private key in the chain is
+	 *  not checked.
+	 *  @param error if non-null, filled in with the reason for failure, if there is one.
+	 */
+	bool valid (CertificateChain const& chain, std::string* error = nullptr) const;
+
+	/** Check many chains as valid() would, using several threads.
+	 *  @param threads Number of threads to use, or 0 for one per CPU.
+	 *  @return true or false for each chain, in the same order as chains.
+	 */
+	std::vector<bool> valid (std::vector<CertificateChain> const& chains, int threads = 0) const;
+
+private:
+	struct LinkResult
+	{
+		bool valid;
+		std::string error;
+	};
+
+	bool order_valid (std::vector<Certificate> const& root_to_leaf, std::vector<std::string> const& thumbprints, std::string* error) const;
+	LinkResult check_link (std::vector<Certificate> const& root_to_leaf, int index) const;
+
+	X509_STORE* _store = nullptr;
+	std::vector<Certificate> _trusted;
+
+	mutable std::mutex _mutex;
+	/** Results of checking certificate n of a chain against certificate n-1, keyed by the
+	 *  thumbprints of certificates 0 to n.
+	 */
+	mutable std::map<std::string, LinkResult> _links;
+};
+
+
+}
+
+
+#endif
@@ -46,10 +46,19 @@
 #include "filesystem.h"
 #include "font_asset.h"
 #include "interop_text_asset.h"
+#include "parallel.h"
 #include "raw_convert.h"
+#include "scope_guard.h"
 #include <fmt/format.h>
 #include <boost/filesystem.hpp>
 #include <boost/system/windows_error.hpp>
+#ifdef LIBDCP_LINUX
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include <set>
 #include <string>
 #include <vector>
@@ -64,16 +73,22 @@ using std::vector;
 using boost::optional;
 
 
+/** @return path, or if that exists (or is in reserved) a variant of it with a number added which does not */
+static
 boost::filesystem::path
-make_unique(boost::filesystem::path path)
+make_unique(boost::filesystem::path path, set<boost::filesystem::path> const& reserved = {})
 {
-	if (!dcp::filesystem::exists(path)) {
+	auto taken = [&reserved](boost::filesystem::path const& p) {
+		return dcp::filesystem::exists(p) || reserved.find(p) != reserved.end();
+	};
+
+	if (!taken(path)) {
 		return path;
 	}
 
 	for (int i = 0; i < 10000; ++i) {
 		boost::filesystem::path p = path.parent_path() / (path.stem().string() + fmt::to_string(i) + path.extension().string());
-		if (!dcp::filesystem::exists(p)) {
+		if (!taken(p)) {
 			return p;
 		}
 	}
@@ -83,6 +98,61 @@ make_unique(boost::filesystem::path path)
 }
 
 
+#ifdef LIBDCP_LINUX
+/** Copy a file by asking the filesystem to share the data (a reflink), or failing that by
+ *  asking the kernel to copy it without it passing through user space.
+ *  @return true if the copy was made, false if neither method is available here.
+ */
+static
+bool
+offloaded_copy(boost::filesystem::path from, boost::filesystem::path to)
+{
+	int const in = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+	if (in < 0) {
+		return false;
+	}
+	dcp::ScopeGuard sg_in = [in]() { close(in); };
+
+	struct stat st;
+	if (fstat(in, &st) != 0) {
+		return false;
+	}
+
+	int const out = open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 0777);
+	if (out < 0) {
+		return false;
+	}
+	bool done = false;
+	dcp::ScopeGuard sg_out = [out, to, &done]() {
+		close(out);
+		if (!done) {
+			unlink(to.c_str());
+		}
+	};
+
+#ifdef FICLONE
+	if (ioctl(out, FICLONE, in) == 0) {
+		done = true;
+		return true;
+	}
+#endif
+
+	auto remaining = st.st_size;
+	while (remaining > 0) {
+		auto const copied = copy_file_range(in, nullptr, out, nullptr, remaining, 0);
+		if (copied <= 0) {
+			/* Not supported, or the file got shorter while we were copying it */
+			return false;
+		}
+		remaining -= copied;
+	}
+
+	done = true;
+	return true;
+}
+#endif
+
+
 static
 void
 create_hard_link_or_copy(boost::filesystem::path from, boost::filesystem::path to)
@@ -97,6 +167,11 @@ create_hard_link_or_copy(boost::filesystem::path from, boost::filesystem::path t
 #endif
 			e.code() == boost::system::errc::operation_not_supported
 		   ) {
+#ifdef LIBDCP_LINUX
+			if (offloaded_copy(from, to)) {
+				return;
+			}
+#endif
 			dcp::filesystem::copy_file(from, to);
 		} else {
 			throw;
@@ -121,29 +196,31 @@ dcp::combine(
 	DCP output_dcp(output);
 	optional<dcp::Standard> standard;
 
+	/* Read each input once; the hashes from their CPLs and PKLs are kept with the assets,
+	 * so we need not re-calculate them when writing the output.
+	 */
+	vector<shared_ptr<DCP>> input_dcps;
 	for (auto i: inputs) {
-		DCP dcp(i);
-		dcp.read();
+		auto dcp = std::make_shared<DCP>(i);
+		dcp->read();
 		if (!standard) {
-			standard = *dcp.standard();
-		} else if (standard != dcp.standard()) {
+			standard = *dcp->standard();
+		} else if (standard != dcp->standard()) {
 			throw CombineError("Cannot combine Interop and SMPTE DCPs.");
 		}
+		input_dcps.push_back(dcp);
 	}
 
 	vector<boost::filesystem::path> paths;
 	vector<shared_ptr<dcp::Asset>> assets;
 	set<string> already_written;
 
-	for (auto i: inputs) {
-		DCP dcp(i);
-		dcp.read();
-
-		for (auto j: dcp.cpls()) {
+	for (auto dcp: input_dcps) {
+		for (auto j: dcp->cpls()) {
 			output_dcp.add(j);
 		}
 
-		for (auto j: dcp.assets(true)) {
+		for (auto j: dcp->assets(true)) {
 			if (dynamic_pointer_cast<dcp::CPL>(j)) {
 				continue;
 			}
@@ -173,18 +250,31 @@ dcp::combine(
 
 	output_dcp.resolve_refs(assets);
 
+	/* Choose all the output filenames first, then link or copy the files in parallel */
+	vector<std::pair<shared_ptr<dcp::Asset>, boost::filesystem::path>> copies;
+	set<boost::filesystem::path> reserved;
 	for (auto i: output_dcp.assets()) {
 		if (!dynamic_pointer_cast<dcp::FontAsset>(i) && !dynamic_pointer_cast<dcp::CPL>(i)) {
 			if (already_written.find(i->id()) == already_written.end()) {
 				auto file = i->file();
 				DCP_ASSERT(file);
-				auto new_path = make_unique(output / file->filename());
-				create_hard_link_or_copy(*file, new_path);
-				i->set_file(new_path);
+				auto new_path = make_unique(output / file->filename(), reserved);
+				reserved.insert(new_path);
+				copies.push_back({i, new_path});
 			}
 		}
 	}
 
+	parallel_for(static_cast<int>(copies.size()), 0, [&copies](int i) {
+		auto asset = copies[i].first;
+		create_hard_link_or_copy(*asset->file(), copies[i].second);
+	});
+
+	for (auto const& copy: copies) {
+		/* The new file is the same as the old, so its hash has not changed */
+		copy.first->set_file_preserving_hash(copy.second);
+	}
+
 	output_dcp.set_issuer(issuer);
 	output_dcp.set_creator(creator);
 	output_dcp.set_issue_date(issue_date);
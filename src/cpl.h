@@ -66,6 +66,7 @@ struct verify_invalid_language3;
 namespace dcp {
 
 
+class AssetIndex;
 class CertificateChain;
 class DecryptedKDM;
 class MXFMetadata;
@@ -139,6 +140,7 @@ public:
 	void write_xml(boost::filesystem::path file, std::shared_ptr<const CertificateChain>) const;
 
 	void resolve_refs(std::vector<std::shared_ptr<Asset>>);
+	void resolve_refs(AssetIndex const& assets);
 
 	int64_t duration() const;
 
@@ -38,6 +38,8 @@
 
 
 #include "asset_factory.h"
+#include "asset_index.h"
+#include "asset_proxy.h"
 #include "atmos_asset.h"
 #include "certificate_chain.h"
 #include "compose.hpp"
@@ -51,12 +53,14 @@
 #include "font_asset.h"
 #include "interop_text_asset.h"
 #include "metadata.h"
+#include "parallel.h"
 #include "mono_j2k_picture_asset.h"
 #include "mono_mpeg2_picture_asset.h"
 #include "j2k_picture_asset.h"
 #include "pkl.h"
 #include "raw_convert.h"
 #include "reel_asset.h"
+#include "reel_file_asset.h"
 #include "reel_text_asset.h"
 #include "scope_guard.h"
 #include "smpte_text_asset.h"
@@ -76,7 +80,11 @@ LIBDCP_DISABLE_WARNINGS
 #include <libxml++/libxml++.h>
 LIBDCP_ENABLE_WARNINGS
 #include <boost/algorithm/string.hpp>
+#include <exception>
+#include <functional>
+#include <iterator>
 #include <numeric>
+#include <unordered_set>
 
 
 using std::cerr;
@@ -164,7 +172,7 @@ DCP::remove_parameters(string const& n)
 
 
 void
-DCP::read (vector<dcp::VerificationNote>* notes, bool ignore_incorrect_picture_mxf_type)
+DCP::read (vector<dcp::VerificationNote>* notes, bool ignore_incorrect_picture_mxf_type, bool lazy)
 {
 	/* Read the ASSETMAP and PKL */
 	_asset_map = read_assetmap();
@@ -191,33 +199,52 @@ DCP::read (vector<dcp::VerificationNote>* notes, bool ignore_incorrect_picture_m
 	*/
 	vector<shared_ptr<Asset>> other_assets;
 
+	/* Each thing in the asset map is read into one of these.  Opening files can be slow (on network
+	 * storage, for example) so we do it in parallel, but we keep everything in asset map order
+	 * (including any notes and exceptions) so that the results are the same as reading serially.
+	 */
+	struct Entry
+	{
+		string id;
+		boost::filesystem::path path;
+		string pkl_type;
+		enum class Kind {
+			NONE,
+			XML,
+			MXF,
+		} kind = Kind::NONE;
+		shared_ptr<CPL> cpl;
+		shared_ptr<Asset> asset;
+		vector<VerificationNote> notes;
+		std::exception_ptr error;
+	};
+
 	auto ids_and_paths = _asset_map->asset_ids_and_paths();
+	vector<Entry> entries;
 	for (auto id_and_path: ids_and_paths) {
-		auto const id = id_and_path.first;
-		auto const path = id_and_path.second;
+		entries.push_back({});
+		auto& entry = entries.back();
+		entry.id = id_and_path.first;
+		entry.path = id_and_path.second;
 
-		if (path == _directory) {
+		if (entry.path == _directory) {
 			/* I can't see how this is valid, but it's
 			   been seen in the wild with a DCP that
 			   claims to come from ClipsterDCI 5.10.0.5.
 			*/
-			if (notes) {
-				notes->push_back({VerificationNote::Code::EMPTY_ASSET_PATH});
-			}
+			entry.notes.push_back({VerificationNote::Code::EMPTY_ASSET_PATH});
 			continue;
 		}
 
-		if (!filesystem::exists(path)) {
-			if (notes) {
-				notes->push_back({VerificationNote::Code::MISSING_ASSET, path});
-			}
+		if (!filesystem::exists(entry.path)) {
+			entry.notes.push_back({VerificationNote::Code::MISSING_ASSET, entry.path});
 			continue;
 		}
 
 		/* Find the <Type> for this asset from the PKL that contains the asset */
 		optional<string> pkl_type;
 		for (auto j: _pkls) {
-			pkl_type = j->type(id);
+			pkl_type = j->type(entry.id);
 			if (pkl_type) {
 				break;
 			}
@@ -230,35 +257,15 @@ DCP::read (vector<dcp::VerificationNote>* notes, bool ignore_incorrect_picture_m
 			continue;
 		}
 
+		entry.pkl_type = *pkl_type;
+
 		/* Remove any optional parameters (after ;) */
 		pkl_type = remove_parameters(*pkl_type);
 
 		if (
 			pkl_type == remove_parameters(CPL::static_pkl_type(standard)) ||
 			pkl_type == remove_parameters(InteropTextAsset::static_pkl_type(standard))) {
-			auto p = new xmlpp::DomParser;
-			dcp::ScopeGuard sg = [p]() { delete p; };
-
-			try {
-				p->parse_file(dcp::filesystem::fix_long_path(path).string());
-			} catch (std::exception& e) {
-				throw ReadError(String::compose("XML error in %1", path.string()), e.what());
-			}
-
-			auto const root = p->get_document()->get_root_node()->get_name();
-
-			if (root == "CompositionPlaylist") {
-				auto cpl = make_shared<CPL>(path, notes);
-				if (cpl->standard() != standard && notes) {
-					notes->push_back({VerificationNote::Code::MISMATCHED_STANDARD});
-				}
-				_cpls.push_back (cpl);
-			} else if (root == "DCSubtitle") {
-				if (standard == Standard::SMPTE && notes) {
-					notes->push_back({VerificationNote::Code::MISMATCHED_STANDARD});
-				}
-				other_assets.push_back (make_shared<InteropTextAsset>(path));
-			}
+			entry.kind = Entry::Kind::XML;
 		} else if (
 			*pkl_type == remove_parameters(J2KPictureAsset::static_pkl_type(standard)) ||
 			(standard == Standard::INTEROP && *pkl_type == remove_parameters(MPEG2PictureAsset::static_pkl_type(standard))) ||
@@ -266,22 +273,105 @@ DCP::read (vector<dcp::VerificationNote>* notes, bool ignore_incorrect_picture_m
 			*pkl_type == remove_parameters(AtmosAsset::static_pkl_type(standard)) ||
 			*pkl_type == remove_parameters(SMPTETextAsset::static_pkl_type(standard))
 			) {
-
-			bool found_threed_marked_as_twod = false;
-			auto asset = asset_factory(path, ignore_incorrect_picture_mxf_type, &found_threed_marked_as_twod);
-			if (asset->id() != id && notes) {
-				notes->push_back(dcp::VerificationNote{VerificationNote::Code::MISMATCHED_ASSET_MAP_ID}.set_asset_id(id).set_other_asset_id(asset->id()));
-			}
-			other_assets.push_back(asset);
-			if (found_threed_marked_as_twod && notes) {
-				notes->push_back(dcp::VerificationNote(VerificationNote::Code::THREED_ASSET_MARKED_AS_TWOD, path).set_asset_id(id));
-			}
+			entry.kind = Entry::Kind::MXF;
 		} else if (*pkl_type == remove_parameters(FontAsset::static_pkl_type(standard))) {
-			other_assets.push_back(make_shared<FontAsset>(id, path));
+			entry.asset = make_shared<FontAsset>(entry.id, entry.path);
 		} else if (*pkl_type == "image/png") {
 			/* It's an Interop PNG subtitle; let it go */
 		} else {
-			throw ReadError (String::compose("Unknown asset type %1 in PKL", *pkl_type));
+			entry.error = std::make_exception_ptr(ReadError(String::compose("Unknown asset type %1 in PKL", *pkl_type)));
+			/* Nothing after this will be used, so there's no need to look at it */
+			break;
+		}
+	}
+
+	auto for_each_entry = [&entries](Entry::Kind kind, std::function<void (Entry&)> job) {
+		vector<Entry*> todo;
+		for (auto& entry: entries) {
+			if (entry.kind == kind) {
+				todo.push_back(&entry);
+			}
+		}
+		parallel_for(static_cast<int>(todo.size()), 0, [&todo, job](int i) {
+			try {
+				job(*todo[i]);
+			} catch (...) {
+				todo[i]->error = std::current_exception();
+			}
+		});
+	};
+
+	/* Read the XML files first, so that we can use the CPLs to guess the type of each MXF */
+	for_each_entry(Entry::Kind::XML, [standard, lazy](Entry& entry) {
+		auto p = new xmlpp::DomParser;
+		dcp::ScopeGuard sg = [p]() { delete p; };
+
+		try {
+			p->parse_file(dcp::filesystem::fix_long_path(entry.path).string());
+		} catch (std::exception& e) {
+			throw ReadError(String::compose("XML error in %1", entry.path.string()), e.what());
+		}
+
+		auto const root = p->get_document()->get_root_node()->get_name();
+
+		if (root == "CompositionPlaylist") {
+			entry.cpl = make_shared<CPL>(entry.path, &entry.notes);
+			if (entry.cpl->standard() != standard) {
+				entry.notes.push_back({VerificationNote::Code::MISMATCHED_STANDARD});
+			}
+		} else if (root == "DCSubtitle") {
+			if (standard == Standard::SMPTE) {
+				entry.notes.push_back({VerificationNote::Code::MISMATCHED_STANDARD});
+			}
+			entry.asset = make_shared<InteropTextAsset>(entry.path, lazy);
+		}
+	});
+
+	map<string, shared_ptr<const ReelFileAsset>> references;
+	for (auto const& entry: entries) {
+		if (entry.cpl) {
+			for (auto reel_file_asset: entry.cpl->reel_file_assets()) {
+				references.insert(make_pair(reel_file_asset->asset_ref().id(), reel_file_asset));
+			}
+		}
+	}
+
+	for_each_entry(Entry::Kind::MXF, [&references, ignore_incorrect_picture_mxf_type, lazy](Entry& entry) {
+		auto iter = references.find(entry.id);
+		auto reference = iter != references.end() ? iter->second : shared_ptr<const ReelFileAsset>();
+
+		if (lazy) {
+			auto const path = entry.path;
+			entry.asset = make_shared<AssetProxy>(
+				entry.id, entry.path, entry.pkl_type,
+				[path, reference, ignore_incorrect_picture_mxf_type]() {
+					return asset_factory(path, reference, ignore_incorrect_picture_mxf_type, nullptr, true);
+				});
+			return;
+		}
+
+		bool found_threed_marked_as_twod = false;
+		entry.asset = asset_factory(entry.path, reference, ignore_incorrect_picture_mxf_type, &found_threed_marked_as_twod);
+		if (entry.asset->id() != entry.id) {
+			entry.notes.push_back(dcp::VerificationNote{VerificationNote::Code::MISMATCHED_ASSET_MAP_ID}.set_asset_id(entry.id).set_other_asset_id(entry.asset->id()));
+		}
+		if (found_threed_marked_as_twod) {
+			entry.notes.push_back(dcp::VerificationNote(VerificationNote::Code::THREED_ASSET_MARKED_AS_TWOD, entry.path).set_asset_id(entry.id));
+		}
+	});
+
+	for (auto& entry: entries) {
+		if (notes) {
+			std::copy(entry.notes.begin(), entry.notes.end(), std::back_inserter(*notes));
+		}
+		if (entry.error) {
+			std::rethrow_exception(entry.error);
+		}
+		if (entry.cpl) {
+			_cpls.push_back(entry.cpl);
+		}
+		if (entry.asset) {
+			other_assets.push_back(entry.asset);
 		}
 	}
 
@@ -344,6 +434,13 @@ DCP::read (vector<dcp::VerificationNote>* notes, bool ignore_incorrect_picture_m
 
 void
 DCP::resolve_refs (vector<shared_ptr<Asset>> assets)
+{
+	resolve_refs(AssetIndex(assets));
+}
+
+
+void
+DCP::resolve_refs (AssetIndex const& assets)
 {
 	for (auto i: cpls()) {
 		i->resolve_refs (assets);
@@ -552,21 +649,27 @@ vector<shared_ptr<Asset>>
 DCP::assets (bool ignore_unresolved) const
 {
 	vector<shared_ptr<Asset>> assets;
+	std::unordered_set<string> ids;
 	for (auto i: cpls()) {
 		assets.push_back (i);
+		ids.insert(i->id());
 		for (auto j: i->reel_file_assets()) {
 			if (ignore_unresolved && !j->asset_ref().resolved()) {
 				continue;
 			}
 
-			auto const id = j->asset_ref().id();
-			if (std::find_if(assets.begin(), assets.end(), [id](shared_ptr<Asset> asset) { return asset->id() == id; }) == assets.end()) {
+			if (ids.find(j->asset_ref().id()) == ids.end()) {
+				/* This loads any AssetProxy, so that callers can cast to the real asset type */
 				auto o = j->asset_ref().asset();
 				assets.push_back (o);
+				ids.insert(o->id());
 				/* More Interop special-casing */
 				auto sub = dynamic_pointer_cast<InteropTextAsset>(o);
 				if (sub) {
-					add_to_container(assets, sub->font_assets());
+					for (auto font: sub->font_assets()) {
+						assets.push_back(font);
+						ids.insert(font->id());
+					}
 				}
 			}
 		}
@@ -67,6 +67,7 @@ namespace dcp
 
 
 class Asset;
+class AssetIndex;
 class CPL;
 class CertificateChain;
 class Content;
@@ -115,8 +116,12 @@ public:
 	 *  @param ignore_incorrect_picture_mxf_type true to try loading MXF files marked as monoscopic
 	 *  as stereoscopic if the monoscopic load fails; fixes problems some 3D DCPs that (I think)
 	 *  have an incorrect descriptor in their MXF.
+	 *  @param lazy true to read only the XML files now, leaving each MXF to be opened the first time
+	 *  its asset is fetched from a Ref.  Problems with an MXF will then be reported by an exception at
+	 *  that point, and the MISMATCHED_ASSET_MAP_ID and THREED_ASSET_MARKED_AS_TWOD notes will not be
+	 *  added to notes.  Text assets will also read their font and image data only when it is first needed.
 	 */
-	void read (std::vector<VerificationNote>* notes = nullptr, bool ignore_incorrect_picture_mxf_type = false);
+	void read (std::vector<VerificationNote>* notes = nullptr, bool ignore_incorrect_picture_mxf_type = false, bool lazy = false);
 
 	/** Return summaries of the CPLs in this DCP.  This should only be used if the information
 	 *  in CPLSummary is all you need.  It's faster than read(), but if you need more than
@@ -138,7 +143,9 @@ public:
 
 	/** @param ignore_unresolved true to silently ignore unresolved assets, otherwise
 	 *  an exception is thrown if they are found.
-	 *  @return All assets (including CPLs).
+	 *  @return All assets (including CPLs).  If read() was called with lazy set, any assets
+	 *  which have not yet been read from their MXFs will be read now, so that the returned
+	 *  assets are always the real ones (never an AssetProxy).
 	 */
 	std::vector<std::shared_ptr<Asset>> assets (bool ignore_unresolved = false) const;
 
@@ -171,6 +178,7 @@ public:
 	);
 
 	void resolve_refs (std::vector<std::shared_ptr<Asset>> assets);
+	void resolve_refs (AssetIndex const& assets);
 
 	/** @return Standard of a DCP that was read in */
 	boost::optional<Standard> standard () const {
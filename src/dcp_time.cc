@@ -169,69 +169,85 @@ Time::Time (string time, optional<int> tcr_)
 }
 
 
+/** @return -1 if a < b, 0 if a == b or 1 if a > b.  Times are compared as
+ *  counts of editable units; where the timecode rates differ each count is
+ *  scaled by the other time's rate so that the comparison is still exact.
+ */
+static int
+compare (Time const & a, Time const & b)
+{
+	int64_t at = a.as_editable_units();
+	int64_t bt = b.as_editable_units();
+	if (a.tcr != b.tcr) {
+		at *= b.tcr;
+		bt *= a.tcr;
+	}
+
+	return (at > bt) - (at < bt);
+}
+
+
+/** @return a Time of @p units editable units at timecode rate @p tcr.
+ *  Borrows for negative times come from the hours, so only h will be negative.
+ */
+static Time
+from_editable_units (int64_t units, int tcr)
+{
+	int64_t const per_hour = int64_t(tcr) * 3600;
+	int64_t h = units / per_hour;
+	if (units % per_hour < 0) {
+		--h;
+	}
+	units -= h * per_hour;
+
+	int64_t const m = units / (int64_t(tcr) * 60);
+	units -= m * tcr * 60;
+	int64_t const s = units / tcr;
+	units -= s * tcr;
+
+	return Time (static_cast<int>(h), static_cast<int>(m), static_cast<int>(s), static_cast<int>(units), tcr);
+}
+
+
 bool
 dcp::operator== (Time const & a, Time const & b)
 {
-	return (a.h == b.h && a.m == b.m && a.s == b.s && (a.e * b.tcr) == (b.e * a.tcr));
+	return compare(a, b) == 0;
 }
 
 
 bool
 dcp::operator!= (Time const & a, Time const & b)
 {
-	return !(a == b);
+	return compare(a, b) != 0;
 }
 
 
 bool
 dcp::operator<= (Time const & a, Time const & b)
 {
-	return a < b || a == b;
+	return compare(a, b) <= 0;
 }
 
 
 bool
 dcp::operator>= (Time const & a, Time const & b)
 {
-	return a > b || a == b;
+	return compare(a, b) >= 0;
 }
 
 
 bool
 dcp::operator< (Time const & a, Time const & b)
 {
-	if (a.h != b.h) {
-		return a.h < b.h;
-	}
-
-	if (a.m != b.m) {
-		return a.m < b.m;
-	}
-
-	if (a.s != b.s) {
-		return a.s < b.s;
-	}
-
-	return (a.e * b.tcr) < (b.e * a.tcr);
+	return compare(a, b) < 0;
 }
 
 
 bool
 dcp::operator> (Time const & a, Time const & b)
 {
-	if (a.h != b.h) {
-		return a.h > b.h;
-	}
-
-	if (a.m != b.m) {
-		return a.m > b.m;
-	}
-
-	if (a.s != b.s) {
-		return a.s > b.s;
-	}
-
-	return (a.e * b.tcr) > (b.e * a.tcr);
+	return compare(a, b) > 0;
 }
 
 
@@ -246,85 +262,35 @@ dcp::operator<< (ostream& s, Time const & t)
 dcp::Time
 dcp::operator+ (Time a, Time b)
 {
-	Time r;
-
-	/* Make sure we have a common tcr */
-	if (a.tcr != b.tcr) {
-		a.e *= b.tcr;
-		b.e *= a.tcr;
-		r.tcr = a.tcr * b.tcr;
-	} else {
-		r.tcr = a.tcr;
+	if (a.tcr == b.tcr) {
+		return from_editable_units(a.as_editable_units() + b.as_editable_units(), a.tcr);
 	}
 
-	r.e = a.e + b.e;
-	if (r.e >= r.tcr) {
-		r.e -= r.tcr;
-		r.s++;
-	}
-
-	r.s += a.s + b.s;
-	if (r.s >= 60) {
-		r.s -= 60;
-		r.m++;
-	}
-
-	r.m += a.m + b.m;
-	if (r.m >= 60) {
-		r.m -= 60;
-		r.h++;
-	}
-
-	r.h += a.h + b.h;
-
-	return r;
+	/* Use the product of the two rates as a common one */
+	return from_editable_units(a.as_editable_units() * b.tcr + b.as_editable_units() * a.tcr, a.tcr * b.tcr);
 }
 
 
 dcp::Time
 dcp::operator- (Time a, Time b)
 {
-	Time r;
-
-	/* Make sure we have a common tcr */
-	if (a.tcr != b.tcr) {
-		a.e *= b.tcr;
-		b.e *= a.tcr;
-		r.tcr = a.tcr * b.tcr;
-	} else {
-		r.tcr = a.tcr;
-	}
-
-	r.e = a.e - b.e;
-	if (r.e < 0) {
-		r.e += r.tcr;
-		r.s--;
-	}
-
-	r.s += (a.s - b.s);
-	if (r.s < 0) {
-		r.s += 60;
-		r.m--;
-	}
-
-	r.m += (a.m - b.m);
-	if (r.m < 0) {
-		r.m += 60;
-		r.h--;
+	if (a.tcr == b.tcr) {
+		return from_editable_units(a.as_editable_units() - b.as_editable_units(), a.tcr);
 	}
 
-	r.h += (a.h - b.h);
-
-	return r;
+	/* Use the product of the two rates as a common one */
+	return from_editable_units(a.as_editable_units() * b.tcr - b.as_editable_units() * a.tcr, a.tcr * b.tcr);
 }
 
 
 float
 dcp::operator/ (Time a, Time const & b)
 {
-	int64_t const at = a.h * 3600 + a.m * 60 + a.s * float (a.e) / a.tcr;
-	int64_t const bt = b.h * 3600 + b.m * 60 + b.s * float (b.e) / b.tcr;
-	return float (at) / bt;
+	if (a.tcr == b.tcr) {
+		return double(a.as_editable_units()) / b.as_editable_units();
+	}
+
+	return double(a.as_editable_units() * b.tcr) / (b.as_editable_units() * a.tcr);
 }
 
 
@@ -126,6 +126,9 @@ public:
 	/** @return the total number of seconds that this time consists of */
 	double as_seconds () const;
 
+	/** @return the total number of editable units that this time consists of at its own timecode rate.
+	 *  Comparisons and arithmetic between Times are done using this count.
+	 */
 	int64_t as_editable_units() const;
 
 	/** @param tcr_ Timecode rate with which the return value should be counted
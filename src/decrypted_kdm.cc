@@ -45,6 +45,7 @@
 #include "decrypted_kdm_key.h"
 #include "encrypted_kdm.h"
 #include "exceptions.h"
+#include "parallel.h"
 #include "reel_asset.h"
 #include "reel_file_asset.h"
 #include "util.h"
@@ -140,46 +141,93 @@ get (uint8_t ** p, int N)
 }
 
 
-DecryptedKDM::DecryptedKDM (EncryptedKDM const & kdm, string private_key)
+RSA*
+DecryptedKDM::read_private_key (string const& private_key)
 {
-	/* Read the private key */
-
 	auto bio = BIO_new_mem_buf (const_cast<char *>(private_key.c_str()), -1);
 	if (!bio) {
 		throw MiscError ("could not create memory BIO");
 	}
 
 	auto rsa = PEM_read_bio_RSAPrivateKey (bio, 0, 0, 0);
+	BIO_free (bio);
 	if (!rsa) {
 		throw FileError ("could not read RSA private key file", private_key, errno);
 	}
 
-	/* Use the private key to decrypt the keys */
-
-	bool first = true;
+	return rsa;
+}
 
-	for (auto const& i: kdm.keys()) {
-		/* Decode the base-64-encoded cipher value from the KDM */
-		unsigned char cipher_value[256];
-		int const cipher_value_len = base64_decode (i, cipher_value, sizeof (cipher_value));
 
-		/* Decrypt it */
-		auto decrypted = new unsigned char[RSA_size(rsa)];
-		int const decrypted_len = RSA_private_decrypt (cipher_value_len, cipher_value, decrypted, rsa, RSA_PKCS1_OAEP_PADDING);
-		if (decrypted_len == -1) {
-			delete[] decrypted;
+/** Decrypt one of the keys from an EncryptedKDM.
+ *  @param cipher_value Base-64-encoded cipher value, as returned by EncryptedKDM::keys().
+ *  @param rsa Private key.
+ *  @return Decrypted key block.
+ */
+vector<uint8_t>
+DecryptedKDM::decrypt_key_block (string const& cipher_value, RSA* rsa)
+{
+	/* Decode the base-64-encoded cipher value from the KDM */
+	unsigned char cipher[256];
+	int const cipher_len = base64_decode (cipher_value, cipher, sizeof (cipher));
+
+	/* Decrypt it */
+	vector<uint8_t> decrypted (RSA_size(rsa));
+	int const decrypted_len = RSA_private_decrypt (cipher_len, cipher, decrypted.data(), rsa, RSA_PKCS1_OAEP_PADDING);
+	if (decrypted_len == -1) {
 #if OPENSSL_VERSION_NUMBER > 0x10100000L
-			throw KDMDecryptionError (ERR_error_string (ERR_get_error(), 0), cipher_value_len, RSA_bits(rsa));
+		throw KDMDecryptionError (ERR_error_string (ERR_get_error(), 0), cipher_len, RSA_bits(rsa));
 #else
-			throw KDMDecryptionError (ERR_error_string (ERR_get_error(), 0), cipher_value_len, rsa->n->dmax);
+		throw KDMDecryptionError (ERR_error_string (ERR_get_error(), 0), cipher_len, rsa->n->dmax);
 #endif
+	}
+
+	decrypted.resize (decrypted_len);
+	return decrypted;
+}
+
+
+DecryptedKDM::DecryptedKDM (EncryptedKDM const & kdm, string private_key)
+{
+	/* Read the private key */
+	auto rsa = read_private_key (private_key);
+
+	/* Use the private key to decrypt the keys */
+	vector<vector<uint8_t>> blocks;
+	try {
+		for (auto const& i: kdm.keys()) {
+			blocks.push_back (decrypt_key_block(i, rsa));
 		}
+	} catch (...) {
+		RSA_free (rsa);
+		throw;
+	}
 
+	RSA_free (rsa);
+
+	read_key_blocks (kdm, blocks);
+}
+
+
+DecryptedKDM::DecryptedKDM (EncryptedKDM const & kdm, vector<vector<uint8_t>> const& decrypted_blocks)
+{
+	read_key_blocks (kdm, decrypted_blocks);
+}
+
+
+/** Fill in our keys and details from an EncryptedKDM and the decrypted versions of its keys */
+void
+DecryptedKDM::read_key_blocks (EncryptedKDM const& kdm, vector<vector<uint8_t>> const& decrypted_blocks)
+{
+	bool first = true;
+
+	for (auto const& block: decrypted_blocks) {
 		dcp::LocalTime not_valid_before;
 		dcp::LocalTime not_valid_after;
 
-		unsigned char* p = decrypted;
-		switch (decrypted_len) {
+		auto decrypted = block;
+		unsigned char* p = decrypted.data();
+		switch (decrypted.size()) {
 		case 134:
 		{
 			/* Inter-op */
@@ -229,8 +277,6 @@ DecryptedKDM::DecryptedKDM (EncryptedKDM const & kdm, string private_key)
 			DCP_ASSERT (false);
 		}
 
-		delete[] decrypted;
-
 		if (first) {
 			_not_valid_before = not_valid_before;
 			_not_valid_after = not_valid_after;
@@ -242,9 +288,6 @@ DecryptedKDM::DecryptedKDM (EncryptedKDM const & kdm, string private_key)
 		}
 	}
 
-	RSA_free (rsa);
-	BIO_free (bio);
-
 	_annotation_text = kdm.annotation_text ();
 	_content_title_text = kdm.content_title_text ();
 	_issue_date = kdm.issue_date ();
@@ -333,18 +376,9 @@ DecryptedKDM::add_key (DecryptedKDMKey key)
 }
 
 
-EncryptedKDM
-DecryptedKDM::encrypt (
-	shared_ptr<const CertificateChain> signer,
-	Certificate recipient,
-	vector<string> trusted_devices,
-	Formulation formulation,
-	bool disable_forensic_marking_picture,
-	optional<int> disable_forensic_marking_audio
-	) const
+void
+DecryptedKDM::check_signer_dates (shared_ptr<const CertificateChain> signer) const
 {
-	DCP_ASSERT (!_keys.empty ());
-
 	for (auto i: signer->leaf_to_root()) {
 		if (day_greater_than_or_equal(i.not_before(), _not_valid_before)) {
 			throw BadKDMDateError (true);
@@ -352,13 +386,19 @@ DecryptedKDM::encrypt (
 			throw BadKDMDateError (false);
 		}
 	}
+}
 
-	vector<pair<string, string>> key_ids;
-	vector<string> keys;
+
+/** @return Plaintext blocks for each of our keys, ready to be encrypted with a recipient's public key */
+vector<vector<uint8_t>>
+DecryptedKDM::key_blocks (shared_ptr<const CertificateChain> signer) const
+{
+	auto const signer_thumbprint = signer->leaf().thumbprint();
+
+	vector<vector<uint8_t>> blocks;
 	for (auto const& i: _keys) {
 		/* We're making SMPTE keys so we must have a type for each one */
 		DCP_ASSERT (i.type());
-		key_ids.push_back (make_pair (i.type().get(), i.id ()));
 
 		/* XXX: SMPTE only */
 		uint8_t block[138];
@@ -366,7 +406,7 @@ DecryptedKDM::encrypt (
 
 		put (&p, smpte_structure_id, 16);
 
-		base64_decode (signer->leaf().thumbprint (), p, 20);
+		base64_decode (signer_thumbprint, p, 20);
 		p += 20;
 
 		put_uuid (&p, i.cpl_id ());
@@ -376,27 +416,71 @@ DecryptedKDM::encrypt (
 		put (&p, _not_valid_after.as_string ());
 		put (&p, i.key().value(), ASDCP::KeyLen);
 
-		/* Encrypt using the projector's public key */
-		RSA* rsa = recipient.public_key ();
-		std::vector<unsigned char> encrypted(RSA_size(rsa));
-		int const encrypted_len = RSA_public_encrypt(p - block, block, encrypted.data(), rsa, RSA_PKCS1_OAEP_PADDING);
-		if (encrypted_len == -1) {
-			throw MiscError (String::compose ("Could not encrypt KDM (%1)", ERR_error_string (ERR_get_error(), 0)));
-		}
+		blocks.push_back (vector<uint8_t>(block, p));
+	}
 
-		/* Lazy overallocation */
-		vector<char> out(encrypted_len * 2);
-		Kumu::base64encode(encrypted.data(), encrypted_len, out.data(), encrypted_len * 2);
-		int const N = strlen(out.data());
-		string lines;
-		for (int i = 0; i < N; ++i) {
-			if (i > 0 && (i % 64) == 0) {
-				lines += "\n";
-			}
-			lines += out[i];
+	return blocks;
+}
+
+
+/** Encrypt a key block using a recipient's public key.
+ *  @return base64-encoded encrypted block, split into lines.
+ */
+static string
+encrypt_key_block (vector<uint8_t> const& block, RSA* rsa)
+{
+	std::vector<unsigned char> encrypted(RSA_size(rsa));
+	int const encrypted_len = RSA_public_encrypt(block.size(), block.data(), encrypted.data(), rsa, RSA_PKCS1_OAEP_PADDING);
+	if (encrypted_len == -1) {
+		throw MiscError (String::compose ("Could not encrypt KDM (%1)", ERR_error_string (ERR_get_error(), 0)));
+	}
+
+	/* Lazy overallocation */
+	vector<char> out(encrypted_len * 2);
+	Kumu::base64encode(encrypted.data(), encrypted_len, out.data(), encrypted_len * 2);
+	int const N = strlen(out.data());
+	string lines;
+	for (int i = 0; i < N; ++i) {
+		if (i > 0 && (i % 64) == 0) {
+			lines += "\n";
 		}
+		lines += out[i];
+	}
+
+	return lines;
+}
+
 
-		keys.push_back (lines);
+vector<pair<string, string>>
+DecryptedKDM::key_ids () const
+{
+	vector<pair<string, string>> ids;
+	for (auto const& i: _keys) {
+		DCP_ASSERT (i.type());
+		ids.push_back (make_pair (i.type().get(), i.id ()));
+	}
+	return ids;
+}
+
+
+EncryptedKDM
+DecryptedKDM::encrypt (
+	shared_ptr<const CertificateChain> signer,
+	Certificate recipient,
+	vector<string> trusted_devices,
+	Formulation formulation,
+	bool disable_forensic_marking_picture,
+	optional<int> disable_forensic_marking_audio
+	) const
+{
+	DCP_ASSERT (!_keys.empty ());
+
+	check_signer_dates (signer);
+
+	/* Encrypt using the projector's public key */
+	vector<string> keys;
+	for (auto const& i: key_blocks(signer)) {
+		keys.push_back (encrypt_key_block(i, recipient.public_key()));
 	}
 
 	return EncryptedKDM (
@@ -411,7 +495,64 @@ DecryptedKDM::encrypt (
 		formulation,
 		disable_forensic_marking_picture,
 		disable_forensic_marking_audio,
-		key_ids,
+		key_ids (),
 		keys
 		);
 }
+
+
+vector<EncryptedKDM>
+DecryptedKDM::encrypt (
+	shared_ptr<const CertificateChain> signer,
+	vector<KDMRecipient> const& recipients,
+	Formulation formulation,
+	bool disable_forensic_marking_picture,
+	optional<int> disable_forensic_marking_audio,
+	int threads
+	) const
+{
+	DCP_ASSERT (!_keys.empty ());
+
+	/* Do everything that is the same for every recipient once, up front */
+	check_signer_dates (signer);
+	auto const blocks = key_blocks (signer);
+	auto const ids = key_ids ();
+
+	vector<shared_ptr<EncryptedKDM>> kdms (recipients.size());
+
+	parallel_for (recipients.size(), threads, [&](int index) {
+		auto const& recipient = recipients[index];
+		/* This is parsed once per recipient and then cached by the Certificate */
+		auto rsa = recipient.certificate.public_key();
+
+		vector<string> keys;
+		for (auto const& i: blocks) {
+			keys.push_back (encrypt_key_block(i, rsa));
+		}
+
+		kdms[index].reset (
+			new EncryptedKDM (
+				signer,
+				recipient.certificate,
+				recipient.trusted_devices,
+				_keys.front().cpl_id (),
+				_content_title_text,
+				_annotation_text,
+				_not_valid_before,
+				_not_valid_after,
+				formulation,
+				disable_forensic_marking_picture,
+				disable_forensic_marking_audio,
+				ids,
+				keys
+				)
+			);
+	});
+
+	vector<EncryptedKDM> out;
+	for (auto i: kdms) {
+		out.push_back (*i);
+	}
+
+	return out;
+}
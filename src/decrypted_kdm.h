@@ -62,6 +62,23 @@ class CPL;
 class ReelFileAsset;
 
 
+/** @struct KDMRecipient
+ *  @brief Details of one recipient when encrypting a DecryptedKDM for many recipients at once.
+ */
+struct KDMRecipient
+{
+	explicit KDMRecipient (Certificate certificate_, std::vector<std::string> trusted_devices_ = std::vector<std::string>())
+		: certificate (certificate_)
+		, trusted_devices (trusted_devices_)
+	{}
+
+	/** Certificate of the projector/server which should receive the KDM's keys */
+	Certificate certificate;
+	/** Thumbprints of extra trusted devices to write to the KDM, as for DecryptedKDM::encrypt */
+	std::vector<std::string> trusted_devices;
+};
+
+
 /** @class DecryptedKDM
  *  @brief A decrypted KDM
  *
@@ -144,6 +161,27 @@ public:
 		boost::optional<int> disable_forensic_marking_audio
 		) const;
 
+	/** Encrypt this KDM's keys for a number of recipients, and sign each of the resulting KDMs.
+	 *  This is much quicker than calling the single-recipient encrypt() for each recipient, since
+	 *  the signer's details are only worked out once and the KDMs are made in parallel.
+	 *
+	 *  @param signer Chain to sign with.
+	 *  @param recipients Recipients to make KDMs for.
+	 *  @param formulation Formulation to use for the encrypted KDMs.
+	 *  @param disable_forensic_marking_picture true to disable forensic marking of picture.
+	 *  @param disable_forensic_marking_audio as for the single-recipient encrypt().
+	 *  @param threads Number of threads to use, or 0 for one per CPU.
+	 *  @return Encrypted KDMs, in the same order as recipients.
+	 */
+	std::vector<EncryptedKDM> encrypt (
+		std::shared_ptr<const CertificateChain> signer,
+		std::vector<KDMRecipient> const& recipients,
+		Formulation formulation,
+		bool disable_forensic_marking_picture,
+		boost::optional<int> disable_forensic_marking_audio,
+		int threads = 0
+		) const;
+
 	/** @param type (MDIK, MDAK etc.)
 	 *  @param key_id Key ID
 	 *  @param key The actual symmetric key
@@ -173,10 +211,21 @@ public:
 private:
 
 	friend struct ::decrypted_kdm_test;
+	friend class KDMDecrypter;
+
+	DecryptedKDM (EncryptedKDM const& kdm, std::vector<std::vector<uint8_t>> const& decrypted_blocks);
+
+	void read_key_blocks (EncryptedKDM const& kdm, std::vector<std::vector<uint8_t>> const& decrypted_blocks);
+	static RSA* read_private_key (std::string const& private_key);
+	static std::vector<uint8_t> decrypt_key_block (std::string const& cipher_value, RSA* rsa);
 
 	static void put_uuid (uint8_t ** d, std::string id);
 	static std::string get_uuid (unsigned char ** p);
 
+	void check_signer_dates (std::shared_ptr<const CertificateChain> signer) const;
+	std::vector<std::vector<uint8_t>> key_blocks (std::shared_ptr<const CertificateChain> signer) const;
+	std::vector<std::pair<std::string, std::string>> key_ids () const;
+
 	LocalTime _not_valid_before;
 	LocalTime _not_valid_after;
 	boost::optional<std::string> _annotation_text;
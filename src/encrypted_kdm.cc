@@ -609,7 +609,7 @@ EncryptedKDM::EncryptedKDM (string s)
 
 EncryptedKDM::EncryptedKDM (
 	shared_ptr<const CertificateChain> signer,
-	Certificate recipient,
+	Certificate const& recipient,
 	vector<string> trusted_devices,
 	string cpl_id,
 	string content_title_text,
@@ -635,9 +635,11 @@ EncryptedKDM::EncryptedKDM (
 	 * DCI_SPECIFIC                       as specified          Yes
 	 */
 
+	auto const signer_leaf = signer->leaf();
+
 	auto& aup = _data->authenticated_public;
-	aup.signer.x509_issuer_name = signer->leaf().issuer ();
-	aup.signer.x509_serial_number = signer->leaf().serial ();
+	aup.signer.x509_issuer_name = signer_leaf.issuer ();
+	aup.signer.x509_serial_number = signer_leaf.serial ();
 	aup.annotation_text = annotation_text;
 
 	auto& kre = _data->authenticated_public.required_extensions.kdm_required_extensions;
@@ -650,7 +652,7 @@ EncryptedKDM::EncryptedKDM (
 		 * which might not necessarily be the case if we're using a CPL from somebody
 		 * else.
 		 */
-		kre.content_authenticator = signer->leaf().thumbprint ();
+		kre.content_authenticator = signer_leaf.thumbprint ();
 	}
 	kre.content_title_text = content_title_text;
 	kre.not_valid_before = not_valid_before;
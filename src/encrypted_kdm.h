@@ -112,7 +112,7 @@ private:
 	/** Construct an EncryptedKDM from a set of details */
 	EncryptedKDM (
 		std::shared_ptr<const CertificateChain> signer,
-		Certificate recipient,
+		Certificate const& recipient,
 		std::vector<std::string> trusted_devices,
 		std::string cpl_id,
 		std::string cpl_content_title_text,
@@ -72,6 +72,10 @@ public:
 	bool reel_hashes_can_differ = false;
 	/** true if asset hashes can differ */
 	bool asset_hashes_can_differ = false;
+	/** true to assume that picture and sound assets are the same if their hashes are already known
+	 *  (e.g. from PKLs) and the same, without looking at their files
+	 */
+	bool trust_known_hashes = false;
 	/** true if IssueDate nodes can differ */
 	bool issue_dates_can_differ = false;
 	bool load_font_nodes_can_differ = false;
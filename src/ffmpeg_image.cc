@@ -43,9 +43,18 @@ using namespace dcp;
 
 
 FFmpegImage::FFmpegImage(int64_t pts)
+	: FFmpegImage({1920, 1080}, pts)
 {
-	auto const width = size().width;
-	auto const height = size().height;
+
+}
+
+
+FFmpegImage::FFmpegImage(Size size, int64_t pts)
+{
+	auto const width = size.width;
+	auto const height = size.height;
+	auto const chroma_width = (width + 1) / 2;
+	auto const chroma_height = (height + 1) / 2;
 
 	_frame = av_frame_alloc();
 	if (!_frame) {
@@ -53,12 +62,19 @@ FFmpegImage::FFmpegImage(int64_t pts)
 	}
 
 	_frame->buf[0] = av_buffer_alloc(width * height);
-	_frame->buf[1] = av_buffer_alloc(width * height / 4);
-	_frame->buf[2] = av_buffer_alloc(width * height / 4);
+	_frame->buf[1] = av_buffer_alloc(chroma_width * chroma_height);
+	_frame->buf[2] = av_buffer_alloc(chroma_width * chroma_height);
+
+	for (auto i = 0; i < 3; ++i) {
+		if (!_frame->buf[i]) {
+			av_frame_free(&_frame);
+			throw std::bad_alloc();
+		}
+	}
 
 	_frame->linesize[0] = width;
-	_frame->linesize[1] = width / 2;
-	_frame->linesize[2] = width / 2;
+	_frame->linesize[1] = chroma_width;
+	_frame->linesize[2] = chroma_width;
 
 	for (auto i = 0; i < 3; ++i) {
 		_frame->data[i] = _frame->buf[i]->data;
@@ -85,6 +101,13 @@ FFmpegImage::y()
 }
 
 
+uint8_t const*
+FFmpegImage::y() const
+{
+	return _frame->data[0];
+}
+
+
 int
 FFmpegImage::y_stride() const
 {
@@ -99,6 +122,13 @@ FFmpegImage::u()
 }
 
 
+uint8_t const*
+FFmpegImage::u() const
+{
+	return _frame->data[1];
+}
+
+
 int
 FFmpegImage::u_stride() const
 {
@@ -113,6 +143,13 @@ FFmpegImage::v()
 }
 
 
+uint8_t const*
+FFmpegImage::v() const
+{
+	return _frame->data[2];
+}
+
+
 int
 FFmpegImage::v_stride() const
 {
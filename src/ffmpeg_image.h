@@ -53,8 +53,12 @@ namespace dcp {
 class FFmpegImage
 {
 public:
+	/** Make a 1920x1080 YUV420P image with undefined contents */
 	explicit FFmpegImage(int64_t pts);
 
+	/** Make a YUV420P image with undefined contents */
+	FFmpegImage(Size size, int64_t pts);
+
 	explicit FFmpegImage(AVFrame* frame)
 		: _frame(frame)
 	{}
@@ -81,16 +85,19 @@ public:
 	}
 
 	uint8_t* y();
+	uint8_t const* y() const;
 	int y_stride() const;
 
 	uint8_t* u();
+	uint8_t const* u() const;
 	int u_stride() const;
 
 	uint8_t* v();
+	uint8_t const* v() const;
 	int v_stride() const;
 
 	Size size() const {
-		return { 1920, 1080 };
+		return { _frame->width, _frame->height };
 	}
 
 	void set_pts(int64_t pts);
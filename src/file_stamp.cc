@@ -0,0 +1,108 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/file_stamp.cc
+ *  @brief FileStamp struct
+ */
+
+
+#include "file_stamp.h"
+#include "filesystem.h"
+#include "scope_guard.h"
+#include <chrono>
+#ifdef LIBDCP_WINDOWS
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+
+using boost::optional;
+using namespace dcp;
+
+
+optional<FileStamp>
+FileStamp::of(boost::filesystem::path file)
+{
+	FileStamp stamp;
+
+#ifdef LIBDCP_WINDOWS
+	auto handle = CreateFileW(
+		filesystem::fix_long_path(file).wstring().c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr
+		);
+	if (handle == INVALID_HANDLE_VALUE) {
+		return {};
+	}
+	ScopeGuard sg = [handle]() { CloseHandle(handle); };
+
+	BY_HANDLE_FILE_INFORMATION info;
+	if (!GetFileInformationByHandle(handle, &info)) {
+		return {};
+	}
+
+	stamp.size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+	/* ftLastWriteTime counts 100ns intervals since 1601 */
+	auto const ticks = (static_cast<int64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+	stamp.mtime = (ticks - 116444736000000000LL) * 100;
+	stamp.device = info.dwVolumeSerialNumber;
+	stamp.inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+#else
+	struct stat st;
+	if (stat(filesystem::fix_long_path(file).string().c_str(), &st) != 0) {
+		return {};
+	}
+	stamp.size = st.st_size;
+#ifdef LIBDCP_OSX
+	stamp.mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+	stamp.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+	stamp.device = st.st_dev;
+	stamp.inode = st.st_ino;
+#endif
+
+	return stamp;
+}
+
+
+bool
+FileStamp::recent() const
+{
+	/* Some filesystems (e.g. FAT) only keep modification times to the nearest 2 seconds */
+	int64_t const margin = 2000000000;
+	auto const now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	return mtime > now - margin;
+}
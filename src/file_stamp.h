@@ -0,0 +1,89 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/file_stamp.h
+ *  @brief FileStamp struct
+ */
+
+
+#ifndef LIBDCP_FILE_STAMP_H
+#define LIBDCP_FILE_STAMP_H
+
+
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+
+
+namespace dcp {
+
+
+/** @struct FileStamp
+ *  @brief Details of a file which will change if the file is modified or replaced, so that things
+ *  worked out from the file's contents can be kept until then.
+ */
+struct FileStamp
+{
+	uint64_t size = 0;
+	/** Modification time in nanoseconds since the epoch, to whatever resolution the filesystem keeps */
+	int64_t mtime = 0;
+	/** Device (or, on Windows, volume serial number) that the file is on */
+	uint64_t device = 0;
+	/** Inode (or, on Windows, file index) of the file on its device */
+	uint64_t inode = 0;
+
+	/** @return the stamp of a file as it is now on disk, or an empty optional if it cannot be found */
+	static boost::optional<FileStamp> of(boost::filesystem::path file);
+
+	/** @return true if the file was modified so recently (or, apparently, in the future) that it
+	 *  could be changed again without its modification time changing.  Such a stamp cannot be
+	 *  relied on to show that the file has not changed.
+	 */
+	bool recent() const;
+
+	bool operator==(FileStamp const& other) const {
+		return size == other.size && mtime == other.mtime && device == other.device && inode == other.inode;
+	}
+
+	bool operator!=(FileStamp const& other) const {
+		return !(*this == other);
+	}
+};
+
+
+}
+
+
+#endif
@@ -48,6 +48,7 @@
 #include "raw_convert.h"
 #include "text_asset_internal.h"
 #include "text_image.h"
+#include "text_parser.h"
 #include "util.h"
 #include "warnings.h"
 #include "xml.h"
@@ -71,33 +72,36 @@ using boost::optional;
 using namespace dcp;
 
 
-InteropTextAsset::InteropTextAsset(boost::filesystem::path file)
+InteropTextAsset::InteropTextAsset(boost::filesystem::path file, bool lazy)
 	: TextAsset(file)
+	, _lazy(lazy)
 {
 	_raw_xml = dcp::file_to_string(file, 10 * 1024 * 1024);
 
-	auto xml = make_shared<cxml::Document>("DCSubtitle");
-	xml->read_file(dcp::filesystem::fix_long_path(file));
-	_id = xml->string_child ("SubtitleID");
-	_reel_number = xml->string_child ("ReelNumber");
-	_language = xml->string_child ("Language");
-	_movie_title = xml->string_child ("MovieTitle");
-	_load_font_nodes = type_children<InteropLoadFontNode> (xml, "LoadFont");
-
-	/* Now we need to drop down to xmlpp */
-
-	vector<ParseState> ps;
-	for (auto i: xml->node()->get_children()) {
-		auto e = dynamic_cast<xmlpp::Element const *>(i);
-		if (e && (e->get_name() == "Font" || e->get_name() == "Subtitle")) {
-			parse_texts (e, ps, optional<int>(), Standard::INTEROP);
+	TextParser parser(Standard::INTEROP);
+	parse_raw_xml(parser, "DCSubtitle");
+
+	_id = parser.string_child("SubtitleID");
+	_reel_number = parser.string_child("ReelNumber");
+	_language = parser.string_child("Language");
+	_movie_title = parser.string_child("MovieTitle");
+	for (auto const& load_font: parser.children("LoadFont")) {
+		auto id = load_font.attributes.optional_string_attribute("Id");
+		if (!id) {
+			id = load_font.attributes.optional_string_attribute("ID");
 		}
+		_load_font_nodes.push_back(make_shared<InteropLoadFontNode>(id.get_value_or(""), load_font.attributes.string_attribute("URI")));
 	}
 
 	for (auto i: _texts) {
 		auto si = dynamic_pointer_cast<TextImage>(i);
 		if (si) {
-			si->read_png_file (file.parent_path() / String::compose("%1.png", si->id()));
+			auto const png = file.parent_path() / String::compose("%1.png", si->id());
+			if (lazy) {
+				si->set_png_file(png);
+			} else {
+				si->read_png_file(png);
+			}
 		}
 	}
 }
@@ -200,7 +204,7 @@ InteropTextAsset::write(boost::filesystem::path p) const
 		throw FileError ("Could not open file for writing", p, -1);
 	}
 
-	_raw_xml = xml_as_string ();
+	set_raw_xml(xml_as_string());
 	/* length() here gives bytes not characters */
 	f.write(_raw_xml->c_str(), 1, _raw_xml->length());
 
@@ -218,7 +222,7 @@ InteropTextAsset::write(boost::filesystem::path p) const
 		auto file = p.parent_path() / i->uri;
 		auto font_with_id = std::find_if(_fonts.begin(), _fonts.end(), [i](Font const& font) { return font.load_id == i->id; });
 		if (font_with_id != _fonts.end()) {
-			font_with_id->data.write(file);
+			font_with_id->data.get().write(file);
 			font_with_id->file = file;
 		}
 	}
@@ -245,9 +249,9 @@ InteropTextAsset::resolve_fonts(vector<shared_ptr<Asset>> assets)
 			if (font->file() && path_in_load_font_node == *font->file()) {
 				auto existing = std::find_if(_fonts.begin(), _fonts.end(), [load_font_node](Font const& font) { return font.load_id == load_font_node->id; });
 				if (existing != _fonts.end()) {
-					*existing = Font(load_font_node->id, asset->id(), font->file().get());
+					*existing = Font(load_font_node->id, asset->id(), font->file().get(), _lazy);
 				} else {
-					_fonts.push_back(Font(load_font_node->id, asset->id(), font->file().get()));
+					_fonts.push_back(Font(load_font_node->id, asset->id(), font->file().get(), _lazy));
 				}
 			}
 		}
@@ -61,7 +61,13 @@ class InteropTextAsset : public TextAsset
 {
 public:
 	InteropTextAsset();
-	explicit InteropTextAsset(boost::filesystem::path file);
+
+	/** Construct an InteropTextAsset by reading an XML file
+	 *  @param file Filename
+	 *  @param lazy true to leave the PNG files of any image subtitles, and any fonts found by resolve_fonts(),
+	 *  to be read the first time that they are needed.
+	 */
+	explicit InteropTextAsset(boost::filesystem::path file, bool lazy = false);
 
 	bool equals (
 		std::shared_ptr<const Asset>,
@@ -153,6 +159,8 @@ private:
 	std::string _language;
 	std::string _movie_title;
 	std::vector<std::shared_ptr<InteropLoadFontNode>> _load_font_nodes;
+	/** true to read font and image data from files when they are first needed */
+	bool _lazy = false;
 };
 
 
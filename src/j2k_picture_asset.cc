@@ -50,13 +50,14 @@
 #include <asdcp/KM_fileio.h>
 #include <libxml++/nodes/element.h>
 #include <boost/filesystem.hpp>
+#include <cmath>
+#include <cstdlib>
 #include <list>
 #include <stdexcept>
 
 
 using std::string;
 using std::list;
-using std::vector;
 using std::max;
 using std::pair;
 using std::make_pair;
@@ -149,51 +150,66 @@ J2KPictureAsset::frame_buffer_equals (
 	auto image_A = decompress_j2k (const_cast<uint8_t*>(data_A), size_A, 0);
 	auto image_B = decompress_j2k (const_cast<uint8_t*>(data_B), size_B, 0);
 
-	/* Compare them */
-
-	vector<int> abs_diffs (image_A->size().width * image_A->size().height * 3);
-	int d = 0;
-	int max_diff = 0;
+	if (image_A->size() != image_B->size()) {
+		note (NoteType::ERROR, String::compose ("image sizes for frame %1 differ", frame));
+		return false;
+	}
 
-	for (int c = 0; c < 3; ++c) {
+	/* Compare them, finding the mean, standard deviation and maximum of the absolute differences
+	 * between corresponding samples in one pass, without storing the differences.
+	 */
 
-		if (image_A->size() != image_B->size()) {
-			note (NoteType::ERROR, String::compose ("image sizes for frame %1 differ", frame));
-			return false;
-		}
-
-		int const pixels = image_A->size().width * image_A->size().height;
-		for (int j = 0; j < pixels; ++j) {
-			int const t = abs (image_A->data(c)[j] - image_B->data(c)[j]);
-			abs_diffs[d++] = t;
-			max_diff = max (max_diff, t);
-		}
-	}
+	int const width = image_A->size().width;
+	int const height = image_A->size().height;
+	double const samples = 3.0 * width * height;
+	/* If the total of the differences gets above this the mean will be out of range whatever the
+	 * rest of the image is like, so we can stop.
+	 */
+	double const total_limit = opt.max_mean_pixel_error * samples;
 
 	uint64_t total = 0;
-	for (vector<int>::iterator j = abs_diffs.begin(); j != abs_diffs.end(); ++j) {
-		total += *j;
-	}
-
-	double const mean = double (total) / abs_diffs.size ();
+	uint64_t total_squared = 0;
+	int max_diff = 0;
 
-	uint64_t total_squared_deviation = 0;
-	for (auto j: abs_diffs) {
-		total_squared_deviation += pow (j - mean, 2);
+	for (int c = 0; c < 3; ++c) {
+		int const* a = image_A->data(c);
+		int const* b = image_B->data(c);
+		for (int y = 0; y < height; ++y) {
+			/* Keep this loop simple so that the compiler can vectorise it */
+			uint64_t row_total = 0;
+			uint64_t row_squared = 0;
+			int row_max = 0;
+#ifdef LIBDCP_OPENMP
+#pragma omp simd reduction(+:row_total, row_squared) reduction(max:row_max)
+#endif
+			for (int x = 0; x < width; ++x) {
+				int const d = std::abs(a[x] - b[x]);
+				row_total += d;
+				row_squared += static_cast<uint64_t>(d) * d;
+				row_max = max(row_max, d);
+			}
+
+			total += row_total;
+			total_squared += row_squared;
+			max_diff = max(max_diff, row_max);
+			a += width;
+			b += width;
+
+			if (total > total_limit) {
+				note (
+					NoteType::ERROR,
+					String::compose("mean at least %1 out of range %2 in frame %3", total / samples, opt.max_mean_pixel_error, frame)
+					);
+				return false;
+			}
+		}
 	}
 
-	auto const std_dev = sqrt (double (total_squared_deviation) / abs_diffs.size());
-
-	note (NoteType::NOTE, String::compose("mean difference %1 deviation %2", mean, std_dev));
-
-	if (mean > opt.max_mean_pixel_error) {
-		note (
-			NoteType::ERROR,
-			String::compose ("mean %1 out of range %2 in frame %3", mean, opt.max_mean_pixel_error, frame)
-			);
+	double const mean = total / samples;
+	/* Var(X) = E(X^2) - E(X)^2; rounding could make this very slightly negative when it should be 0 */
+	auto const std_dev = sqrt(std::max(0.0, total_squared / samples - mean * mean));
 
-		return false;
-	}
+	note (NoteType::NOTE, String::compose("mean difference %1 deviation %2 maximum %3", mean, std_dev, max_diff));
 
 	if (std_dev > opt.max_std_dev_pixel_error) {
 		note (
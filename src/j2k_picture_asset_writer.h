@@ -71,6 +71,8 @@ public:
 protected:
 	template <class P, class Q>
 	friend void start (J2KPictureAssetWriter *, std::shared_ptr<P>, Q *, uint8_t const *, int);
+	template <class P, class Q>
+	friend void start_with_descriptor (J2KPictureAssetWriter *, std::shared_ptr<P>, Q *);
 
 	J2KPictureAssetWriter (J2KPictureAsset *, boost::filesystem::path, bool);
 
@@ -62,16 +62,12 @@ struct ASDCPJ2KStateBase
 }
 
 
+/** Open the MXF for writing using the picture descriptor which is already in state */
 template <class P, class Q>
-void dcp::start (J2KPictureAssetWriter* writer, shared_ptr<P> state, Q* asset, uint8_t const * data, int size)
+void dcp::start_with_descriptor (J2KPictureAssetWriter* writer, shared_ptr<P> state, Q* asset)
 {
 	asset->set_file (writer->_file);
 
-	if (ASDCP_FAILURE (state->j2k_parser.OpenReadFrame(data, size, state->frame_buffer))) {
-		boost::throw_exception (MiscError ("could not parse J2K frame"));
-	}
-
-	state->j2k_parser.FillPictureDescriptor (state->picture_descriptor);
 	state->picture_descriptor.EditRate = ASDCP::Rational (asset->edit_rate().numerator, asset->edit_rate().denominator);
 
 	asset->set_size (Size (state->picture_descriptor.StoredWidth, state->picture_descriptor.StoredHeight));
@@ -93,3 +89,15 @@ void dcp::start (J2KPictureAssetWriter* writer, shared_ptr<P> state, Q* asset, u
 
 	writer->_started = true;
 }
+
+
+template <class P, class Q>
+void dcp::start (J2KPictureAssetWriter* writer, shared_ptr<P> state, Q* asset, uint8_t const * data, int size)
+{
+	if (ASDCP_FAILURE (state->j2k_parser.OpenReadFrame(data, size, state->frame_buffer))) {
+		boost::throw_exception (MiscError ("could not parse J2K frame"));
+	}
+
+	state->j2k_parser.FillPictureDescriptor (state->picture_descriptor);
+	start_with_descriptor (writer, state, asset);
+}
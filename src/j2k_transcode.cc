@@ -42,12 +42,14 @@
 #include "exceptions.h"
 #include "openjpeg_image.h"
 #include "dcp_assert.h"
+#include "xyz_image.h"
 #include "compose.hpp"
 #include <openjpeg.h>
 #include <cmath>
 #include <iostream>
 
 
+using std::make_shared;
 using std::min;
 using std::pow;
 using std::string;
@@ -70,6 +72,21 @@ dcp::decompress_j2k (shared_ptr<const Data> data, int reduce)
 }
 
 
+shared_ptr<dcp::XYZImage>
+dcp::decompress_j2k_xyz (uint8_t const * data, int64_t size, int reduce)
+{
+	/* openjpeg can only decode to 32-bit components, so we convert afterwards and let the large image go */
+	return make_shared<XYZImage>(*decompress_j2k(data, size, reduce));
+}
+
+
+shared_ptr<dcp::XYZImage>
+dcp::decompress_j2k_xyz (Data const& data, int reduce)
+{
+	return dcp::decompress_j2k_xyz (data.data(), data.size(), reduce);
+}
+
+
 class ReadBuffer
 {
 public:
@@ -332,3 +349,9 @@ dcp::compress_j2k (shared_ptr<const OpenJPEGImage> xyz, int bandwidth, int frame
 	return enc;
 }
 
+
+ArrayData
+dcp::compress_j2k (XYZImage const& xyz, int bandwidth, int frames_per_second, bool threed, bool fourk, string comment)
+{
+	return compress_j2k (xyz.to_openjpeg(), bandwidth, frames_per_second, threed, fourk, comment);
+}
@@ -46,6 +46,7 @@ namespace dcp {
 
 
 class OpenJPEGImage;
+class XYZImage;
 
 
 /** Decompress a JPEG2000 image to a bitmap
@@ -62,10 +63,19 @@ extern std::shared_ptr<OpenJPEGImage> decompress_j2k (uint8_t const * data, int6
 extern std::shared_ptr<OpenJPEGImage> decompress_j2k (Data const& data, int reduce);
 extern std::shared_ptr<OpenJPEGImage> decompress_j2k (std::shared_ptr<const Data> data, int reduce);
 
+/** Decompress a JPEG2000 image to a 16-bit XYZImage, which takes half the memory of the OpenJPEGImage
+ *  that decompress_j2k() would return.  The parameters are the same as for decompress_j2k().
+ */
+extern std::shared_ptr<XYZImage> decompress_j2k_xyz (uint8_t const * data, int64_t size, int reduce);
+extern std::shared_ptr<XYZImage> decompress_j2k_xyz (Data const& data, int reduce);
+
 /** @xyz Picture to compress.  Parts of xyz's data WILL BE OVERWRITTEN by libopenjpeg so xyz cannot be re-used
  *  after this call; see opj_j2k_encode where if l_reuse_data is false it will set l_tilec->data = l_img_comp->data.
  */
 extern ArrayData compress_j2k (std::shared_ptr<const OpenJPEGImage>, int bandwidth, int frames_per_second, bool threed, bool fourk, std::string comment = "libdcp");
 
+/** As above, but compressing a 16-bit XYZImage; xyz is not modified */
+extern ArrayData compress_j2k (XYZImage const& xyz, int bandwidth, int frames_per_second, bool threed, bool fourk, std::string comment = "libdcp");
+
 
 }
@@ -0,0 +1,320 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/kdm_decrypter.cc
+ *  @brief KDMDecrypter class
+ */
+
+
+#include "array_data.h"
+#include "encrypted_kdm.h"
+#include "exceptions.h"
+#include "filesystem.h"
+#include "kdm_decrypter.h"
+#include "parallel.h"
+#include "util.h"
+#include <asdcp/KM_util.h>
+#include <boost/algorithm/string.hpp>
+#include <openssl/rsa.h>
+#ifndef LIBDCP_WINDOWS
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cerrno>
+#include <sstream>
+
+
+using std::pair;
+using std::string;
+using std::vector;
+using boost::optional;
+using namespace dcp;
+
+
+/** @return digest of a string, in a form which can be used as a filename */
+static string
+filename_digest (string const& s)
+{
+	auto digest = make_digest(ArrayData(reinterpret_cast<uint8_t const*>(s.c_str()), s.length()));
+	boost::replace_all (digest, "/", "_");
+	boost::replace_all (digest, "+", "-");
+	boost::replace_all (digest, "=", "");
+	return digest;
+}
+
+
+/** @return digest of all the encrypted keys in a KDM */
+static string
+keys_digest (EncryptedKDM const& kdm)
+{
+	string all;
+	for (auto const& i: kdm.keys()) {
+		all += i;
+		all += "\n";
+	}
+	return make_digest(ArrayData(reinterpret_cast<uint8_t const*>(all.c_str()), all.length()));
+}
+
+
+KDMDecrypter::KDMDecrypter (string private_key)
+	: _rsa (DecryptedKDM::read_private_key(private_key))
+	, _fingerprint (private_key_fingerprint(private_key))
+{
+
+}
+
+
+KDMDecrypter::~KDMDecrypter ()
+{
+	RSA_free (_rsa);
+}
+
+
+void
+KDMDecrypter::enable_cache (optional<boost::filesystem::path> directory)
+{
+	std::lock_guard<std::mutex> lm (_cache_mutex);
+
+	_cache = true;
+	_cache_directory = boost::none;
+
+	if (!directory) {
+		return;
+	}
+
+	/* The cache files will contain decrypted content keys, so refuse to use a directory
+	 * that anybody else might be able to read.
+	 */
+	boost::system::error_code ec;
+	filesystem::create_directories (*directory, ec);
+	if (ec) {
+		throw FileError ("Could not create KDM cache directory", *directory, ec.value());
+	}
+
+	boost::filesystem::permissions (filesystem::fix_long_path(*directory), boost::filesystem::owner_all, ec);
+	if (ec) {
+		throw FileError ("Could not make KDM cache directory private", *directory, ec.value());
+	}
+
+#ifndef LIBDCP_WINDOWS
+	struct stat st;
+	if (stat(filesystem::fix_long_path(*directory).string().c_str(), &st) != 0) {
+		throw FileError ("Could not examine KDM cache directory", *directory, errno);
+	}
+	if (!S_ISDIR(st.st_mode) || st.st_uid != geteuid() || (st.st_mode & (S_IRWXG | S_IRWXO))) {
+		throw FileError ("KDM cache directory is not private to this user", *directory, 0);
+	}
+#endif
+
+	_cache_directory = directory;
+}
+
+
+/** Write a cache file which only its owner can read, replacing any existing one
+ *  atomically so that a reader never sees part of a file.
+ *  @return true on success.
+ */
+static bool
+write_private_file (string const& contents, boost::filesystem::path file)
+{
+	auto const temp = file.string() + ".tmp";
+
+#ifdef LIBDCP_WINDOWS
+	try {
+		write_string_to_file (contents, temp);
+	} catch (FileError &) {
+		return false;
+	}
+#else
+	auto fd = open (filesystem::fix_long_path(temp).string().c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		return false;
+	}
+
+	/* In case the temporary file already existed with other permissions */
+	bool ok = fchmod(fd, S_IRUSR | S_IWUSR) == 0;
+	size_t done = 0;
+	while (ok && done < contents.size()) {
+		auto const written = write(fd, contents.data() + done, contents.size() - done);
+		if (written < 0) {
+			ok = (errno == EINTR);
+		} else {
+			done += written;
+		}
+	}
+
+	if (close(fd) != 0 || !ok) {
+		boost::system::error_code ec;
+		filesystem::remove (temp, ec);
+		return false;
+	}
+#endif
+
+	boost::system::error_code ec;
+	filesystem::rename (temp, file, ec);
+	if (ec) {
+		filesystem::remove (temp, ec);
+		return false;
+	}
+
+	return true;
+}
+
+
+optional<KDMDecrypter::CacheEntry>
+KDMDecrypter::get_cached (string const& name)
+{
+	std::lock_guard<std::mutex> lm (_cache_mutex);
+
+	auto i = _cache_entries.find (name);
+	if (i != _cache_entries.end()) {
+		return i->second;
+	}
+
+	if (!_cache_directory) {
+		return {};
+	}
+
+	auto const file = *_cache_directory / name;
+	if (!filesystem::exists(file)) {
+		return {};
+	}
+
+	/* The first line is the digest of the encrypted keys, then there is one line of
+	 * base64-encoded decrypted key block per key.
+	 */
+	CacheEntry entry;
+	std::istringstream stream (file_to_string(file));
+	if (!std::getline(stream, entry.digest)) {
+		return {};
+	}
+
+	string line;
+	while (std::getline(stream, line)) {
+		vector<uint8_t> block (256);
+		int const length = base64_decode (line, block.data(), block.size());
+		if (length != 134 && length != 138) {
+			/* This doesn't look like a block from a KDM; ignore the whole file */
+			return {};
+		}
+		block.resize (length);
+		entry.decrypted_blocks.push_back (block);
+	}
+
+	_cache_entries[name] = entry;
+	return entry;
+}
+
+
+void
+KDMDecrypter::put_cached (string const& name, CacheEntry const& entry)
+{
+	std::lock_guard<std::mutex> lm (_cache_mutex);
+
+	_cache_entries[name] = entry;
+
+	if (!_cache_directory) {
+		return;
+	}
+
+	string contents = entry.digest + "\n";
+	for (auto const& block: entry.decrypted_blocks) {
+		char buffer[512];
+		contents += Kumu::base64encode (block.data(), block.size(), buffer, sizeof(buffer));
+		contents += "\n";
+	}
+
+	/* The cache is only an optimisation, so ignore any failure to write to it */
+	write_private_file (contents, *_cache_directory / name);
+}
+
+
+DecryptedKDM
+KDMDecrypter::decrypt (EncryptedKDM const& kdm)
+{
+	return decrypt(vector<EncryptedKDM>{kdm}).front();
+}
+
+
+vector<DecryptedKDM>
+KDMDecrypter::decrypt (vector<EncryptedKDM> const& kdms, int threads)
+{
+	vector<vector<vector<uint8_t>>> blocks (kdms.size());
+	vector<string> names (kdms.size());
+	vector<string> digests (kdms.size());
+	vector<bool> from_cache (kdms.size(), false);
+
+	/* Find what we can in the cache, and make a list of the keys (KDM index, key index)
+	 * which need to be decrypted.
+	 */
+	vector<pair<size_t, size_t>> jobs;
+	vector<vector<string>> ciphers (kdms.size());
+	for (size_t i = 0; i < kdms.size(); ++i) {
+		ciphers[i] = kdms[i].keys();
+		if (_cache) {
+			names[i] = filename_digest(kdms[i].id() + " " + _fingerprint);
+			digests[i] = keys_digest(kdms[i]);
+			auto cached = get_cached(names[i]);
+			if (cached && cached->digest == digests[i] && cached->decrypted_blocks.size() == ciphers[i].size()) {
+				blocks[i] = cached->decrypted_blocks;
+				from_cache[i] = true;
+				std::lock_guard<std::mutex> lm (_cache_mutex);
+				++_cache_hits;
+				continue;
+			}
+		}
+
+		blocks[i].resize (ciphers[i].size());
+		for (size_t j = 0; j < ciphers[i].size(); ++j) {
+			jobs.push_back ({i, j});
+		}
+	}
+
+	parallel_for (jobs.size(), threads, [&](int index) {
+		auto const& job = jobs[index];
+		blocks[job.first][job.second] = DecryptedKDM::decrypt_key_block(ciphers[job.first][job.second], _rsa);
+	});
+
+	vector<DecryptedKDM> decrypted;
+	for (size_t i = 0; i < kdms.size(); ++i) {
+		decrypted.push_back (DecryptedKDM(kdms[i], blocks[i]));
+		if (_cache && !from_cache[i]) {
+			put_cached (names[i], { digests[i], blocks[i] });
+		}
+	}
+
+	return decrypted;
+}
@@ -0,0 +1,124 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/kdm_decrypter.h
+ *  @brief KDMDecrypter class
+ */
+
+
+#ifndef LIBDCP_KDM_DECRYPTER_H
+#define LIBDCP_KDM_DECRYPTER_H
+
+
+#include "decrypted_kdm.h"
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace dcp {
+
+
+class EncryptedKDM;
+
+
+/** @class KDMDecrypter
+ *  @brief Decrypts any number of KDMs with one private key, optionally remembering the results.
+ *
+ *  The private key is parsed once, and the keys in a batch of KDMs are decrypted in parallel.
+ *  If the cache is enabled the decrypted keys are remembered by KDM ID and the fingerprint of the
+ *  private key, so that decrypting the same KDM again does not need any RSA operations.
+ */
+class KDMDecrypter
+{
+public:
+	/** @param private_key PEM-encoded RSA private key */
+	explicit KDMDecrypter (std::string private_key);
+	~KDMDecrypter ();
+
+	KDMDecrypter (KDMDecrypter const&) = delete;
+	KDMDecrypter& operator= (KDMDecrypter const&) = delete;
+
+	/** Remember decrypted keys in memory and, if directory is given, also in files there
+	 *  so that they persist between runs.  The cache files contain decrypted content keys,
+	 *  so the directory is made readable only by its owner and each file is readable only
+	 *  by its owner.  Throws FileError, leaving only the in-memory cache enabled, if the
+	 *  directory cannot be created or made private.
+	 */
+	void enable_cache (boost::optional<boost::filesystem::path> directory = boost::none);
+
+	DecryptedKDM decrypt (EncryptedKDM const& kdm);
+
+	/** @param kdms KDMs to decrypt.
+	 *  @param threads Number of threads to use, or 0 for one per CPU.
+	 *  @return Decrypted KDMs, in the same order as kdms.
+	 */
+	std::vector<DecryptedKDM> decrypt (std::vector<EncryptedKDM> const& kdms, int threads = 0);
+
+	/** @return Number of KDMs that have been decrypted using the cache */
+	int cache_hits () const {
+		std::lock_guard<std::mutex> lm (_cache_mutex);
+		return _cache_hits;
+	}
+
+private:
+	struct CacheEntry
+	{
+		/** Digest of the KDM's encrypted keys, to check that they have not changed */
+		std::string digest;
+		std::vector<std::vector<uint8_t>> decrypted_blocks;
+	};
+
+	boost::optional<CacheEntry> get_cached (std::string const& name);
+	void put_cached (std::string const& name, CacheEntry const& entry);
+
+	RSA* _rsa = nullptr;
+	std::string _fingerprint;
+
+	bool _cache = false;
+	boost::optional<boost::filesystem::path> _cache_directory;
+	mutable std::mutex _cache_mutex;
+	std::map<std::string, CacheEntry> _cache_entries;
+	int _cache_hits = 0;
+};
+
+
+}
+
+
+#endif
@@ -42,7 +42,11 @@
 #include "exceptions.h"
 #include "file.h"
 #include "language_tag.h"
+#include "language_tag_tables.h"
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <cctype>
+#include <mutex>
 #include <string>
 
 
@@ -56,27 +60,121 @@ using boost::optional;
 using namespace dcp;
 
 
-static vector<LanguageTag::SubtagData> language_list;
-static vector<LanguageTag::SubtagData> variant_list;
-static vector<LanguageTag::SubtagData> region_list;
-static vector<LanguageTag::SubtagData> script_list;
-static vector<LanguageTag::SubtagData> extlang_list;
+/** @class SubtagList
+ *  @brief A list of subtags, either one of our built-in tables or one read from a file.
+ */
+class SubtagList
+{
+public:
+	explicit SubtagList(language_tag_tables::Table const& table)
+		: _table(table)
+	{}
+
+	SubtagList(SubtagList const&) = delete;
+	SubtagList& operator=(SubtagList const&) = delete;
+
+	/** Replace our subtags with some which have been read from a file */
+	void set(vector<pair<string, string>> subtags)
+	{
+		std::lock_guard<std::mutex> lm(_mutex);
+
+		_loaded = subtags;
+		_loaded_entries.clear();
+		for (auto const& i: _loaded) {
+			_loaded_entries.push_back({i.first.c_str(), i.second.c_str()});
+		}
+		_loaded_by_subtag.resize(_loaded_entries.size());
+		for (size_t i = 0; i < _loaded_entries.size(); ++i) {
+			_loaded_by_subtag[i] = i;
+		}
+		std::stable_sort(_loaded_by_subtag.begin(), _loaded_by_subtag.end(), [this](int a, int b) {
+			return compare_subtags(_loaded_entries[a].subtag, _loaded_entries[b].subtag) < 0;
+		});
+		_table = { _loaded_entries.data(), _loaded_by_subtag.data(), static_cast<int>(_loaded_entries.size()) };
+		if (_all) {
+			/* Callers of all() may be holding references to _all, so refill it rather than replacing it */
+			fill_all();
+		}
+	}
 
-static vector<pair<string, string>> dcnc_list;
+	/** Find a subtag, ignoring case, using a binary search of the table's sorted indices */
+	optional<LanguageTag::SubtagData> find(string const& subtag) const
+	{
+		auto const begin = _table.by_subtag;
+		auto const end = _table.by_subtag + _table.size;
+		auto const entries = _table.entries;
+		auto i = std::lower_bound(begin, end, subtag, [entries](int index, string const& s) {
+			return compare_subtags(entries[index].subtag, s.c_str()) < 0;
+		});
+		if (i == end || compare_subtags(entries[*i].subtag, subtag.c_str()) != 0) {
+			return {};
+		}
+		return LanguageTag::SubtagData(entries[*i].subtag, entries[*i].description);
+	}
 
+	/** @return all our subtags in their original order; the list is made the first time it is asked for */
+	vector<LanguageTag::SubtagData> const& all() const
+	{
+		std::lock_guard<std::mutex> lm(_mutex);
+		if (!_all) {
+			_all = vector<LanguageTag::SubtagData>();
+			fill_all();
+		}
+		return *_all;
+	}
 
-static
-optional<LanguageTag::SubtagData>
-find_in_list (vector<LanguageTag::SubtagData> const& list, string subtag)
-{
-	for (auto const& i: list) {
-		if (boost::iequals(i.subtag, subtag)) {
-			return i;
+	vector<pair<string, string>> pairs() const
+	{
+		vector<pair<string, string>> p;
+		for (int i = 0; i < _table.size; ++i) {
+			p.push_back(make_pair(_table.entries[i].subtag, _table.entries[i].description));
 		}
+		return p;
 	}
 
-	return {};
-}
+private:
+	/** Compare two ASCII subtags without regard to case, returning <0, 0 or >0 like strcmp */
+	static int compare_subtags(char const* a, char const* b)
+	{
+		while (true) {
+			int const ca = std::tolower(static_cast<unsigned char>(*a));
+			int const cb = std::tolower(static_cast<unsigned char>(*b));
+			if (ca != cb || ca == 0) {
+				return ca - cb;
+			}
+			++a;
+			++b;
+		}
+	}
+
+	/** Make _all hold the subtags from _table; _mutex must be held and _all must exist */
+	void fill_all() const
+	{
+		_all->clear();
+		_all->reserve(_table.size);
+		for (int i = 0; i < _table.size; ++i) {
+			_all->push_back(LanguageTag::SubtagData(_table.entries[i].subtag, _table.entries[i].description));
+		}
+	}
+
+	mutable std::mutex _mutex;
+	language_tag_tables::Table _table;
+	/** Subtags that have been read from a file, and the entries and indices of _table which refer to them */
+	vector<pair<string, string>> _loaded;
+	vector<language_tag_tables::Entry> _loaded_entries;
+	vector<int> _loaded_by_subtag;
+	/** All our subtags, made when first asked for; once made this vector is only ever refilled, never replaced */
+	mutable optional<vector<LanguageTag::SubtagData>> _all;
+};
+
+
+static SubtagList language_list(language_tag_tables::language);
+static SubtagList variant_list(language_tag_tables::variant);
+static SubtagList region_list(language_tag_tables::region);
+static SubtagList script_list(language_tag_tables::script);
+static SubtagList extlang_list(language_tag_tables::extlang);
+
+static SubtagList dcnc_list(language_tag_tables::dcnc);
 
 
 LanguageTag::Subtag::Subtag (string subtag, SubtagType type)
@@ -298,18 +396,18 @@ LanguageTag::get_all (SubtagType type)
 {
 	switch (type) {
 	case SubtagType::LANGUAGE:
-		return language_list;
+		return language_list.all();
 	case SubtagType::SCRIPT:
-		return script_list;
+		return script_list.all();
 	case SubtagType::REGION:
-		return region_list;
+		return region_list.all();
 	case SubtagType::VARIANT:
-		return variant_list;
+		return variant_list.all();
 	case SubtagType::EXTLANG:
-		return extlang_list;
+		return extlang_list.all();
 	}
 
-	return language_list;
+	return language_list.all();
 }
 
 
@@ -396,15 +494,15 @@ LanguageTag::get_subtag_data (LanguageTag::SubtagType type, string subtag)
 {
 	switch (type) {
 	case SubtagType::LANGUAGE:
-		return find_in_list(language_list, subtag);
+		return language_list.find(subtag);
 	case SubtagType::SCRIPT:
-		return find_in_list(script_list, subtag);
+		return script_list.find(subtag);
 	case SubtagType::REGION:
-		return find_in_list(region_list, subtag);
+		return region_list.find(subtag);
 	case SubtagType::VARIANT:
-		return find_in_list(variant_list, subtag);
+		return variant_list.find(subtag);
 	case SubtagType::EXTLANG:
-		return find_in_list(extlang_list, subtag);
+		return extlang_list.find(subtag);
 	}
 
 	return {};
@@ -453,23 +551,25 @@ load_language_tag_list (boost::filesystem::path tags_directory, string name, std
 void
 dcp::load_language_tag_lists (boost::filesystem::path tags_directory)
 {
-	auto add_subtag = [](vector<LanguageTag::SubtagData>& list, string a, string b) {
-		list.push_back (LanguageTag::SubtagData(a, b));
+	auto load = [tags_directory](SubtagList& list, string name) {
+		vector<pair<string, string>> subtags;
+		load_language_tag_list(tags_directory, name, [&subtags](string a, string b) { subtags.push_back(make_pair(a, b)); });
+		list.set(subtags);
 	};
 
-	load_language_tag_list (tags_directory, "language", [&add_subtag](string a, string b) { add_subtag(language_list, a, b); });
-	load_language_tag_list (tags_directory, "variant",  [&add_subtag](string a, string b) { add_subtag(variant_list, a, b); });
-	load_language_tag_list (tags_directory, "region",   [&add_subtag](string a, string b) { add_subtag(region_list, a, b); });
-	load_language_tag_list (tags_directory, "script",   [&add_subtag](string a, string b) { add_subtag(script_list, a, b); });
-	load_language_tag_list (tags_directory, "extlang",  [&add_subtag](string a, string b) { add_subtag(extlang_list, a, b); });
+	load(language_list, "language");
+	load(variant_list, "variant");
+	load(region_list, "region");
+	load(script_list, "script");
+	load(extlang_list, "extlang");
 
-	load_language_tag_list (tags_directory, "dcnc", [](string a, string b) { dcnc_list.push_back(make_pair(a, b)); });
+	load(dcnc_list, "dcnc");
 }
 
 
 vector<pair<string, string>> dcp::dcnc_tags ()
 {
-	return dcnc_list;
+	return dcnc_list.pairs();
 }
 
 
@@ -0,0 +1,80 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/language_tag_tables.h
+ *  @brief Lists of language tag subtags, built in to the library.
+ *
+ *  The tables are written to language_tag_tables.cc by wscript, from the files in tags/.
+ */
+
+
+#ifndef LIBDCP_LANGUAGE_TAG_TABLES_H
+#define LIBDCP_LANGUAGE_TAG_TABLES_H
+
+
+namespace dcp {
+namespace language_tag_tables {
+
+
+struct Entry
+{
+	char const* subtag;
+	char const* description;
+};
+
+
+struct Table
+{
+	/** Entries in the order that they appear in the tags file */
+	Entry const* entries;
+	/** Indices into entries, sorted by case-insensitive subtag */
+	int const* by_subtag;
+	int size;
+};
+
+
+extern Table const language;
+extern Table const variant;
+extern Table const region;
+extern Table const script;
+extern Table const extlang;
+extern Table const dcnc;
+
+
+}
+}
+
+
+#endif
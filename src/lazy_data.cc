@@ -0,0 +1,157 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/lazy_data.cc
+ *  @brief LazyData class
+ */
+
+
+#include "lazy_data.h"
+#include "util.h"
+#include <map>
+#include <mutex>
+
+
+using std::function;
+using std::make_shared;
+using std::map;
+using std::mutex;
+using std::shared_ptr;
+using std::string;
+using std::weak_ptr;
+using namespace dcp;
+
+
+struct LazyData::State
+{
+	State(function<ArrayData ()> load_, bool share_)
+		: load(load_)
+		, share(share_)
+	{}
+
+	mutex load_mutex;
+	/** Function to fetch the data, or empty if it has been fetched */
+	function<ArrayData ()> load;
+	bool share;
+	shared_ptr<const ArrayData> data;
+};
+
+
+/** Data held by any LazyData made with share = true, indexed by digest; the entries expire when
+ *  nothing holds the data any more.
+ */
+static mutex shared_data_mutex;
+static map<string, weak_ptr<const ArrayData>> shared_data;
+
+
+static
+shared_ptr<const ArrayData>
+share_data(ArrayData data)
+{
+	auto const digest = make_digest(data);
+
+	std::lock_guard<mutex> lm(shared_data_mutex);
+
+	auto iter = shared_data.find(digest);
+	if (iter != shared_data.end()) {
+		if (auto existing = iter->second.lock()) {
+			if (*existing == data) {
+				return existing;
+			}
+		}
+	}
+
+	for (auto i = shared_data.begin(); i != shared_data.end(); ) {
+		if (i->second.expired()) {
+			i = shared_data.erase(i);
+		} else {
+			++i;
+		}
+	}
+
+	auto added = make_shared<const ArrayData>(data);
+	shared_data[digest] = added;
+	return added;
+}
+
+
+LazyData::LazyData()
+	: _state(make_shared<State>(function<ArrayData ()>(), false))
+{
+	_state->data = make_shared<const ArrayData>();
+}
+
+
+LazyData::LazyData(ArrayData data, bool share)
+	: _state(make_shared<State>(function<ArrayData ()>(), share))
+{
+	_state->data = share ? share_data(data) : make_shared<const ArrayData>(data);
+}
+
+
+LazyData::LazyData(function<ArrayData ()> load, bool share)
+	: _state(make_shared<State>(load, share))
+{
+
+}
+
+
+ArrayData
+LazyData::get() const
+{
+	std::lock_guard<mutex> lm(_state->load_mutex);
+	if (_state->load) {
+		auto data = _state->load();
+		_state->data = _state->share ? share_data(data) : make_shared<const ArrayData>(data);
+		_state->load = {};
+	}
+	return *_state->data;
+}
+
+
+bool
+LazyData::empty() const
+{
+	std::lock_guard<mutex> lm(_state->load_mutex);
+	return !_state->load && _state->data->size() == 0;
+}
+
+
+bool
+LazyData::loaded() const
+{
+	std::lock_guard<mutex> lm(_state->load_mutex);
+	return !_state->load;
+}
@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/lazy_data.h
+ *  @brief LazyData class
+ */
+
+
+#ifndef LIBDCP_LAZY_DATA_H
+#define LIBDCP_LAZY_DATA_H
+
+
+#include "array_data.h"
+#include <functional>
+#include <memory>
+
+
+namespace dcp {
+
+
+/** @class LazyData
+ *  @brief Some data which can be held as a way to fetch it, and then fetched the first time it is needed.
+ *
+ *  Copies of a LazyData share the same data, so it is fetched at most once however many copies there are.
+ */
+class LazyData
+{
+public:
+	/** Make an empty LazyData */
+	LazyData();
+
+	/** Make a LazyData holding some data that we already have.
+	 *  @param share true to share storage with any identical data which is held by another LazyData made with share = true.
+	 */
+	explicit LazyData(ArrayData data, bool share = false);
+
+	/** Make a LazyData which will call a function to get its data the first time it is needed.
+	 *  @param share true to share storage with any identical data which is held by another LazyData made with share = true.
+	 */
+	explicit LazyData(std::function<ArrayData ()> load, bool share = false);
+
+	/** @return our data, fetching it first if required */
+	ArrayData get() const;
+
+	/** @return true if there is no data, and no way to fetch any */
+	bool empty() const;
+
+	/** @return true if our data are in memory; false if they have yet to be fetched */
+	bool loaded() const;
+
+private:
+	struct State;
+	std::shared_ptr<State> _state;
+};
+
+
+}
+
+
+#endif
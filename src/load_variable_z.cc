@@ -63,8 +63,21 @@ LoadVariableZ::LoadVariableZ(xmlpp::Element const* xml_node)
 {
 	auto node = make_shared<cxml::Node>(xml_node);
 	_id = node->string_attribute("ID");
+	read_content(node->content());
+}
+
 
-	_original_content = node->content();
+LoadVariableZ::LoadVariableZ(string id, string const& content)
+	: _id(id)
+{
+	read_content(content);
+}
+
+
+void
+LoadVariableZ::read_content(string const& content)
+{
+	_original_content = content;
 	if (_original_content.empty()) {
 		_valid = false;
 		return;
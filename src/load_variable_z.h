@@ -61,6 +61,11 @@ public:
 
 	explicit LoadVariableZ(xmlpp::Element const* node);
 
+	/** @param id ID attribute of the <LoadVariableZ> node.
+	 *  @param content Content of the <LoadVariableZ> node.
+	 */
+	LoadVariableZ(std::string id, std::string const& content);
+
 	void as_xml(xmlpp::Element* element) const;
 
 	std::vector<Text::VariableZPosition> positions() const;
@@ -75,6 +80,7 @@ public:
 	}
 
 private:
+	void read_content(std::string const& content);
 	void throw_if_invalid() const;
 
 	std::string _id;
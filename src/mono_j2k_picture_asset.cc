@@ -37,6 +37,7 @@
  */
 
 
+#include "asset_equality.h"
 #include "compose.hpp"
 #include "dcp_assert.h"
 #include "equality_options.h"
@@ -48,19 +49,13 @@
 #include "mono_j2k_picture_frame.h"
 #include <asdcp/AS_DCP.h>
 #include <asdcp/KM_fileio.h>
-#include <boost/bind/bind.hpp>
+#include <algorithm>
+#include <cstring>
 
 
 using std::dynamic_pointer_cast;
-using std::list;
-using std::make_shared;
-using std::pair;
 using std::shared_ptr;
 using std::string;
-using std::vector;
-#if BOOST_VERSION >= 106100
-using namespace boost::placeholders;
-#endif
 using namespace dcp;
 
 
@@ -97,13 +92,6 @@ MonoJ2KPictureAsset::MonoJ2KPictureAsset (Fraction edit_rate, Standard standard)
 }
 
 
-static void
-storing_note_handler (list<pair<NoteType, string>>& notes, NoteType t, string s)
-{
-	notes.push_back (make_pair (t, s));
-}
-
-
 bool
 MonoJ2KPictureAsset::equals(shared_ptr<const Asset> other, EqualityOptions const& opt, NoteHandler note) const
 {
@@ -111,16 +99,21 @@ MonoJ2KPictureAsset::equals(shared_ptr<const Asset> other, EqualityOptions const
 		return false;
 	}
 
+	DCP_ASSERT (_file);
+	DCP_ASSERT (other->file ());
+
+	if (asset_files_identical(*this, *other, opt, note)) {
+		return true;
+	}
+
 	Kumu::FileReaderFactory factory;
 	ASDCP::JP2K::MXFReader reader_A(factory);
-	DCP_ASSERT (_file);
 	auto r = reader_A.OpenRead(dcp::filesystem::fix_long_path(*_file).string().c_str());
 	if (ASDCP_FAILURE(r)) {
 		boost::throw_exception (MXFFileError("could not open MXF file for reading", _file->string(), r));
 	}
 
 	ASDCP::JP2K::MXFReader reader_B(factory);
-	DCP_ASSERT (other->file ());
 	r = reader_B.OpenRead(dcp::filesystem::fix_long_path(*other->file()).string().c_str());
 	if (ASDCP_FAILURE (r)) {
 		boost::throw_exception (MXFFileError ("could not open MXF file for reading", other->file()->string(), r));
@@ -142,45 +135,39 @@ MonoJ2KPictureAsset::equals(shared_ptr<const Asset> other, EqualityOptions const
 	auto other_picture = dynamic_pointer_cast<const MonoJ2KPictureAsset> (other);
 	DCP_ASSERT (other_picture);
 
-	bool result = true;
-
-	auto reader = start_read ();
-	auto other_reader = other_picture->start_read ();
+	bool result = _intrinsic_duration <= other_picture->intrinsic_duration();
 
-#ifdef LIBDCP_OPENMP
-#pragma omp parallel for
-#endif
+	/* If both assets are encrypted with the same key, frames whose encrypted data are the same need not be decrypted */
+	auto const compare_encrypted = same_key_id(*this, *other_picture);
 
-	for (int i = 0; i < _intrinsic_duration; ++i) {
-		if (i >= other_picture->intrinsic_duration()) {
-			result = false;
+	auto const frames = std::min(_intrinsic_duration, other_picture->intrinsic_duration());
+	if ((result || opt.keep_going) && !frames_equal(frames, "video", opt, note, [this, other_picture, compare_encrypted, &opt]() {
+		auto reader = start_read();
+		auto other_reader = other_picture->start_read();
+		shared_ptr<MonoJ2KPictureAssetReader> encrypted_reader;
+		shared_ptr<MonoJ2KPictureAssetReader> other_encrypted_reader;
+		if (compare_encrypted) {
+			/* Can't use make_shared here as the MonoJ2KPictureAssetReader constructor is private */
+			encrypted_reader.reset(new MonoJ2KPictureAssetReader(this, boost::none, standard()));
+			other_encrypted_reader.reset(new MonoJ2KPictureAssetReader(other_picture.get(), boost::none, other_picture->standard()));
 		}
 
-		if (result || opt.keep_going) {
-
-			auto frame_A = reader->get_frame (i);
-			auto frame_B = other_reader->get_frame (i);
-
-			list<pair<NoteType, string>> notes;
-
-			if (!frame_buffer_equals (
-				    i, opt, bind (&storing_note_handler, boost::ref(notes), _1, _2),
-				    frame_A->data(), frame_A->size(),
-				    frame_B->data(), frame_B->size()
-				    )) {
-				result = false;
-			}
-
-#ifdef LIBDCP_OPENMP
-#pragma omp critical
-#endif
-			{
-				note (NoteType::PROGRESS, String::compose("Compared video frame %1 of %2", i, _intrinsic_duration));
-				for (auto const& i: notes) {
-					note (i.first, i.second);
+		return [this, reader, other_reader, encrypted_reader, other_encrypted_reader, &opt](int i, NoteHandler frame_note) {
+			if (encrypted_reader) {
+				auto frame_A = encrypted_reader->get_frame(i);
+				auto frame_B = other_encrypted_reader->get_frame(i);
+				if (frame_A->size() == frame_B->size() && memcmp(frame_A->data(), frame_B->data(), frame_A->size()) == 0) {
+					frame_note(NoteType::NOTE, "Encrypted J2K identical");
+					return true;
 				}
 			}
-		}
+
+			auto frame_A = reader->get_frame(i);
+			auto frame_B = other_reader->get_frame(i);
+			return frame_buffer_equals(i, opt, frame_note, frame_A->data(), frame_A->size(), frame_B->data(), frame_B->size());
+		};
+	})) {
+		result = false;
 	}
 
 	return result;
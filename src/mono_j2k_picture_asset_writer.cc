@@ -40,6 +40,8 @@
 #include "crypto_context.h"
 #include "dcp_assert.h"
 #include "exceptions.h"
+#include "filesystem.h"
+#include "mono_j2k_picture_asset.h"
 #include "mono_j2k_picture_asset_writer.h"
 #include "j2k_picture_asset.h"
 #include "warnings.h"
@@ -60,6 +62,8 @@ using namespace dcp;
 struct MonoJ2KPictureAssetWriter::ASDCPState : public ASDCPJ2KStateBase
 {
 	ASDCP::JP2K::MXFWriter mxf_writer;
+	/** Buffer which points at the caller's data for write_pass_through() */
+	ASDCP::JP2K::FrameBuffer pass_through_buffer;
 };
 
 
@@ -88,11 +92,36 @@ MonoJ2KPictureAssetWriter::~MonoJ2KPictureAssetWriter()
 void
 MonoJ2KPictureAssetWriter::start (uint8_t const * data, int size)
 {
-	dcp::start (this, _state, _picture_asset, data, size);
+	if (_descriptor_copied) {
+		dcp::start_with_descriptor (this, _state, _picture_asset);
+	} else {
+		dcp::start (this, _state, _picture_asset, data, size);
+	}
 	_picture_asset->set_frame_rate (_picture_asset->edit_rate());
 }
 
 
+void
+MonoJ2KPictureAssetWriter::copy_descriptor_from(MonoJ2KPictureAsset const& source)
+{
+	DCP_ASSERT (!_started);
+	DCP_ASSERT (source.file());
+
+	Kumu::FileReaderFactory factory;
+	ASDCP::JP2K::MXFReader reader(factory);
+	auto r = reader.OpenRead(dcp::filesystem::fix_long_path(*source.file()).string().c_str());
+	if (ASDCP_FAILURE(r)) {
+		boost::throw_exception (MXFFileError("could not open MXF file for reading", source.file()->string(), r));
+	}
+
+	if (ASDCP_FAILURE(reader.FillPictureDescriptor(_state->picture_descriptor))) {
+		boost::throw_exception (ReadError("could not read video MXF information"));
+	}
+
+	_descriptor_copied = true;
+}
+
+
 J2KFrameInfo
 MonoJ2KPictureAssetWriter::write (uint8_t const * data, int size)
 {
@@ -108,10 +137,40 @@ MonoJ2KPictureAssetWriter::write (uint8_t const * data, int size)
 
 	_state->frame_buffer.PlaintextOffset(0);
 
+	return write_frame_buffer(false);
+}
+
+
+J2KFrameInfo
+MonoJ2KPictureAssetWriter::write_pass_through(uint8_t const* data, int size)
+{
+	DCP_ASSERT (!_finalized);
+	DCP_ASSERT (_descriptor_copied);
+
+	if (!_started) {
+		start (data, size);
+	}
+
+	/* The buffer only points at data, which asdcplib reads but does not modify */
+	auto& buffer = _state->pass_through_buffer;
+	buffer.SetData(const_cast<uint8_t*>(data), size);
+	buffer.Size(size);
+	buffer.PlaintextOffset(0);
+
+	return write_frame_buffer(true);
+}
+
+
+/** Write the frame which write() or write_pass_through() has put into one of our buffers */
+J2KFrameInfo
+MonoJ2KPictureAssetWriter::write_frame_buffer(bool pass_through)
+{
+	auto const& buffer = pass_through ? _state->pass_through_buffer : _state->frame_buffer;
+
 	uint64_t const before_offset = _state->mxf_writer.Tell ();
 
 	string hash;
-	auto const r = _state->mxf_writer.WriteFrame (_state->frame_buffer, _crypto_context->context(), _crypto_context->hmac(), &hash);
+	auto const r = _state->mxf_writer.WriteFrame (buffer, _crypto_context->context(), _crypto_context->hmac(), &hash);
 	if (ASDCP_FAILURE(r)) {
 		throw_from_asdcplib(r, _file, MXFFileError("error in writing video MXF", _file.string(), r));
 	}
@@ -51,6 +51,9 @@
 namespace dcp {
 
 
+class MonoJ2KPictureAsset;
+
+
 /** @class MonoJ2KPictureAssetWriter
  *  @brief A helper class for writing to MonoJ2KPictureAssets
  *
@@ -70,12 +73,28 @@ public:
 	void fake_write(J2KFrameInfo const& info) override;
 	bool finalize () override;
 
+	/** Take the picture descriptor for the new MXF from an existing one, rather than
+	 *  by parsing the first frame that is written.  This must be called before any
+	 *  frames are written, and must be called before write_pass_through() is used.
+	 *  @param source Existing MXF whose frames are going to be re-wrapped.
+	 */
+	void copy_descriptor_from(MonoJ2KPictureAsset const& source);
+
+	/** Write a frame which has been taken verbatim (and decrypted, if required) from
+	 *  the MXF given to copy_descriptor_from().  The codestream is assumed to be valid
+	 *  and is not parsed; it will be encrypted if the asset has a key.
+	 */
+	J2KFrameInfo write_pass_through(uint8_t const* data, int size);
+
 private:
 	friend class MonoJ2KPictureAsset;
 
 	MonoJ2KPictureAssetWriter (J2KPictureAsset* a, boost::filesystem::path file, bool);
 
 	void start (uint8_t const *, int);
+	J2KFrameInfo write_frame_buffer(bool pass_through);
+
+	bool _descriptor_copied = false;
 
 	/* do this with an opaque pointer so we don't have to include
 	   ASDCP headers
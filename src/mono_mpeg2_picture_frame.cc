@@ -37,6 +37,7 @@
 
 
 using std::make_shared;
+using std::min;
 using std::shared_ptr;
 using namespace dcp;
 
@@ -44,9 +45,10 @@ using namespace dcp;
 
 MonoMPEG2PictureFrame::MonoMPEG2PictureFrame(uint8_t const* data, int size)
 {
-	_buffer = make_shared<ASDCP::MPEG2::FrameBuffer>(size);
+	_buffer = make_shared<ASDCP::MPEG2::FrameBuffer>(size + padding_size);
 	memcpy(_buffer->Data(), data, size);
 	_buffer->Size(size);
+	zero_padding();
 }
 
 
@@ -59,13 +61,24 @@ MonoMPEG2PictureFrame::MonoMPEG2PictureFrame(uint8_t const* data, int size)
 MonoMPEG2PictureFrame::MonoMPEG2PictureFrame(ASDCP::MPEG2::MXFReader* reader, int n, shared_ptr<DecryptionContext> context, bool check_hmac)
 {
 	/* XXX: unfortunate guesswork on this buffer size */
-	_buffer = make_shared<ASDCP::MPEG2::FrameBuffer>(4 * Kumu::Megabyte);
+	_buffer = make_shared<ASDCP::MPEG2::FrameBuffer>(4 * Kumu::Megabyte + padding_size);
 
 	auto const r = reader->ReadFrame(n, *_buffer, context->context(), check_hmac ? context->hmac() : nullptr);
 
 	if (ASDCP_FAILURE(r)) {
 		boost::throw_exception(ReadError(String::compose("could not read video frame %1 (%2)", n, static_cast<int>(r))));
 	}
+
+	zero_padding();
+}
+
+
+/** Zero as much of the padding after our data as we have space for, and remember how much that was */
+void
+MonoMPEG2PictureFrame::zero_padding()
+{
+	_padding = min(static_cast<int>(_buffer->Capacity() - _buffer->Size()), padding_size);
+	memset(_buffer->Data() + _buffer->Size(), 0, _padding);
 }
 
 
@@ -89,3 +102,10 @@ MonoMPEG2PictureFrame::size() const
 	return _buffer->Size();
 }
 
+
+int
+MonoMPEG2PictureFrame::padding() const
+{
+	return _padding;
+}
+
@@ -62,6 +62,14 @@ public:
 	/** @return Size of MPEG2 data in bytes */
 	int size() const override;
 
+	/** @return Number of zeroed bytes which are guaranteed to follow the end of the data in memory */
+	int padding() const;
+
+	/** Number of bytes of padding that we try to leave after the data; this is enough for
+	 *  FFmpeg (AV_INPUT_BUFFER_PADDING_SIZE) so that frames can be decoded without copying them.
+	 */
+	static constexpr int padding_size = 64;
+
 private:
 	/* XXX: this is a bit of a shame, but I tried friend MonoMPEG2PictureAssetReader and it's
 	   rejected by some (seemingly older) GCCs.
@@ -70,8 +78,11 @@ private:
 
 	MonoMPEG2PictureFrame(ASDCP::MPEG2::MXFReader* reader, int n, std::shared_ptr<DecryptionContext>, bool check_hmac);
 
+	void zero_padding();
+
 	/* XXX why is this a shared_ptr? */
 	std::shared_ptr<ASDCP::MPEG2::FrameBuffer> _buffer;
+	int _padding = 0;
 };
 
 
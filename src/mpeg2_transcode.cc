@@ -56,7 +56,7 @@ MPEG2Codec::~MPEG2Codec()
 
 
 
-MPEG2Decompressor::MPEG2Decompressor()
+MPEG2Decompressor::MPEG2Decompressor(int threads, bool frame_threading)
 {
 	_codec = avcodec_find_decoder_by_name("mpeg2video");
 	if (!_codec) {
@@ -68,6 +68,12 @@ MPEG2Decompressor::MPEG2Decompressor()
 		throw MPEG2CodecError("could not allocate codec context");
 	}
 
+	_context->thread_count = threads;
+	_context->thread_type = FF_THREAD_SLICE;
+	if (frame_threading) {
+		_context->thread_type |= FF_THREAD_FRAME;
+	}
+
 	int const r = avcodec_open2(_context, _codec, nullptr);
 	if (r < 0) {
 		avcodec_free_context(&_context);
@@ -87,25 +93,48 @@ MPEG2Decompressor::~MPEG2Decompressor()
 }
 
 
+static void
+release_frame(void* opaque, uint8_t*)
+{
+	delete reinterpret_cast<shared_ptr<const MonoMPEG2PictureFrame>*>(opaque);
+}
+
+
 vector<FFmpegImage>
 MPEG2Decompressor::decompress_frame(shared_ptr<const MonoMPEG2PictureFrame> frame)
 {
-	/* XXX: can we avoid this? */
-	auto copy = av_malloc(frame->size() + AV_INPUT_BUFFER_PADDING_SIZE);
-	if (!copy) {
-		throw std::bad_alloc();
-	}
-	memcpy(copy, frame->data(), frame->size());
-
 	AVPacket packet;
 	av_init_packet(&packet);
-	av_packet_from_data(&packet, reinterpret_cast<uint8_t*>(copy), frame->size());
 
-	auto images = decompress_packet(&packet);
+	if (frame->padding() >= AV_INPUT_BUFFER_PADDING_SIZE) {
+		/* The frame's buffer is already padded the way FFmpeg wants, so we can hand it over
+		 * as-is; the AVBufferRef keeps the frame alive for as long as the decoder needs it.
+		 */
+		auto holder = new shared_ptr<const MonoMPEG2PictureFrame>(frame);
+		packet.buf = av_buffer_create(
+			const_cast<uint8_t*>(frame->data()), frame->size() + AV_INPUT_BUFFER_PADDING_SIZE, release_frame, holder, AV_BUFFER_FLAG_READONLY
+			);
+		if (!packet.buf) {
+			delete holder;
+			throw std::bad_alloc();
+		}
+		packet.data = packet.buf->data;
+		packet.size = frame->size();
+	} else {
+		auto copy = av_malloc(frame->size() + AV_INPUT_BUFFER_PADDING_SIZE);
+		if (!copy) {
+			throw std::bad_alloc();
+		}
+		memcpy(copy, frame->data(), frame->size());
+		memset(reinterpret_cast<uint8_t*>(copy) + frame->size(), 0, AV_INPUT_BUFFER_PADDING_SIZE);
+		av_packet_from_data(&packet, reinterpret_cast<uint8_t*>(copy), frame->size());
+	}
 
-	av_packet_unref(&packet);
+	ScopeGuard sg = [&packet]() {
+		av_packet_unref(&packet);
+	};
 
-	return images;
+	return decompress_packet(&packet);
 }
 
 
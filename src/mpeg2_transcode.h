@@ -70,7 +70,12 @@ protected:
 class MPEG2Decompressor : public MPEG2Codec
 {
 public:
-	MPEG2Decompressor();
+	/** @param threads Number of threads to decode with, or 0 to let FFmpeg decide.
+	 *  @param frame_threading true to allow frame threading as well as slice threading.  This gives
+	 *  better throughput, but each decoding thread adds a frame of delay before images come out
+	 *  of decompress_frame(), so flush() must be called to get the last ones.
+	 */
+	explicit MPEG2Decompressor(int threads = 0, bool frame_threading = false);
 	~MPEG2Decompressor();
 
 	std::vector<FFmpegImage> decompress_frame(std::shared_ptr<const MonoMPEG2PictureFrame> frame);
@@ -140,6 +140,8 @@ protected:
 	template <class P, class Q>
 	friend void start (J2KPictureAssetWriter* writer, std::shared_ptr<P> state, Q* mxf, uint8_t const * data, int size);
 	template <class P, class Q>
+	friend void start_with_descriptor (J2KPictureAssetWriter* writer, std::shared_ptr<P> state, Q* mxf);
+	template <class P, class Q>
 	friend void start (MPEG2PictureAssetWriter* writer, std::shared_ptr<P> state, Q* mxf, uint8_t const * data, int size);
 
 	MXF ();
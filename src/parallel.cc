@@ -0,0 +1,108 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/parallel.cc
+ *  @brief parallel_for function
+ */
+
+
+#include "parallel.h"
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+using std::min;
+using std::vector;
+
+
+/** true in the worker threads of a parallel_for() */
+static thread_local bool in_parallel_for = false;
+
+
+void
+dcp::parallel_for(int count, int threads, std::function<void (int)> job)
+{
+	if (threads <= 0) {
+		threads = in_parallel_for ? 1 : std::max(1U, std::thread::hardware_concurrency());
+	}
+	threads = min(threads, count);
+
+	if (threads <= 1) {
+		for (int i = 0; i < count; ++i) {
+			job(i);
+		}
+		return;
+	}
+
+	std::atomic<int> next(0);
+	std::atomic<bool> failed(false);
+	std::exception_ptr error;
+	std::mutex error_mutex;
+
+	auto worker = [&]() {
+		in_parallel_for = true;
+		while (!failed) {
+			int const i = next++;
+			if (i >= count) {
+				break;
+			}
+			try {
+				job(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lm(error_mutex);
+				if (!error) {
+					error = std::current_exception();
+				}
+				failed = true;
+			}
+		}
+	};
+
+	vector<std::thread> pool;
+	for (int i = 0; i < threads; ++i) {
+		pool.push_back(std::thread(worker));
+	}
+
+	for (auto& i: pool) {
+		i.join();
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
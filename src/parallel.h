@@ -0,0 +1,70 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/parallel.h
+ *  @brief parallel_for function
+ */
+
+
+#ifndef LIBDCP_PARALLEL_H
+#define LIBDCP_PARALLEL_H
+
+
+#include <functional>
+
+
+namespace dcp {
+
+
+/** Call job(0), job(1) ... job(count - 1) using a pool of threads, returning when they have all finished.
+ *  Jobs are started in order but may finish in any order, so job should write its result somewhere
+ *  indexed by its parameter if the results must come out in a predictable order.
+ *
+ *  If any job throws an exception no more jobs will be started, and once the running ones have
+ *  finished the first exception will be re-thrown from this function.
+ *
+ *  @param count Number of jobs.
+ *  @param threads Maximum number of threads to use, or 0 to use one per CPU.  If this is 0 and we are
+ *  called from a job of another parallel_for() the jobs are run one after another in the calling thread,
+ *  since the outer parallel_for() is already keeping the CPUs busy.
+ *  @param job Function to run for each job.
+ */
+extern void parallel_for(int count, int threads, std::function<void (int)> job);
+
+
+}
+
+
+#endif
@@ -432,6 +432,13 @@ Reel::file_assets() const
 
 void
 Reel::resolve_refs (vector<shared_ptr<Asset>> assets)
+{
+	resolve_refs(AssetIndex(assets));
+}
+
+
+void
+Reel::resolve_refs (AssetIndex const& assets)
 {
 	if (_main_picture) {
 		_main_picture->asset_ref().resolve(assets);
@@ -442,10 +449,12 @@ Reel::resolve_refs (vector<shared_ptr<Asset>> assets)
 	}
 
 	auto resolve_interop_fonts = [&assets](shared_ptr<ReelTextAsset>(asset)) {
-		/* Interop subtitle handling is all special cases */
-		if (asset->asset_ref().resolved()) {
+		/* Interop subtitle handling is all special cases.  Check the reel asset's type before
+		 * fetching the asset so that we don't force an AssetProxy to load an MXF.
+		 */
+		if (dynamic_pointer_cast<ReelInteropTextAsset>(asset) && asset->asset_ref().resolved()) {
 			if (auto iop = dynamic_pointer_cast<InteropTextAsset>(asset->asset_ref().asset())) {
-				iop->resolve_fonts(assets);
+				iop->resolve_fonts(assets.fonts());
 			}
 		}
 
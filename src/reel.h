@@ -151,6 +151,7 @@ public:
 	void add (DecryptedKDM const &);
 
 	void resolve_refs (std::vector<std::shared_ptr<Asset>>);
+	void resolve_refs (AssetIndex const& assets);
 
 	PictureEncoding picture_encoding() const;
 
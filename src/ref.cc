@@ -37,6 +37,7 @@
  */
 
 
+#include "asset_proxy.h"
 #include "ref.h"
 
 
@@ -57,3 +58,27 @@ Ref::resolve (vector<shared_ptr<Asset>> assets)
 		_asset = *i;
 	}
 }
+
+
+void
+Ref::resolve (AssetIndex const& assets)
+{
+	if (auto asset = assets.find(_id)) {
+		_asset = asset;
+	}
+}
+
+
+shared_ptr<Asset>
+Ref::asset () const
+{
+	if (!_asset) {
+		throw UnresolvedRefError (_id);
+	}
+
+	if (auto proxy = dynamic_cast<AssetProxy const*>(_asset.get())) {
+		return proxy->load();
+	}
+
+	return _asset;
+}
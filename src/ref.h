@@ -43,6 +43,7 @@
 
 #include "exceptions.h"
 #include "asset.h"
+#include "asset_index.h"
 #include "util.h"
 #include <memory>
 #include <string>
@@ -87,31 +88,25 @@ public:
 	 */
 	void resolve (std::vector<std::shared_ptr<Asset>> assets);
 
+	/** Copy a shared_ptr to any asset in an index which matches the ID of this one */
+	void resolve (AssetIndex const& assets);
+
 	/** @return the ID of the thing that we are pointing to */
 	std::string id () const {
 		return _id;
 	}
 
 	/** @return a shared_ptr to the thing; an UnresolvedRefError is thrown
-	 *  if the shared_ptr is not known
+	 *  if the shared_ptr is not known.  If the thing is an AssetProxy the
+	 *  real asset is loaded (if necessary) and returned.
 	 */
-	std::shared_ptr<Asset> asset () const {
-		if (!_asset) {
-			throw UnresolvedRefError (_id);
-		}
-
-		return _asset;
-	}
+	std::shared_ptr<Asset> asset () const;
 
 	/** operator-> to access the shared_ptr; an UnresolvedRefError is thrown
 	 *  if the shared_ptr is not known
 	 */
 	Asset * operator->() const {
-		if (!_asset) {
-			throw UnresolvedRefError (_id);
-		}
-
-		return _asset.get ();
+		return asset().get();
 	}
 
 	/** @return true if a shared_ptr is known for this Ref */
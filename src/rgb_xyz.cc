@@ -44,6 +44,7 @@
 #include "piecewise_lut.h"
 #include "rgb_xyz.h"
 #include "transfer_function.h"
+#include "xyz_image.h"
 #include <cmath>
 
 
@@ -59,9 +60,13 @@ using namespace dcp;
 static auto constexpr DCI_COEFFICIENT = 48.0 / 52.37;
 
 
+template <class T>
 void
-dcp::xyz_to_rgba (
-	std::shared_ptr<const OpenJPEGImage> xyz_image,
+xyz_to_rgba_internal(
+	T const* xyz_x,
+	T const* xyz_y,
+	T const* xyz_z,
+	dcp::Size size,
 	ColourConversion const & conversion,
 	uint8_t* argb,
 	int stride
@@ -77,10 +82,6 @@ dcp::xyz_to_rgba (
 		double r, g, b;
 	} d;
 
-	int* xyz_x = xyz_image->data (0);
-	int* xyz_y = xyz_image->data (1);
-	int* xyz_z = xyz_image->data (2);
-
 	auto lut_in = conversion.out()->double_lut(0, 1, 12, false);
 	auto lut_out = conversion.in()->double_lut(0, 1, 16, true);
 	boost::numeric::ublas::matrix<double> const matrix = conversion.xyz_to_rgb ();
@@ -91,8 +92,8 @@ dcp::xyz_to_rgba (
 		matrix (2, 0), matrix (2, 1), matrix (2, 2)
 	};
 
-	int const height = xyz_image->size().height;
-	int const width = xyz_image->size().width;
+	int const height = size.height;
+	int const width = size.width;
 
 	for (int y = 0; y < height; ++y) {
 		uint8_t* argb_line = argb;
@@ -137,8 +138,36 @@ dcp::xyz_to_rgba (
 
 
 void
-dcp::xyz_to_rgb (
-	shared_ptr<const OpenJPEGImage> xyz_image,
+dcp::xyz_to_rgba (
+	std::shared_ptr<const OpenJPEGImage> xyz_image,
+	ColourConversion const & conversion,
+	uint8_t* argb,
+	int stride
+	)
+{
+	xyz_to_rgba_internal(xyz_image->data(0), xyz_image->data(1), xyz_image->data(2), xyz_image->size(), conversion, argb, stride);
+}
+
+
+void
+dcp::xyz_to_rgba (
+	XYZImage const& xyz_image,
+	ColourConversion const & conversion,
+	uint8_t* argb,
+	int stride
+	)
+{
+	xyz_to_rgba_internal(xyz_image.data(0), xyz_image.data(1), xyz_image.data(2), xyz_image.size(), conversion, argb, stride);
+}
+
+
+template <class T>
+void
+xyz_to_rgb_internal(
+	T const* xyz_x,
+	T const* xyz_y,
+	T const* xyz_z,
+	dcp::Size size,
 	ColourConversion const & conversion,
 	uint8_t* rgb,
 	int stride,
@@ -153,10 +182,7 @@ dcp::xyz_to_rgb (
 		double r, g, b;
 	} d;
 
-	/* These should be 12-bit values from 0-4095 */
-	int* xyz_x = xyz_image->data (0);
-	int* xyz_y = xyz_image->data (1);
-	int* xyz_z = xyz_image->data (2);
+	/* xyz_x, xyz_y and xyz_z should be 12-bit values from 0-4095 */
 
 	auto lut_in = conversion.out()->double_lut(0, 1, 12, false);
 	auto lut_out = conversion.in()->double_lut(0, 1, 16, true);
@@ -168,8 +194,8 @@ dcp::xyz_to_rgb (
 		matrix (2, 0), matrix (2, 1), matrix (2, 2)
 	};
 
-	int const height = xyz_image->size().height;
-	int const width = xyz_image->size().width;
+	int const height = size.height;
+	int const width = size.width;
 
 	for (int y = 0; y < height; ++y) {
 		auto rgb_line = reinterpret_cast<uint16_t*> (rgb + y * stride);
@@ -231,6 +257,32 @@ dcp::xyz_to_rgb (
 	}
 }
 
+
+void
+dcp::xyz_to_rgb (
+	shared_ptr<const OpenJPEGImage> xyz_image,
+	ColourConversion const & conversion,
+	uint8_t* rgb,
+	int stride,
+	optional<NoteHandler> note
+	)
+{
+	xyz_to_rgb_internal(xyz_image->data(0), xyz_image->data(1), xyz_image->data(2), xyz_image->size(), conversion, rgb, stride, note);
+}
+
+
+void
+dcp::xyz_to_rgb (
+	XYZImage const& xyz_image,
+	ColourConversion const & conversion,
+	uint8_t* rgb,
+	int stride,
+	optional<NoteHandler> note
+	)
+{
+	xyz_to_rgb_internal(xyz_image.data(0), xyz_image.data(1), xyz_image.data(2), xyz_image.size(), conversion, rgb, stride, note);
+}
+
 void
 dcp::combined_rgb_to_xyz (ColourConversion const & conversion, double* matrix)
 {
@@ -355,3 +407,19 @@ dcp::rgb_to_xyz (
 {
 	rgb_to_xyz_internal(rgb, dst, dst, dst, size, stride, conversion);
 }
+
+
+void
+dcp::rgb_to_xyz (
+	uint8_t const * rgb,
+	XYZImage& xyz,
+	int stride,
+	ColourConversion const & conversion
+	)
+{
+	auto xyz_x = xyz.data(0);
+	auto xyz_y = xyz.data(1);
+	auto xyz_z = xyz.data(2);
+
+	rgb_to_xyz_internal(rgb, xyz_x, xyz_y, xyz_z, xyz.size(), stride, conversion);
+}
@@ -48,6 +48,7 @@ namespace dcp {
 
 class OpenJPEGImage;
 class Image;
+class XYZImage;
 class ColourConversion;
 
 
@@ -74,6 +75,15 @@ extern void xyz_to_rgba (
 	);
 
 
+/** As above, but taking the XYZ image as a 16-bit XYZImage */
+extern void xyz_to_rgba (
+	XYZImage const& xyz_image,
+	ColourConversion const & conversion,
+	uint8_t* rgba,
+	int stride
+	);
+
+
 /** Convert an XYZ image to 48bpp RGB.
  *  @param xyz_image Frame in XYZ.
  *  @param conversion Colour conversion to use.
@@ -92,6 +102,16 @@ extern void xyz_to_rgb (
 	);
 
 
+/** As above, but taking the XYZ image as a 16-bit XYZImage */
+extern void xyz_to_rgb (
+	XYZImage const& xyz_image,
+	ColourConversion const & conversion,
+	uint8_t* rgb,
+	int stride,
+	boost::optional<NoteHandler> note = boost::optional<NoteHandler> ()
+	);
+
+
 extern PiecewiseLUT2 make_inverse_gamma_lut(std::shared_ptr<const TransferFunction> fn);
 
 /** @param rgb RGB data; packed RGB 16:16:16, 48bpp, 16R, 16G, 16B,
@@ -123,6 +143,19 @@ extern std::shared_ptr<OpenJPEGImage> rgb_to_xyz (
 	ColourConversion const& conversion
 	);
 
+/** @param rgb RGB data; packed RGB 16:16:16, 48bpp, 16R, 16G, 16B,
+ *  with the 2-byte value for each R/G/B component stored as
+ *  little-endian; i.e. AV_PIX_FMT_RGB48LE.
+ *  @param xyz Image to write XYZ to; the RGB data must be the same size as this image.
+ *  @param size stride of RGB data in pixels.
+ */
+extern void rgb_to_xyz (
+	uint8_t const * rgb,
+	XYZImage& xyz,
+	int stride,
+	ColourConversion const& conversion
+	);
+
 
 /** @param conversion Colour conversion.
  *  @param matrix Filled in with the product of the RGB to XYZ matrix, the Bradford transform and the DCI companding.
@@ -32,11 +32,14 @@
 */
 
 
+#include "asset_index.h"
 #include "dcp.h"
 #include "decrypted_kdm.h"
 #include "exceptions.h"
 #include "filesystem.h"
+#include "parallel.h"
 #include "search.h"
+#include <exception>
 
 
 using std::make_shared;
@@ -58,38 +61,56 @@ dcp::find_and_resolve_cpls (vector<boost::filesystem::path> const& directories,
 		dcp::VerificationNote::Code::THREED_ASSET_MARKED_AS_TWOD,
 	};
 
-	vector<shared_ptr<dcp::DCP>> dcps;
+	vector<boost::filesystem::path> existing;
 	for (auto i: directories) {
-		if (!filesystem::exists(i)) {
-			/* Don't make a DCP object or it will try to create the parent directories
-			 * of i if they do not exist (#2344).
+		if (filesystem::exists(i)) {
+			/* Don't make a DCP object for i if it does not exist, or it will try to create
+			 * the parent directories of i if they do not exist (#2344).
 			 */
-			continue;
+			existing.push_back(i);
 		}
-		auto dcp = make_shared<dcp::DCP>(i);
-		vector<dcp::VerificationNote> notes;
-		dcp->read (&notes, true);
-		if (!tolerant) {
-			for (auto j: notes) {
-				if (std::find(ignore.begin(), ignore.end(), j.code()) == ignore.end()) {
-					boost::throw_exception(dcp::ReadError(dcp::note_to_string(j)));
+	}
+
+	/* Read the DCPs in parallel, but report any problem as if we had read them one by one */
+	vector<shared_ptr<dcp::DCP>> dcps(existing.size());
+	vector<std::exception_ptr> errors(existing.size());
+	parallel_for(static_cast<int>(existing.size()), 0, [&](int i) {
+		try {
+			auto dcp = make_shared<dcp::DCP>(existing[i]);
+			vector<dcp::VerificationNote> notes;
+			dcp->read (&notes, true);
+			if (!tolerant) {
+				for (auto j: notes) {
+					if (std::find(ignore.begin(), ignore.end(), j.code()) == ignore.end()) {
+						boost::throw_exception(dcp::ReadError(dcp::note_to_string(j)));
+					}
 				}
 			}
+			dcps[i] = dcp;
+		} catch (...) {
+			errors[i] = std::current_exception();
 		}
-		dcps.push_back (dcp);
-		for (auto i: dcp->cpls()) {
-			cpls.push_back (i);
+	});
+
+	for (auto const& error: errors) {
+		if (error) {
+			std::rethrow_exception(error);
 		}
 	}
 
+	/* Make one index of every asset in every DCP and resolve everything against it */
+	AssetIndex assets;
 	for (auto i: dcps) {
-		for (auto j: dcps) {
-			if (i != j) {
-				i->resolve_refs(j->assets(true));
-			}
+		assets.add(i->assets(true));
+		for (auto j: i->cpls()) {
+			cpls.push_back (j);
 		}
 	}
 
+	for (auto i: dcps) {
+		i->resolve_refs(assets);
+	}
+
 	return cpls;
 }
 
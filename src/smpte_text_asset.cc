@@ -43,10 +43,12 @@
 #include "equality_options.h"
 #include "exceptions.h"
 #include "filesystem.h"
+#include "lazy_data.h"
 #include "raw_convert.h"
 #include "smpte_load_font_node.h"
 #include "smpte_text_asset.h"
 #include "text_image.h"
+#include "text_parser.h"
 #include "util.h"
 #include "warnings.h"
 #include "xml.h"
@@ -58,6 +60,7 @@ LIBDCP_DISABLE_WARNINGS
 LIBDCP_ENABLE_WARNINGS
 #include <fmt/format.h>
 #include <boost/algorithm/string.hpp>
+#include <mutex>
 
 
 using std::string;
@@ -91,11 +94,10 @@ SMPTETextAsset::SMPTETextAsset(SubtitleStandard standard)
 }
 
 
-SMPTETextAsset::SMPTETextAsset(boost::filesystem::path file)
+SMPTETextAsset::SMPTETextAsset(boost::filesystem::path file, bool lazy)
 	: TextAsset (file)
+	, _lazy(lazy)
 {
-	auto xml = make_shared<cxml::Document>("SubtitleReel");
-
 	Kumu::FileReaderFactory factory;
 	auto reader = make_shared<ASDCP::TimedText::MXFReader>(factory);
 	auto const r = reader->OpenRead(dcp::filesystem::fix_long_path(*_file).string().c_str());
@@ -109,8 +111,7 @@ SMPTETextAsset::SMPTETextAsset(boost::filesystem::path file)
 			string xml_string;
 			reader->ReadTimedTextResource (xml_string);
 			_raw_xml = xml_string;
-			xml->read_string (xml_string);
-			parse_xml (xml);
+			parse_xml();
 			read_mxf_descriptor (reader);
 			read_mxf_resources(reader, std::make_shared<DecryptionContext>(optional<Key>(), Standard::SMPTE));
 		} else {
@@ -120,10 +121,8 @@ SMPTETextAsset::SMPTETextAsset(boost::filesystem::path file)
 		/* Plain XML */
 		try {
 			_raw_xml = dcp::file_to_string (file);
-			xml = make_shared<cxml::Document>("SubtitleReel");
-			xml->read_file(dcp::filesystem::fix_long_path(file));
-			parse_xml (xml);
-		} catch (cxml::Error& e) {
+			parse_xml();
+		} catch (XMLError& e) {
 			boost::throw_exception (
 				ReadError (
 					String::compose (
@@ -139,15 +138,17 @@ SMPTETextAsset::SMPTETextAsset(boost::filesystem::path file)
 		*/
 		for (auto i: _texts) {
 			auto im = dynamic_pointer_cast<TextImage>(i);
-			if (im && im->png_image().size() == 0) {
+			if (im && !im->has_png_image()) {
 				/* Even more dubious; allow <id>.png or urn:uuid:<id>.png */
 				auto p = file.parent_path() / String::compose("%1.png", im->id());
-				if (filesystem::is_regular_file(p)) {
-					im->read_png_file (p);
-				} else if (starts_with (im->id(), "urn:uuid:")) {
+				if (!filesystem::is_regular_file(p) && starts_with(im->id(), "urn:uuid:")) {
 					p = file.parent_path() / String::compose("%1.png", remove_urn_uuid(im->id()));
-					if (filesystem::is_regular_file(p)) {
-						im->read_png_file (p);
+				}
+				if (filesystem::is_regular_file(p)) {
+					if (_lazy) {
+						im->set_png_file(p);
+					} else {
+						im->read_png_file(p);
 					}
 				}
 			}
@@ -158,7 +159,7 @@ SMPTETextAsset::SMPTETextAsset(boost::filesystem::path file)
 	/* Check that all required image data have been found */
 	for (auto i: _texts) {
 		auto im = dynamic_pointer_cast<TextImage>(i);
-		if (im && im->png_image().size() == 0) {
+		if (im && !im->has_png_image()) {
 			throw MissingTextImageError (im->id());
 		}
 	}
@@ -166,28 +167,36 @@ SMPTETextAsset::SMPTETextAsset(boost::filesystem::path file)
 
 
 void
-SMPTETextAsset::parse_xml(shared_ptr<cxml::Document> xml)
+SMPTETextAsset::parse_xml()
 {
-	if (xml->namespace_uri() == subtitle_smpte_ns_2007) {
+	TextParser parser(Standard::SMPTE);
+	parse_raw_xml(parser, "SubtitleReel");
+
+	if (parser.namespace_uri() == subtitle_smpte_ns_2007) {
 		_subtitle_standard = SubtitleStandard::SMPTE_2007;
-	} else if (xml->namespace_uri() == subtitle_smpte_ns_2010) {
+	} else if (parser.namespace_uri() == subtitle_smpte_ns_2010) {
 		_subtitle_standard = SubtitleStandard::SMPTE_2010;
-	} else if (xml->namespace_uri() == subtitle_smpte_ns_2014) {
+	} else if (parser.namespace_uri() == subtitle_smpte_ns_2014) {
 		_subtitle_standard = SubtitleStandard::SMPTE_2014;
 	} else {
-		throw XMLError("Unrecognised subtitle namespace " + xml->namespace_uri());
+		throw XMLError("Unrecognised subtitle namespace " + parser.namespace_uri());
+	}
+	_xml_id = remove_urn_uuid(parser.string_child("Id"));
+	_load_font_nodes.clear();
+	for (auto const& load_font: parser.children("LoadFont")) {
+		_load_font_nodes.push_back(make_shared<SMPTELoadFontNode>(load_font.attributes.string_attribute("ID"), remove_urn_uuid(load_font.content)));
 	}
-	_xml_id = remove_urn_uuid(xml->string_child("Id"));
-	_load_font_nodes = type_children<dcp::SMPTELoadFontNode> (xml, "LoadFont");
 
-	_content_title_text = xml->string_child ("ContentTitleText");
-	_annotation_text = xml->optional_string_child ("AnnotationText");
-	_issue_date = LocalTime (xml->string_child ("IssueDate"));
-	_reel_number = xml->optional_number_child<int> ("ReelNumber");
-	_language = xml->optional_string_child ("Language");
+	_content_title_text = parser.string_child("ContentTitleText");
+	_annotation_text = parser.optional_string_child("AnnotationText");
+	_issue_date = LocalTime(parser.string_child("IssueDate"));
+	if (auto reel_number = parser.optional_string_child("ReelNumber")) {
+		_reel_number = raw_convert<int>(*reel_number);
+	}
+	_language = parser.optional_string_child("Language");
 
 	/* This is supposed to be two numbers, but a single number has been seen in the wild */
-	auto const er = xml->string_child ("EditRate");
+	auto const er = parser.string_child("EditRate");
 	vector<string> er_parts;
 	split (er_parts, er, is_any_of (" "));
 	if (er_parts.size() == 1) {
@@ -198,20 +207,12 @@ SMPTETextAsset::parse_xml(shared_ptr<cxml::Document> xml)
 		throw XMLError ("malformed EditRate " + er);
 	}
 
-	_time_code_rate = xml->number_child<int> ("TimeCodeRate");
-	if (xml->optional_string_child ("StartTime")) {
-		_start_time = Time (xml->string_child("StartTime"), _time_code_rate);
-	}
-
-	/* Now we need to drop down to xmlpp */
-
-	vector<ParseState> ps;
-	for (auto i: xml->node()->get_children()) {
-		auto const e = dynamic_cast<xmlpp::Element const *>(i);
-		if (e && e->get_name() == "SubtitleList") {
-			parse_texts(e, ps, _time_code_rate, Standard::SMPTE);
-		}
+	auto const summary = parser.summary();
+	if (!summary->time_code_rate) {
+		throw XMLError("missing XML tag TimeCodeRate");
 	}
+	_time_code_rate = *summary->time_code_rate;
+	_start_time = summary->start_time;
 
 	/* Guess intrinsic duration */
 	_intrinsic_duration = latest_text_out().as_editable_units_ceil(_edit_rate.numerator / _edit_rate.denominator);
@@ -224,31 +225,40 @@ SMPTETextAsset::read_mxf_resources(shared_ptr<ASDCP::TimedText::MXFReader> reade
 	ASDCP::TimedText::TimedTextDescriptor descriptor;
 	reader->FillTimedTextDescriptor (descriptor);
 
-	/* Load fonts and images */
-
-	for (
-		auto i = descriptor.ResourceList.begin();
-		i != descriptor.ResourceList.end();
-		++i) {
-
-		ASDCP::TimedText::FrameBuffer buffer;
-		buffer.Capacity(32 * 1024 * 1024);
-		auto const result = reader->ReadAncillaryResource(i->ResourceID, buffer, dec->context(), dec->hmac());
-		if (ASDCP_FAILURE(result)) {
-			switch (i->Type) {
-			case ASDCP::TimedText::MT_OPENTYPE:
-				throw ReadError(String::compose("Could not read font from MXF file (%1)", static_cast<int>(result)));
-			case ASDCP::TimedText::MT_PNG:
-				throw ReadError(String::compose("Could not read subtitle image from MXF file (%1)", static_cast<int>(result)));
-			default:
-				throw ReadError(String::compose("Could not read resource from MXF file (%1)", static_cast<int>(result)));
+	/* Lazily-read resources will share reader and dec, which must only be used by one of them at once */
+	auto mutex = make_shared<std::mutex>();
+
+	/* Load fonts and images, or (if we are lazy) arrange to load them when they are first needed */
+
+	for (auto const& resource: descriptor.ResourceList) {
+		auto load = [reader, dec, mutex, resource]() {
+			std::lock_guard<std::mutex> lm(*mutex);
+			ASDCP::TimedText::FrameBuffer buffer;
+			buffer.Capacity(32 * 1024 * 1024);
+			auto const result = reader->ReadAncillaryResource(resource.ResourceID, buffer, dec->context(), dec->hmac());
+			if (ASDCP_FAILURE(result)) {
+				switch (resource.Type) {
+				case ASDCP::TimedText::MT_OPENTYPE:
+					throw ReadError(String::compose("Could not read font from MXF file (%1)", static_cast<int>(result)));
+				case ASDCP::TimedText::MT_PNG:
+					throw ReadError(String::compose("Could not read subtitle image from MXF file (%1)", static_cast<int>(result)));
+				default:
+					throw ReadError(String::compose("Could not read resource from MXF file (%1)", static_cast<int>(result)));
+				}
 			}
+			return ArrayData(buffer.RoData(), buffer.Size());
+		};
+
+		/* The same font is often found in the MXFs of many reels, so let identical fonts share their data */
+		LazyData data(load, resource.Type == ASDCP::TimedText::MT_OPENTYPE);
+		if (!_lazy) {
+			data.get();
 		}
 
 		char id[64];
-		Kumu::bin2UUIDhex (i->ResourceID, ASDCP::UUIDlen, id, sizeof(id));
+		Kumu::bin2UUIDhex (resource.ResourceID, ASDCP::UUIDlen, id, sizeof(id));
 
-		switch (i->Type) {
+		switch (resource.Type) {
 		case ASDCP::TimedText::MT_OPENTYPE:
 		{
 			auto j = _load_font_nodes.begin();
@@ -257,7 +267,7 @@ SMPTETextAsset::read_mxf_resources(shared_ptr<ASDCP::TimedText::MXFReader> reade
 			}
 
 			if (j != _load_font_nodes.end ()) {
-				_fonts.push_back(Font((*j)->id, (*j)->urn, ArrayData(buffer.RoData(), buffer.Size())));
+				_fonts.push_back(Font((*j)->id, (*j)->urn, data));
 			}
 			break;
 		}
@@ -269,7 +279,7 @@ SMPTETextAsset::read_mxf_resources(shared_ptr<ASDCP::TimedText::MXFReader> reade
 			}
 
 			if (j != _texts.end()) {
-				dynamic_pointer_cast<TextImage>(*j)->set_png_image(ArrayData(buffer.RoData(), buffer.Size()));
+				dynamic_pointer_cast<TextImage>(*j)->set_png_image(data);
 			}
 			break;
 		}
@@ -333,9 +343,7 @@ SMPTETextAsset::set_key(Key key)
 	string xml_string;
 	reader->ReadTimedTextResource (xml_string, dec->context(), dec->hmac());
 	_raw_xml = xml_string;
-	auto xml = make_shared<cxml::Document>("SubtitleReel");
-	xml->read_string (xml_string);
-	parse_xml (xml);
+	parse_xml();
 	read_mxf_descriptor(reader);
 	read_mxf_resources (reader, dec);
 }
@@ -449,6 +457,20 @@ SMPTETextAsset::write(boost::filesystem::path p) const
 	DCP_ASSERT (c == Kumu::UUID_Length);
 	descriptor.ContainerDuration = _intrinsic_duration;
 
+	if (_lazy) {
+		/* Some of our fonts and images may still be waiting to be read from the file that we
+		 * are about to write, so read them now.
+		 */
+		for (auto const& i: _fonts) {
+			i.data.get();
+		}
+		for (auto i: _texts) {
+			if (auto si = dynamic_pointer_cast<TextImage>(i)) {
+				si->png_image();
+			}
+		}
+	}
+
 	ASDCP::TimedText::MXFWriter writer;
 	/* This header size is a guess.  Empirically it seems that each subtitle reference is 90 bytes, and we need some extra.
 	   The default size is not enough for some feature-length PNG sub projects (see DCP-o-matic #1561).
@@ -458,7 +480,7 @@ SMPTETextAsset::write(boost::filesystem::path p) const
 		boost::throw_exception (FileError ("could not open subtitle MXF for writing", p.string(), r));
 	}
 
-	_raw_xml = xml_as_string ();
+	set_raw_xml(xml_as_string());
 
 	r = writer.WriteTimedTextResource (*_raw_xml, enc.context(), enc.hmac());
 	if (ASDCP_FAILURE (r)) {
@@ -474,9 +496,9 @@ SMPTETextAsset::write(boost::filesystem::path p) const
 		}
 		if (j != _fonts.end ()) {
 			ASDCP::TimedText::FrameBuffer buffer;
-			ArrayData data_copy(j->data);
+			ArrayData data_copy(j->data.get());
 			buffer.SetData (data_copy.data(), data_copy.size());
-			buffer.Size (j->data.size());
+			buffer.Size (data_copy.size());
 			r = writer.WriteAncillaryResource (buffer, enc.context(), enc.hmac());
 			if (ASDCP_FAILURE(r)) {
 				throw_from_asdcplib(r, p, MXFFileError("could not write font to timed text resource", p.string(), r));
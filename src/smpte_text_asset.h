@@ -79,8 +79,10 @@ public:
 
 	/** Construct a SMPTETextAsset by reading an MXF or XML file
 	 *  @param file Filename
+	 *  @param lazy true to leave the font and image data to be read from file the first time that they are
+	 *  needed; the file must then be left alone until this asset has been written or destroyed.
 	 */
-	explicit SMPTETextAsset(boost::filesystem::path file);
+	explicit SMPTETextAsset(boost::filesystem::path file, bool lazy = false);
 
 	bool can_be_read() const override;
 
@@ -216,7 +218,7 @@ private:
 	friend struct ::write_subtitles_in_vertical_order_with_top_alignment;
 	friend struct ::write_subtitles_in_vertical_order_with_bottom_alignment;
 
-	void parse_xml (std::shared_ptr<cxml::Document> xml);
+	void parse_xml();
 	void read_mxf_descriptor (std::shared_ptr<ASDCP::TimedText::MXFReader> reader);
 	void read_mxf_resources (std::shared_ptr<ASDCP::TimedText::MXFReader> reader, std::shared_ptr<DecryptionContext> dec);
 	std::string schema_namespace() const;
@@ -254,6 +256,9 @@ private:
 
 	/** ResourceID read from the MXF, if there was one */
 	boost::optional<std::string> _resource_id;
+
+	/** true to read font and image data from our file when they are first needed */
+	bool _lazy = false;
 };
 
 
@@ -37,6 +37,7 @@
  */
 
 
+#include "asset_equality.h"
 #include "compose.hpp"
 #include "dcp_assert.h"
 #include "equality_options.h"
@@ -140,9 +141,15 @@ SoundAsset::equals(shared_ptr<const Asset> other, EqualityOptions const& opt, No
 		return true;
 	}
 
+	DCP_ASSERT (file());
+	DCP_ASSERT (other->file());
+
+	if (asset_files_identical(*this, *other, opt, note)) {
+		return true;
+	}
+
 	Kumu::FileReaderFactory factory;
 	ASDCP::PCM::MXFReader reader_A(factory);
-	DCP_ASSERT (file());
 	auto r = reader_A.OpenRead(dcp::filesystem::fix_long_path(*file()).string().c_str());
 	if (ASDCP_FAILURE(r)) {
 		boost::throw_exception (MXFFileError("could not open MXF file for reading", file()->string(), r));
@@ -209,33 +216,52 @@ SoundAsset::equals(shared_ptr<const Asset> other, EqualityOptions const& opt, No
 
 	auto other_sound = dynamic_pointer_cast<const SoundAsset> (other);
 
-	auto reader = start_read ();
-	auto other_reader = other_sound->start_read ();
+	/* If both assets are encrypted with the same key, frames whose encrypted data are the same need not be decrypted */
+	auto const compare_encrypted = same_key_id(*this, *other_sound);
+
+	return frames_equal(_intrinsic_duration, "audio", opt, note, [this, other_sound, compare_encrypted, &opt]() {
+		auto reader = start_read();
+		auto other_reader = other_sound->start_read();
+		shared_ptr<SoundAssetReader> encrypted_reader;
+		shared_ptr<SoundAssetReader> other_encrypted_reader;
+		if (compare_encrypted) {
+			/* Can't use make_shared here as the SoundAssetReader constructor is private */
+			encrypted_reader.reset(new SoundAssetReader(this, boost::none, standard()));
+			other_encrypted_reader.reset(new SoundAssetReader(other_sound.get(), boost::none, other_sound->standard()));
+		}
 
-	for (int i = 0; i < _intrinsic_duration; ++i) {
+		return [reader, other_reader, encrypted_reader, other_encrypted_reader, &opt](int i, NoteHandler frame_note) {
+			if (encrypted_reader) {
+				auto frame_A = encrypted_reader->get_frame(i);
+				auto frame_B = other_encrypted_reader->get_frame(i);
+				if (frame_A->size() == frame_B->size() && memcmp(frame_A->data(), frame_B->data(), frame_A->size()) == 0) {
+					return true;
+				}
+			}
 
-		auto frame_A = reader->get_frame (i);
-		auto frame_B = other_reader->get_frame (i);
+			auto frame_A = reader->get_frame (i);
+			auto frame_B = other_reader->get_frame (i);
 
-		if (frame_A->size() != frame_B->size()) {
-			note (NoteType::ERROR, String::compose ("sizes of audio data for frame %1 differ", i));
-			return false;
-		}
+			if (frame_A->size() != frame_B->size()) {
+				frame_note (NoteType::ERROR, String::compose ("sizes of audio data for frame %1 differ", i));
+				return false;
+			}
 
-		if (memcmp (frame_A->data(), frame_B->data(), frame_A->size()) != 0) {
-			for (int sample = 0; sample < frame_A->samples(); ++sample) {
-				for (int channel = 0; channel < frame_A->channels(); ++channel) {
-					int32_t const d = abs(frame_A->get(channel, sample) - frame_B->get(channel, sample));
-					if (d > opt.max_audio_sample_error) {
-						note (NoteType::ERROR, String::compose("PCM data difference of %1 in frame %2, channel %3, sample %4", d, i, channel, sample));
-						return false;
+			if (memcmp (frame_A->data(), frame_B->data(), frame_A->size()) != 0) {
+				for (int sample = 0; sample < frame_A->samples(); ++sample) {
+					for (int channel = 0; channel < frame_A->channels(); ++channel) {
+						int32_t const d = abs(frame_A->get(channel, sample) - frame_B->get(channel, sample));
+						if (d > opt.max_audio_sample_error) {
+							frame_note (NoteType::ERROR, String::compose("PCM data difference of %1 in frame %2, channel %3, sample %4", d, i, channel, sample));
+							return false;
+						}
 					}
 				}
 			}
-		}
-	}
 
-	return true;
+			return true;
+		};
+	});
 }
 
 
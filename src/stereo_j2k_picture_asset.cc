@@ -37,6 +37,7 @@
  */
 
 
+#include "asset_equality.h"
 #include "dcp_assert.h"
 #include "equality_options.h"
 #include "exceptions.h"
@@ -46,6 +47,7 @@
 #include "stereo_j2k_picture_asset_writer.h"
 #include "stereo_j2k_picture_frame.h"
 #include <asdcp/AS_DCP.h>
+#include <cstring>
 
 
 using std::string;
@@ -106,16 +108,21 @@ StereoJ2KPictureAsset::start_read () const
 bool
 StereoJ2KPictureAsset::equals(shared_ptr<const Asset> other, EqualityOptions const& opt, NoteHandler note) const
 {
+	DCP_ASSERT (file());
+	DCP_ASSERT (other->file());
+
+	if (asset_files_identical(*this, *other, opt, note)) {
+		return true;
+	}
+
 	Kumu::FileReaderFactory factory;
 	ASDCP::JP2K::MXFSReader reader_A(factory);
-	DCP_ASSERT (file());
 	auto r = reader_A.OpenRead(dcp::filesystem::fix_long_path(*file()).string().c_str());
 	if (ASDCP_FAILURE (r)) {
 		boost::throw_exception (MXFFileError ("could not open MXF file for reading", file()->string(), r));
 	}
 
 	ASDCP::JP2K::MXFSReader reader_B(factory);
-	DCP_ASSERT (other->file());
 	r = reader_B.OpenRead(dcp::filesystem::fix_long_path(*other->file()).string().c_str());
 	if (ASDCP_FAILURE (r)) {
 		boost::throw_exception (MXFFileError ("could not open MXF file for reading", other->file()->string(), r));
@@ -137,49 +144,65 @@ StereoJ2KPictureAsset::equals(shared_ptr<const Asset> other, EqualityOptions con
 	auto other_picture = dynamic_pointer_cast<const StereoJ2KPictureAsset> (other);
 	DCP_ASSERT (other_picture);
 
-	auto reader = start_read ();
-	auto other_reader = other_picture->start_read ();
-
-	bool result = true;
-
-	for (int i = 0; i < _intrinsic_duration; ++i) {
-		shared_ptr<const StereoJ2KPictureFrame> frame_A;
-		shared_ptr<const StereoJ2KPictureFrame> frame_B;
-		try {
-			frame_A = reader->get_frame (i);
-			frame_B = other_reader->get_frame (i);
-		} catch (ReadError& e) {
-			/* If there was a problem reading the frame data we'll just assume
-			   the two frames are not equal.
-			*/
-			note (NoteType::ERROR, e.what ());
-			return false;
+	/* If both assets are encrypted with the same key, frames whose encrypted data are the same need not be decrypted */
+	auto const compare_encrypted = same_key_id(*this, *other_picture);
+
+	return frames_equal(_intrinsic_duration, "video", opt, note, [this, other_picture, compare_encrypted, &opt]() {
+		auto reader = start_read();
+		auto other_reader = other_picture->start_read();
+		shared_ptr<StereoJ2KPictureAssetReader> encrypted_reader;
+		shared_ptr<StereoJ2KPictureAssetReader> other_encrypted_reader;
+		if (compare_encrypted) {
+			/* Can't use make_shared here as the StereoJ2KPictureAssetReader constructor is private */
+			encrypted_reader.reset(new StereoJ2KPictureAssetReader(this, boost::none, standard()));
+			other_encrypted_reader.reset(new StereoJ2KPictureAssetReader(other_picture.get(), boost::none, other_picture->standard()));
 		}
 
-		if (!frame_buffer_equals (
-			    i, opt, note,
-			    frame_A->left()->data(), frame_A->left()->size(),
-			    frame_B->left()->data(), frame_B->left()->size()
-			    )) {
-			result = false;
-			if (!opt.keep_going) {
-				return result;
+		return [this, reader, other_reader, encrypted_reader, other_encrypted_reader, &opt](int i, NoteHandler frame_note) {
+			auto same = [](shared_ptr<StereoJ2KPictureFrame::Part> a, shared_ptr<StereoJ2KPictureFrame::Part> b) {
+				return a->size() == b->size() && memcmp(a->data(), b->data(), a->size()) == 0;
+			};
+
+			shared_ptr<const StereoJ2KPictureFrame> frame_A;
+			shared_ptr<const StereoJ2KPictureFrame> frame_B;
+			try {
+				if (encrypted_reader) {
+					frame_A = encrypted_reader->get_frame(i);
+					frame_B = other_encrypted_reader->get_frame(i);
+					if (same(frame_A->left(), frame_B->left()) && same(frame_A->right(), frame_B->right())) {
+						frame_note(NoteType::NOTE, "Encrypted J2K identical");
+						return true;
+					}
+				}
+
+				frame_A = reader->get_frame(i);
+				frame_B = other_reader->get_frame(i);
+			} catch (ReadError& e) {
+				/* If there was a problem reading the frame data we'll just assume
+				   the two frames are not equal.
+				*/
+				frame_note(NoteType::ERROR, e.what());
+				return false;
 			}
-		}
 
-		if (!frame_buffer_equals (
-			    i, opt, note,
-			    frame_A->right()->data(), frame_A->right()->size(),
-			    frame_B->right()->data(), frame_B->right()->size()
-			    )) {
-			result = false;
-			if (!opt.keep_going) {
-				return result;
+			auto const left = frame_buffer_equals(
+				i, opt, frame_note,
+				frame_A->left()->data(), frame_A->left()->size(),
+				frame_B->left()->data(), frame_B->left()->size()
+				);
+			if (!left && !opt.keep_going) {
+				return false;
 			}
-		}
-	}
 
-	return result;
+			auto const right = frame_buffer_equals(
+				i, opt, frame_note,
+				frame_A->right()->data(), frame_A->right()->size(),
+				frame_B->right()->data(), frame_B->right()->size()
+				);
+
+			return left && right;
+		};
+	});
 }
 
 
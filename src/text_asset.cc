@@ -40,19 +40,18 @@
 #include "compose.hpp"
 #include "dcp_assert.h"
 #include "load_font_node.h"
-#include "raw_convert.h"
 #include "reel_asset.h"
 #include "text_image.h"
 #include "text_string.h"
 #include "text_asset.h"
 #include "text_asset_internal.h"
+#include "text_parser.h"
 #include "util.h"
 #include "xml.h"
 #include <asdcp/AS_DCP.h>
 #include <asdcp/KM_util.h>
 #include <libxml++/nodes/element.h>
 #include <boost/algorithm/string.hpp>
-#include <boost/lexical_cast.hpp>
 #include <boost/shared_array.hpp>
 #include <algorithm>
 
@@ -66,7 +65,6 @@ using std::pair;
 using std::shared_ptr;
 using std::string;
 using std::vector;
-using boost::lexical_cast;
 using boost::optional;
 using namespace dcp;
 
@@ -84,534 +82,171 @@ TextAsset::TextAsset(boost::filesystem::path file)
 }
 
 
-string
-string_attribute (xmlpp::Element const * node, string name)
-{
-	auto a = node->get_attribute (name);
-	if (!a) {
-		throw XMLError (String::compose ("missing attribute %1", name));
-	}
-	return string (a->get_value ());
-}
-
-
-optional<string>
-optional_string_attribute (xmlpp::Element const * node, string name)
+void
+TextAsset::parse_raw_xml(TextParser& parser, string root_name)
 {
-	auto a = node->get_attribute (name);
-	if (!a) {
-		return {};
-	}
-	return string (a->get_value ());
-}
+	DCP_ASSERT(_raw_xml);
 
+	parser.parse(*_raw_xml, root_name, [this](shared_ptr<Text> text) {
+		if (dynamic_pointer_cast<TextImage>(text)) {
+			_image_texts++;
+		}
+		_texts.push_back(text);
+	});
 
-optional<bool>
-optional_bool_attribute (xmlpp::Element const * node, string name)
-{
-	auto s = optional_string_attribute (node, name);
-	if (!s) {
-		return {};
-	}
+	texts_changed();
 
-	return (s.get() == "1" || s.get() == "yes");
+	std::lock_guard<std::mutex> lm(_xml_summary_mutex);
+	_xml_summary = parser.summary();
 }
 
 
-template <class T>
-optional<T>
-optional_number_attribute (xmlpp::Element const * node, string name)
+void
+TextAsset::set_raw_xml(string xml) const
 {
-	auto s = optional_string_attribute (node, name);
-	if (!s) {
-		return boost::optional<T> ();
-	}
+	_raw_xml = xml;
 
-	std::string t = s.get ();
-	boost::erase_all (t, " ");
-	return raw_convert<T> (t);
+	std::lock_guard<std::mutex> lm(_xml_summary_mutex);
+	_xml_summary.reset();
 }
 
 
-TextAsset::ParseState
-TextAsset::font_node_state(xmlpp::Element const * node, Standard standard) const
-{
-	ParseState ps;
-
-	if (standard == Standard::INTEROP) {
-		ps.font_id = optional_string_attribute (node, "Id");
-	} else {
-		ps.font_id = optional_string_attribute (node, "ID");
-	}
-	ps.size = optional_number_attribute<int64_t> (node, "Size");
-	ps.aspect_adjust = optional_number_attribute<float> (node, "AspectAdjust");
-	ps.italic = optional_bool_attribute (node, "Italic");
-	ps.bold = optional_string_attribute(node, "Weight").get_value_or("normal") == "bold";
-	if (standard == Standard::INTEROP) {
-		ps.underline = optional_bool_attribute (node, "Underlined");
-	} else {
-		ps.underline = optional_bool_attribute (node, "Underline");
-	}
-	auto c = optional_string_attribute (node, "Color");
-	if (c) {
-		ps.colour = Colour (c.get ());
-	}
-	auto const e = optional_string_attribute (node, "Effect");
-	if (e) {
-		ps.effect = string_to_effect (e.get ());
-	}
-	c = optional_string_attribute (node, "EffectColor");
-	if (c) {
-		ps.effect_colour = Colour (c.get ());
-	}
-
-	return ps;
-}
-
-void
-TextAsset::position_align(TextAsset::ParseState& ps, xmlpp::Element const * node) const
+shared_ptr<const TextAsset::XMLSummary>
+TextAsset::xml_summary() const
 {
-	auto hp = optional_number_attribute<float> (node, "HPosition");
-	if (!hp) {
-		hp = optional_number_attribute<float> (node, "Hposition");
-	}
-	if (hp) {
-		ps.h_position = hp.get () / 100;
-	}
-
-	auto ha = optional_string_attribute (node, "HAlign");
-	if (!ha) {
-		ha = optional_string_attribute (node, "Halign");
-	}
-	if (ha) {
-		ps.h_align = string_to_halign (ha.get ());
-	}
-
-	auto vp = optional_number_attribute<float> (node, "VPosition");
-	if (!vp) {
-		vp = optional_number_attribute<float> (node, "Vposition");
-	}
-	if (vp) {
-		ps.v_position = vp.get () / 100;
-	}
-
-	auto va = optional_string_attribute (node, "VAlign");
-	if (!va) {
-		va = optional_string_attribute (node, "Valign");
-	}
-	if (va) {
-		ps.v_align = string_to_valign (va.get ());
+	auto raw = raw_xml();
+	if (!raw) {
+		return {};
 	}
 
-	if (auto zp = optional_number_attribute<float>(node, "Zposition")) {
-		ps.z_position = zp.get() / 100;
+	std::lock_guard<std::mutex> lm(_xml_summary_mutex);
+	if (!_xml_summary) {
+		/* We have XML that we have not parsed (e.g. because we wrote it ourselves) so parse it now,
+		 * just to get the summary.
+		 */
+		auto const interop = subtitle_standard() == SubtitleStandard::INTEROP;
+		TextParser parser(interop ? Standard::INTEROP : Standard::SMPTE);
+		parser.parse(*raw, interop ? "DCSubtitle" : "SubtitleReel", {});
+		_xml_summary = parser.summary();
 	}
 
-	if (auto variable_z = optional_string_attribute(node, "VariableZ")) {
-		ps.variable_z = *variable_z;
-	}
+	return _xml_summary;
 }
 
 
-TextAsset::ParseState
-TextAsset::text_node_state(xmlpp::Element const * node) const
+vector<shared_ptr<const Text>>
+TextAsset::texts() const
 {
-	ParseState ps;
-
-	position_align (ps, node);
-
-	auto d = optional_string_attribute (node, "Direction");
-	if (d) {
-		ps.direction = string_to_direction (d.get ());
+	vector<shared_ptr<const Text>> s;
+	for (auto i: _texts) {
+		s.push_back (i);
 	}
-
-	ps.type = ParseState::Type::TEXT;
-
-	return ps;
-}
-
-
-TextAsset::ParseState
-TextAsset::image_node_state(xmlpp::Element const * node) const
-{
-	ParseState ps;
-
-	position_align (ps, node);
-
-	ps.type = ParseState::Type::IMAGE;
-
-	return ps;
+	return s;
 }
 
 
-TextAsset::ParseState
-TextAsset::subtitle_node_state(xmlpp::Element const * node, optional<int> tcr) const
+void
+TextAsset::texts_changed()
 {
-	ParseState ps;
-	ps.in = Time (string_attribute(node, "TimeIn"), tcr);
-	ps.out = Time (string_attribute(node, "TimeOut"), tcr);
-	ps.fade_up_time = fade_time (node, "FadeUpTime", tcr);
-	ps.fade_down_time = fade_time (node, "FadeDownTime", tcr);
-
-	for (auto child: node->get_children()) {
-		auto element = dynamic_cast<xmlpp::Element const*>(child);
-		if (element && element->get_name() == "LoadVariableZ") {
-			ps.load_variable_z.push_back(LoadVariableZ(element));
-		}
-	}
-
-	return ps;
+	std::lock_guard<std::mutex> lm(_texts_index_mutex);
+	_texts_index.reset();
 }
 
 
-Time
-TextAsset::fade_time(xmlpp::Element const * node, string name, optional<int> tcr) const
+/** Build the latest_out tree for the texts by_in[lo, hi) at a given node */
+static Time
+build_latest_out(vector<shared_ptr<Text>> const& texts, vector<size_t> const& by_in, vector<Time>& latest_out, size_t node, size_t lo, size_t hi)
 {
-	auto const u = optional_string_attribute(node, name).get_value_or ("");
-	Time t;
-
-	if (u.empty ()) {
-		t = Time (0, 0, 0, 20, 250);
-	} else if (u.find (":") != string::npos) {
-		t = Time (u, tcr);
+	if (hi - lo == 1) {
+		latest_out[node] = texts[by_in[lo]]->out();
 	} else {
-		t = Time (0, 0, 0, lexical_cast<int> (u), tcr.get_value_or(250));
-	}
-
-	if (t > Time (0, 0, 8, 0, 250)) {
-		t = Time (0, 0, 8, 0, 250);
+		auto const mid = (lo + hi) / 2;
+		latest_out[node] = std::max(
+			build_latest_out(texts, by_in, latest_out, node * 2 + 1, lo, mid),
+			build_latest_out(texts, by_in, latest_out, node * 2 + 2, mid, hi)
+			);
 	}
-
-	return t;
+	return latest_out[node];
 }
 
 
-void
-TextAsset::parse_texts(xmlpp::Element const * node, vector<ParseState>& state, optional<int> tcr, Standard standard)
+/** Add to result the indices of texts in by_in[lo, min(hi, end)) (at a given node) whose out time is at or after from */
+static void
+find_latest_out(vector<size_t> const& by_in, vector<Time> const& latest_out, size_t node, size_t lo, size_t hi, size_t end, Time const& from, vector<size_t>& result)
 {
-	if (node->get_name() == "Font") {
-		state.push_back (font_node_state (node, standard));
-	} else if (node->get_name() == "Subtitle") {
-		state.push_back (subtitle_node_state (node, tcr));
-	} else if (node->get_name() == "Text") {
-		state.push_back (text_node_state (node));
-	} else if (node->get_name() == "SubtitleList") {
-		state.push_back (ParseState ());
-	} else if (node->get_name() == "Image") {
-		state.push_back (image_node_state (node));
-	} else if (node->get_name() == "LoadVariableZ") {
+	if (lo >= end || latest_out[node] < from) {
 		return;
-	} else {
-		throw XMLError ("unexpected node " + node->get_name());
-	}
-
-	float space_before = 0;
-
-	/* Collect <Ruby>s first */
-	auto get_text_content = [](xmlpp::Element const* element) {
-		string all_content;
-		for (auto child: element->get_children()) {
-			auto content = dynamic_cast<xmlpp::ContentNode const*>(child);
-			if (content) {
-				all_content += content->get_content();
-			}
-		}
-		return all_content;
-	};
-
-	vector<Ruby> rubies;
-	for (auto child: node->get_children()) {
-		auto element = dynamic_cast<xmlpp::Element const*>(child);
-		if (element && element->get_name() == "Ruby") {
-			optional<string> base;
-			optional<string> annotation;
-			optional<float> size;
-			optional<RubyPosition> position;
-			optional<float> offset;
-			optional<float> spacing;
-			optional<float> aspect_adjust;
-			for (auto ruby_child: element->get_children()) {
-				if (auto ruby_element = dynamic_cast<xmlpp::Element const*>(ruby_child)) {
-					if (ruby_element->get_name() == "Rb") {
-						base = get_text_content(ruby_element);
-					} else if (ruby_element->get_name() == "Rt") {
-						annotation = get_text_content(ruby_element);
-						size = optional_number_attribute<float>(ruby_element, "Size");
-						if (auto position_string = optional_string_attribute(ruby_element, "Position")) {
-							if (*position_string == "before") {
-								position = RubyPosition::BEFORE;
-							} else if (*position_string == "after") {
-								position = RubyPosition::AFTER;
-							} else {
-								DCP_ASSERT(false);
-							}
-						}
-						offset = optional_number_attribute<float>(ruby_element, "Offset");
-						spacing = optional_number_attribute<float>(ruby_element, "Spacing");
-						aspect_adjust = optional_number_attribute<float>(ruby_element, "AspectAdjust");
-					}
-				}
-			}
-			DCP_ASSERT(base);
-			DCP_ASSERT(annotation);
-			auto ruby = Ruby{*base, *annotation};
-			if (size) {
-				ruby.size = *size;
-			}
-			if (position) {
-				ruby.position = *position;
-			}
-			if (offset) {
-				ruby.offset = *offset;
-			}
-			if (spacing) {
-				ruby.spacing = *spacing;
-			}
-			if (aspect_adjust) {
-				ruby.aspect_adjust = *aspect_adjust;
-			}
-			rubies.push_back(ruby);
-		}
 	}
 
-	for (auto i: node->get_children()) {
-
-		/* Handle actual content e.g. text */
-		auto const v = dynamic_cast<xmlpp::ContentNode const *>(i);
-		if (v) {
-			maybe_add_text(v->get_content(), state, space_before, standard, rubies);
-			space_before = 0;
-		}
-
-		/* Handle other nodes */
-		auto const e = dynamic_cast<xmlpp::Element const *>(i);
-		if (e) {
-			if (e->get_name() == "Space") {
-				if (node->get_name() != "Text") {
-					throw XMLError ("Space node found outside Text");
-				}
-				auto size = optional_string_attribute(e, "Size").get_value_or("0.5");
-				if (standard == dcp::Standard::INTEROP) {
-					boost::replace_all(size, "em", "");
-				}
-				space_before += raw_convert<float>(size);
-			} else if (e->get_name() != "Ruby") {
-				parse_texts (e, state, tcr, standard);
-			}
-		}
+	if (hi - lo == 1) {
+		result.push_back(by_in[lo]);
+		return;
 	}
 
-	DCP_ASSERT(!state.empty());
-	state.pop_back ();
+	auto const mid = (lo + hi) / 2;
+	find_latest_out(by_in, latest_out, node * 2 + 1, lo, mid, end, from, result);
+	find_latest_out(by_in, latest_out, node * 2 + 2, mid, hi, end, from, result);
 }
 
 
-void
-TextAsset::maybe_add_text(
-	string text,
-	vector<ParseState> const & parse_state,
-	float space_before,
-	Standard standard,
-	vector<Ruby> const& rubies
-	)
+shared_ptr<const TextAsset::TextsIndex>
+TextAsset::texts_index() const
 {
-	auto wanted = [](ParseState const& ps) {
-		return ps.type && (ps.type.get() == ParseState::Type::TEXT || ps.type.get() == ParseState::Type::IMAGE);
-	};
+	std::lock_guard<std::mutex> lm(_texts_index_mutex);
 
-	if (find_if(parse_state.begin(), parse_state.end(), wanted) == parse_state.end()) {
-		return;
-	}
-
-	ParseState ps;
-	for (auto const& i: parse_state) {
-		if (i.font_id) {
-			ps.font_id = i.font_id.get();
-		}
-		if (i.size) {
-			ps.size = i.size.get();
-		}
-		if (i.aspect_adjust) {
-			ps.aspect_adjust = i.aspect_adjust.get();
-		}
-		if (i.italic) {
-			ps.italic = i.italic.get();
-		}
-		if (i.bold) {
-			ps.bold = i.bold.get();
-		}
-		if (i.underline) {
-			ps.underline = i.underline.get();
-		}
-		if (i.colour) {
-			ps.colour = i.colour.get();
-		}
-		if (i.effect) {
-			ps.effect = i.effect.get();
-		}
-		if (i.effect_colour) {
-			ps.effect_colour = i.effect_colour.get();
-		}
-		if (i.h_position) {
-			ps.h_position = i.h_position.get();
-		}
-		if (i.h_align) {
-			ps.h_align = i.h_align.get();
-		}
-		if (i.v_position) {
-			ps.v_position = i.v_position.get();
-		}
-		if (i.v_align) {
-			ps.v_align = i.v_align.get();
-		}
-		if (i.z_position) {
-			ps.z_position = i.z_position.get();
-		}
-		if (i.variable_z) {
-			ps.variable_z = i.variable_z.get();
-		}
-		if (i.direction) {
-			ps.direction = i.direction.get();
-		}
-		if (i.in) {
-			ps.in = i.in.get();
+	if (!_texts_index) {
+		auto index = make_shared<TextsIndex>();
+		index->by_in.resize(_texts.size());
+		for (size_t i = 0; i < _texts.size(); ++i) {
+			index->by_in[i] = i;
 		}
-		if (i.out) {
-			ps.out = i.out.get();
-		}
-		if (i.fade_up_time) {
-			ps.fade_up_time = i.fade_up_time.get();
-		}
-		if (i.fade_down_time) {
-			ps.fade_down_time = i.fade_down_time.get();
-		}
-		if (i.type) {
-			ps.type = i.type.get();
-		}
-		for (auto j: i.load_variable_z) {
-			/* j is a LoadVariableZ from this "sub" ParseState. See if we should add it to the end result */
-			auto const k = std::find_if(ps.load_variable_z.begin(), ps.load_variable_z.end(), [j](LoadVariableZ const& z) { return j.id() == z.id(); });
-			if (k == ps.load_variable_z.end()) {
-				ps.load_variable_z.push_back(j);
-			}
-		}
-	}
-
-	if (!ps.in || !ps.out) {
-		/* We're not in a <Subtitle> node; just ignore this content */
-		return;
-	}
+		std::stable_sort(index->by_in.begin(), index->by_in.end(), [this](size_t a, size_t b) {
+			return _texts[a]->in() < _texts[b]->in();
+		});
 
-	DCP_ASSERT (ps.type);
-
-	switch (ps.type.get()) {
-	case ParseState::Type::TEXT:
-	{
-		vector<Text::VariableZPosition> variable_z;
-		auto iter = std::find_if(ps.load_variable_z.begin(), ps.load_variable_z.end(), [&ps](LoadVariableZ const& z) { return z.id() == ps.variable_z; });
-		if (iter != ps.load_variable_z.end()) {
-			variable_z = iter->positions();
-		}
-		_texts.push_back (
-			make_shared<TextString>(
-				ps.font_id,
-				ps.italic.get_value_or (false),
-				ps.bold.get_value_or (false),
-				ps.underline.get_value_or (false),
-				ps.colour.get_value_or (dcp::Colour (255, 255, 255)),
-				ps.size.get_value_or (42),
-				ps.aspect_adjust.get_value_or (1.0),
-				ps.in.get(),
-				ps.out.get(),
-				ps.h_position.get_value_or(0),
-				ps.h_align.get_value_or(HAlign::CENTER),
-				ps.v_position.get_value_or(0),
-				ps.v_align.get_value_or(VAlign::CENTER),
-				ps.z_position.get_value_or(0),
-				variable_z,
-				ps.direction.get_value_or (Direction::LTR),
-				text,
-				ps.effect.get_value_or (Effect::NONE),
-				ps.effect_colour.get_value_or (dcp::Colour (0, 0, 0)),
-				ps.fade_up_time.get_value_or(Time()),
-				ps.fade_down_time.get_value_or(Time()),
-				space_before,
-				rubies
-				)
-			);
-		break;
-	}
-	case ParseState::Type::IMAGE:
-	{
-		switch (standard) {
-		case Standard::INTEROP:
-			if (text.size() >= 4) {
-				/* Remove file extension */
-				text = text.substr(0, text.size() - 4);
-			}
-			break;
-		case Standard::SMPTE:
-			/* It looks like this urn:uuid: is required, but DoM wasn't expecting it (and not writing it)
-			 * until around 2.15.140 so I guess either:
-			 *   a) it is not (always) used in the field, or
-			 *   b) nobody noticed / complained.
-			 */
-			if (text.substr(0, 9) == "urn:uuid:") {
-				text = text.substr(9);
-			}
-			break;
-		}
-
-		vector<Text::VariableZPosition> variable_z;
-		auto iter = std::find_if(ps.load_variable_z.begin(), ps.load_variable_z.end(), [&ps](LoadVariableZ const& z) { return ps.variable_z && z.id() == *ps.variable_z; });
-		if (iter != ps.load_variable_z.end()) {
-			variable_z = iter->positions();
+		if (!_texts.empty()) {
+			index->latest_out.resize(_texts.size() * 4);
+			build_latest_out(_texts, index->by_in, index->latest_out, 0, 0, _texts.size());
 		}
 
-		/* Add a text with no image data and we'll fill that in later */
-		_texts.push_back(
-			make_shared<TextImage>(
-				ArrayData(),
-				text,
-				ps.in.get(),
-				ps.out.get(),
-				ps.h_position.get_value_or(0),
-				ps.h_align.get_value_or(HAlign::CENTER),
-				ps.v_position.get_value_or(0),
-				ps.v_align.get_value_or(VAlign::CENTER),
-				ps.z_position.get_value_or(0),
-				variable_z,
-				ps.fade_up_time.get_value_or(Time()),
-				ps.fade_down_time.get_value_or(Time())
-				)
-			);
-
-		_image_texts++;
-		break;
-	}
+		_texts_index = index;
 	}
+
+	return _texts_index;
 }
 
 
 vector<shared_ptr<const Text>>
-TextAsset::texts() const
+TextAsset::texts_during(Time from, Time to, bool starting) const
 {
-	vector<shared_ptr<const Text>> s;
-	for (auto i: _texts) {
-		s.push_back (i);
+	auto index = texts_index();
+	auto const& by_in = index->by_in;
+
+	vector<size_t> found;
+
+	if (starting) {
+		/* Texts with from <= in < to */
+		auto i = std::lower_bound(by_in.begin(), by_in.end(), from, [this](size_t a, Time const& t) {
+			return _texts[a]->in() < t;
+		});
+		while (i != by_in.end() && _texts[*i]->in() < to) {
+			found.push_back(*i);
+			++i;
+		}
+	} else if (!by_in.empty()) {
+		/* Texts with in <= to and out >= from */
+		auto const end = std::upper_bound(by_in.begin(), by_in.end(), to, [this](Time const& t, size_t a) {
+			return t < _texts[a]->in();
+		});
+		find_latest_out(by_in, index->latest_out, 0, 0, by_in.size(), end - by_in.begin(), from, found);
 	}
-	return s;
-}
 
+	/* Give the results in the same order as _texts, as we always have */
+	std::sort(found.begin(), found.end());
 
-vector<shared_ptr<const Text>>
-TextAsset::texts_during(Time from, Time to, bool starting) const
-{
 	vector<shared_ptr<const Text>> s;
-	for (auto i: _texts) {
-		if ((starting && from <= i->in() && i->in() < to) || (!starting && i->out() >= from && i->in() <= to)) {
-			s.push_back (i);
-		}
+	for (auto i: found) {
+		s.push_back(_texts[i]);
 	}
 
 	return s;
@@ -625,6 +260,7 @@ TextAsset::add(shared_ptr<Text> s)
 	if (dynamic_pointer_cast<TextImage>(s)) {
 		_image_texts++;
 	}
+	texts_changed();
 }
 
 
@@ -850,7 +486,6 @@ TextAsset::texts_as_xml(xmlpp::Element* xml_root, int time_code_rate, Standard s
 			subtitle->children.push_back (
 				make_shared<order::Image>(
 					subtitle, ii->id(),
-					ii->png_image(),
 					ii->h_align(),
 					ii->h_position(),
 					ii->v_align(),
@@ -882,7 +517,7 @@ TextAsset::font_data() const
 {
 	map<string, ArrayData> out;
 	for (auto const& i: _fonts) {
-		out[i.load_id] = i.data;
+		out[i.load_id] = i.data.get();
 	}
 	return out;
 }
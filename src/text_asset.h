@@ -44,12 +44,15 @@
 #include "array_data.h"
 #include "asset.h"
 #include "dcp_time.h"
+#include "lazy_data.h"
 #include "load_variable_z.h"
 #include "subtitle_standard.h"
 #include "text_string.h"
 #include <libcxml/cxml.h>
 #include <boost/shared_array.hpp>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -77,6 +80,7 @@ class ReelAsset;
 class SubtitleNode;
 class TextImage;
 class TextNode;
+class TextParser;
 class TextString;
 
 
@@ -106,9 +110,14 @@ public:
 		NoteHandler note
 		) const override;
 
+	/** @param starting true to return texts which start in [from, to), false to return texts which
+	 *  are on screen at any time in [from, to]
+	 *  @return texts in the same order as texts()
+	 */
 	std::vector<std::shared_ptr<const Text>> texts_during(Time from, Time to, bool starting) const;
 	std::vector<std::shared_ptr<const Text>> texts() const;
 
+	/** Add a text.  Its in and out times must not be changed after it has been added */
 	virtual void add(std::shared_ptr<Text>);
 	virtual void add_font (std::string id, dcp::ArrayData data) = 0;
 	void ensure_font(std::string id, dcp::ArrayData data);
@@ -138,75 +147,108 @@ public:
 
 	static std::string format_xml(xmlpp::Document const& document, boost::optional<std::pair<std::string, std::string>> xml_namespace);
 
-protected:
-	friend struct ::interop_dcp_font_test;
-	friend struct ::smpte_dcp_font_test;
+	/** Details of an asset's XML which the verifier needs, gathered while the XML is parsed
+	 *  so that it does not need to be read again.
+	 */
+	struct XMLSummary
+	{
+		/** A <Text> which is not inside another <Text> */
+		struct TextElement
+		{
+			/** VAlign (or Valign) attribute, if there is one */
+			boost::optional<std::string> v_align;
+			/** VPosition (or Vposition) attribute, if there is one */
+			boost::optional<float> v_position;
+		};
 
-	struct ParseState {
-		boost::optional<std::string> font_id;
-		boost::optional<int64_t> size;
-		boost::optional<float> aspect_adjust;
-		boost::optional<bool> italic;
-		boost::optional<bool> bold;
-		boost::optional<bool> underline;
-		boost::optional<Colour> colour;
-		boost::optional<Effect> effect;
-		boost::optional<Colour> effect_colour;
-		boost::optional<float> h_position;
-		boost::optional<HAlign> h_align;
-		boost::optional<float> v_position;
-		boost::optional<VAlign> v_align;
-		boost::optional<float> z_position;
-		boost::optional<std::string> variable_z;
-		boost::optional<Direction> direction;
-		boost::optional<Time> in;
-		boost::optional<Time> out;
-		boost::optional<Time> fade_up_time;
-		boost::optional<Time> fade_down_time;
-		enum class Type {
-			TEXT,
-			IMAGE
+		struct Subtitle
+		{
+			/** TimeIn, without any StartTime removed */
+			Time in;
+			/** TimeOut, without any StartTime removed */
+			Time out;
+			/** <Text>s inside this <Subtitle>, in document order */
+			std::vector<TextElement> texts;
 		};
-		boost::optional<Type> type;
-		float space_before = 0;
 
-		std::vector<LoadVariableZ> load_variable_z;
+		/** Every <Subtitle>, in document order */
+		std::vector<Subtitle> subtitles;
+		/** Id (or ID) attributes of <LoadFont>s, in document order */
+		std::vector<std::string> load_font_ids;
+		/** Id attributes of <Font>s, in document order */
+		std::vector<std::string> font_ids;
+		/** true if there is at least one <Text> */
+		bool has_text = false;
+		/** true if there is at least one <Text> without any content */
+		bool empty_text = false;
+		/** Number of namespaces declared on the root node */
+		int root_namespaces = 0;
+		/** Content of <TimeCodeRate>, for SMPTE */
+		boost::optional<int> time_code_rate;
+		/** Content of <StartTime>, for SMPTE */
+		boost::optional<Time> start_time;
+		/** Content of <IssueDate>, for SMPTE */
+		boost::optional<std::string> issue_date;
 	};
 
-	void parse_texts(xmlpp::Element const * node, std::vector<ParseState>& state, boost::optional<int> tcr, Standard standard);
-	ParseState font_node_state (xmlpp::Element const * node, Standard standard) const;
-	ParseState text_node_state (xmlpp::Element const * node) const;
-	ParseState image_node_state (xmlpp::Element const * node) const;
-	ParseState subtitle_node_state (xmlpp::Element const * node, boost::optional<int> tcr) const;
-	Time fade_time (xmlpp::Element const * node, std::string name, boost::optional<int> tcr) const;
-	void position_align (ParseState& ps, xmlpp::Element const * node) const;
+	/** @return Summary of raw_xml(), or nullptr if there is no raw XML */
+	std::shared_ptr<const XMLSummary> xml_summary() const;
+
+protected:
+	friend struct ::interop_dcp_font_test;
+	friend struct ::smpte_dcp_font_test;
 
 	void texts_as_xml(xmlpp::Element* root, int time_code_rate, Standard standard) const;
 
-	/** All our texts, in no particular order */
+	/** All our texts, in no particular order.  Anything which changes this must call texts_changed() */
 	std::vector<std::shared_ptr<Text>> _texts;
+
+	void texts_changed();
 	std::vector<LoadVariableZ> _load_variable_z;
 	int _image_texts = 0;
 
+	/** An index of _texts for texts_during(): the indices of _texts sorted by in time, and an implicit
+	 *  binary tree over that order where each node holds the latest out time of the texts below it.
+	 */
+	struct TextsIndex
+	{
+		std::vector<size_t> by_in;
+		std::vector<Time> latest_out;
+	};
+
+	std::shared_ptr<const TextsIndex> texts_index() const;
+
+	mutable std::mutex _texts_index_mutex;
+	/** Index of _texts, or nullptr if it has not been built since _texts last changed */
+	mutable std::shared_ptr<const TextsIndex> _texts_index;
+
 	class Font
 	{
 	public:
-		Font (std::string load_id_, std::string uuid_, boost::filesystem::path file_)
+		/** Make a Font by reading data from file_ now or, if lazy is true, the first time it is needed */
+		Font (std::string load_id_, std::string uuid_, boost::filesystem::path file_, bool lazy = false)
 			: load_id (load_id_)
 			, uuid (uuid_)
-			, data (file_)
+			, data(lazy ? LazyData([file_]() { return ArrayData(file_); }, true) : LazyData(ArrayData(file_), true))
 			, file (file_)
 		{}
 
 		Font (std::string load_id_, std::string uuid_, ArrayData data_)
 			: load_id (load_id_)
 			, uuid (uuid_)
-			, data (data_)
+			, data(data_, true)
+		{}
+
+		Font(std::string load_id_, std::string uuid_, LazyData data_)
+			: load_id(load_id_)
+			, uuid(uuid_)
+			, data(data_)
 		{}
 
 		std::string load_id;
 		std::string uuid;
-		ArrayData data;
+		/** Font data; identical data in different fonts (perhaps in different assets) share storage */
+		LazyData data;
 		/** .ttf file that this data was last written to, if applicable */
 		mutable boost::optional<boost::filesystem::path> file;
 	};
@@ -214,22 +256,24 @@ protected:
 	/** TTF font data that we need */
 	std::vector<Font> _fonts;
 
+	/** Parse _raw_xml, adding the texts that are found and keeping the summary */
+	void parse_raw_xml(TextParser& parser, std::string root_name);
+
+	/** Set _raw_xml to some XML that we have written */
+	void set_raw_xml(std::string xml) const;
+
 	/** The raw XML data that we read from or wrote to our asset; useful for validation */
 	mutable boost::optional<std::string> _raw_xml;
 
+	mutable std::mutex _xml_summary_mutex;
+	/** Summary of _raw_xml, or nullptr if it has not yet been made */
+	mutable std::shared_ptr<const XMLSummary> _xml_summary;
+
 private:
 	friend struct ::pull_fonts_test1;
 	friend struct ::pull_fonts_test2;
 	friend struct ::pull_fonts_test3;
 
-	void maybe_add_text(
-		std::string text,
-		std::vector<ParseState> const & parse_state,
-		float space_before,
-		Standard standard,
-		std::vector<Ruby> const& rubies
-		);
-
 	static void pull_fonts (std::shared_ptr<order::Part> part);
 };
 
@@ -217,7 +217,6 @@ public:
 	Image(
 		std::shared_ptr<Part> parent,
 		std::string id,
-		ArrayData png_data,
 		HAlign h_align,
 		float h_position,
 		VAlign v_align,
@@ -226,7 +225,6 @@ public:
 		boost::optional<std::string> variable_z
 	     )
 		: Part (parent)
-		, _png_data (png_data)
 		, _id (id)
 		, _h_align (h_align)
 		, _h_position (h_position)
@@ -239,7 +237,6 @@ public:
 	xmlpp::Element* as_xml (xmlpp::Element* parent, Context& context) const override;
 
 private:
-	ArrayData _png_data;
 	std::string _id; ///< the ID of this image
 	HAlign _h_align;
 	float _h_position;
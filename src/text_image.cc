@@ -99,7 +99,15 @@ void
 TextImage::read_png_file(boost::filesystem::path file)
 {
 	_file = file;
-	_png_image = ArrayData (file);
+	_png_image = LazyData(ArrayData(file));
+}
+
+
+void
+TextImage::set_png_file(boost::filesystem::path file)
+{
+	_file = file;
+	_png_image = LazyData([file]() { return ArrayData(file); });
 }
 
 
@@ -42,8 +42,9 @@
 
 
 #include "array_data.h"
-#include "text.h"
 #include "dcp_time.h"
+#include "lazy_data.h"
+#include "text.h"
 #include <boost/optional.hpp>
 #include <string>
 
@@ -86,15 +87,28 @@ public:
 		Time fade_down_time
 		);
 
+	/** @return our PNG data, fetching it first if it has been left to be fetched when needed */
 	ArrayData png_image () const {
-		return _png_image;
+		return _png_image.get();
+	}
+
+	/** @return true if we have some PNG data, or a way to fetch it */
+	bool has_png_image() const {
+		return !_png_image.empty();
 	}
 
 	void set_png_image (ArrayData png) {
+		_png_image = LazyData(png);
+	}
+
+	/** Set up PNG data to be fetched the first time it is needed */
+	void set_png_image(LazyData png) {
 		_png_image = png;
 	}
 
 	void read_png_file (boost::filesystem::path file);
+	/** Set up our PNG data to be read from a file the first time it is needed */
+	void set_png_file(boost::filesystem::path file);
 	void write_png_file (boost::filesystem::path file) const;
 
 	std::string id () const {
@@ -109,7 +123,7 @@ public:
 	bool equals(std::shared_ptr<const dcp::Text> other_text, EqualityOptions const& options, NoteHandler note) const override;
 
 private:
-	ArrayData _png_image;
+	LazyData _png_image;
 	std::string _id;
 	mutable boost::optional<boost::filesystem::path> _file;
 };
@@ -0,0 +1,896 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/text_parser.cc
+ *  @brief TextParser class
+ */
+
+
+#include "compose.hpp"
+#include "dcp_assert.h"
+#include "exceptions.h"
+#include "raw_convert.h"
+#include "scope_guard.h"
+#include "text_image.h"
+#include "text_parser.h"
+#include "text_string.h"
+#include "warnings.h"
+LIBDCP_DISABLE_WARNINGS
+#include <libxml/xmlreader.h>
+LIBDCP_ENABLE_WARNINGS
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+
+
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using boost::lexical_cast;
+using boost::optional;
+using namespace dcp;
+
+
+static
+string
+to_string(xmlChar const* s)
+{
+	return s ? string(reinterpret_cast<char const*>(s)) : string();
+}
+
+
+optional<string>
+TextParser::Attributes::optional_string_attribute(string name) const
+{
+	for (auto const& i: _attributes) {
+		if (i.first == name) {
+			return i.second;
+		}
+	}
+
+	return {};
+}
+
+
+string
+TextParser::Attributes::string_attribute(std::string name) const
+{
+	auto value = optional_string_attribute(name);
+	if (!value) {
+		throw XMLError(String::compose("missing attribute %1", name));
+	}
+	return *value;
+}
+
+
+optional<bool>
+TextParser::Attributes::optional_bool_attribute(std::string name) const
+{
+	auto s = optional_string_attribute(name);
+	if (!s) {
+		return {};
+	}
+
+	return (s.get() == "1" || s.get() == "yes");
+}
+
+
+template <class T>
+optional<T>
+TextParser::Attributes::optional_number_attribute(std::string name) const
+{
+	auto s = optional_string_attribute(name);
+	if (!s) {
+		return {};
+	}
+
+	auto t = s.get();
+	boost::erase_all(t, " ");
+	return raw_convert<T>(t);
+}
+
+
+TextParser::TextParser(Standard standard)
+	: _standard(standard)
+{
+
+}
+
+
+void
+TextParser::parse(string const& xml, string root_name, std::function<void (shared_ptr<Text>)> add)
+{
+	_add = add;
+	_seen_root = false;
+	_namespace_uri.clear();
+	_children.clear();
+	_tcr = boost::none;
+	_elements.clear();
+	_state.clear();
+	_subtitle.reset();
+	_summary = make_shared<TextAsset::XMLSummary>();
+	_open_texts.clear();
+	_open_subtitles.clear();
+
+	auto reader = xmlReaderForMemory(xml.c_str(), static_cast<int>(xml.size()), nullptr, nullptr, XML_PARSE_NONET);
+	if (!reader) {
+		throw XMLError("could not create XML reader");
+	}
+
+	ScopeGuard sg = [reader]() {
+		xmlFreeTextReader(reader);
+	};
+
+	int r = 0;
+	while ((r = xmlTextReaderRead(reader)) == 1) {
+		switch (xmlTextReaderNodeType(reader)) {
+		case XML_READER_TYPE_ELEMENT:
+		{
+			auto const name = to_string(xmlTextReaderConstLocalName(reader));
+			auto const empty = xmlTextReaderIsEmptyElement(reader) == 1;
+
+			if (!_seen_root) {
+				if (name != root_name) {
+					throw XMLError(String::compose("unexpected root node %1 (expecting %2)", name, root_name));
+				}
+				_namespace_uri = to_string(xmlTextReaderConstNamespaceUri(reader));
+				_seen_root = true;
+			}
+
+			Attributes attributes;
+			int namespaces = 0;
+			while (xmlTextReaderMoveToNextAttribute(reader) == 1) {
+				if (xmlTextReaderIsNamespaceDecl(reader) == 1) {
+					++namespaces;
+				} else {
+					attributes.add(to_string(xmlTextReaderConstLocalName(reader)), to_string(xmlTextReaderConstValue(reader)));
+				}
+			}
+			xmlTextReaderMoveToElement(reader);
+
+			start_element(name, attributes, namespaces);
+			if (empty) {
+				end_element();
+			}
+			break;
+		}
+		case XML_READER_TYPE_END_ELEMENT:
+			end_element();
+			break;
+		case XML_READER_TYPE_TEXT:
+		case XML_READER_TYPE_CDATA:
+		case XML_READER_TYPE_WHITESPACE:
+		case XML_READER_TYPE_SIGNIFICANT_WHITESPACE:
+			content(to_string(xmlTextReaderConstValue(reader)));
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (r != 0) {
+		string message = "could not parse XML";
+		if (auto error = xmlGetLastError()) {
+			if (error->message) {
+				message += ": " + boost::trim_copy(string(error->message));
+			}
+		}
+		throw XMLError(message);
+	}
+
+	if (!_seen_root) {
+		throw XMLError(String::compose("no %1 node found", root_name));
+	}
+
+	if (_standard == Standard::SMPTE) {
+		if (auto tcr = optional_string_child("TimeCodeRate")) {
+			auto t = *tcr;
+			boost::erase_all(t, " ");
+			_summary->time_code_rate = raw_convert<int>(t);
+		}
+		if (auto start_time = optional_string_child("StartTime")) {
+			_summary->start_time = Time(*start_time, _summary->time_code_rate);
+		}
+		_summary->issue_date = optional_string_child("IssueDate");
+	}
+
+	_add = {};
+}
+
+
+optional<string>
+TextParser::optional_string_child(string name) const
+{
+	auto iter = std::find_if(_children.begin(), _children.end(), [name](Child const& child) { return child.name == name; });
+	if (iter == _children.end()) {
+		return {};
+	}
+
+	return iter->content;
+}
+
+
+string
+TextParser::string_child(string name) const
+{
+	auto child = optional_string_child(name);
+	if (!child) {
+		throw XMLError(String::compose("missing XML tag %1", name));
+	}
+	return *child;
+}
+
+
+vector<TextParser::Child>
+TextParser::children(string name) const
+{
+	vector<Child> found;
+	std::copy_if(_children.begin(), _children.end(), std::back_inserter(found), [name](Child const& child) { return child.name == name; });
+	return found;
+}
+
+
+void
+TextParser::start_element(string name, Attributes const& attributes, int namespaces)
+{
+	summarise_start(name, attributes);
+
+	if (_elements.empty()) {
+		_summary->root_namespaces = namespaces;
+		_elements.push_back({name, Role::ROOT});
+		return;
+	}
+
+	switch (_elements.back().role) {
+	case Role::ROOT:
+		if (
+			(_standard == Standard::SMPTE && name == "SubtitleList") ||
+			(_standard == Standard::INTEROP && (name == "Font" || name == "Subtitle"))
+		   ) {
+			if (_standard == Standard::SMPTE && !_tcr) {
+				auto tcr = string_child("TimeCodeRate");
+				boost::erase_all(tcr, " ");
+				_tcr = raw_convert<int>(tcr);
+			}
+			start_body_element(name, attributes);
+		} else {
+			_children.push_back({name, attributes, {}});
+			_elements.push_back({name, Role::CHILD});
+		}
+		break;
+	case Role::OUTSIDE_SUBTITLE:
+	case Role::IN_SUBTITLE:
+		start_body_element(name, attributes);
+		break;
+	case Role::RUBY:
+		if (name == "Rb") {
+			_element_content.clear();
+			_elements.push_back({name, Role::RUBY_BASE});
+		} else if (name == "Rt") {
+			_element_content.clear();
+			_ruby.size = attributes.optional_number_attribute<float>("Size");
+			if (auto position = attributes.optional_string_attribute("Position")) {
+				if (*position == "before") {
+					_ruby.position = RubyPosition::BEFORE;
+				} else if (*position == "after") {
+					_ruby.position = RubyPosition::AFTER;
+				} else {
+					DCP_ASSERT(false);
+				}
+			}
+			_ruby.offset = attributes.optional_number_attribute<float>("Offset");
+			_ruby.spacing = attributes.optional_number_attribute<float>("Spacing");
+			_ruby.aspect_adjust = attributes.optional_number_attribute<float>("AspectAdjust");
+			_elements.push_back({name, Role::RUBY_ANNOTATION});
+		} else {
+			_elements.push_back({name, Role::IGNORE});
+		}
+		break;
+	default:
+		_elements.push_back({name, Role::IGNORE});
+		break;
+	}
+}
+
+
+/** Start an element which is part of the subtitle list */
+void
+TextParser::start_body_element(string const& name, Attributes const& attributes)
+{
+	auto const parent = _elements.back();
+
+	if (name == "LoadVariableZ") {
+		_element_content.clear();
+		_load_variable_z_id = attributes.optional_string_attribute("ID");
+		_elements.push_back({name, Role::LOAD_VARIABLE_Z, parent.node});
+		return;
+	} else if (name == "Ruby") {
+		_ruby = RubyParts();
+		_elements.push_back({name, Role::RUBY, parent.node});
+		return;
+	} else if (name == "Space") {
+		if (parent.name != "Text") {
+			throw XMLError("Space node found outside Text");
+		}
+		auto size = attributes.optional_string_attribute("Size").get_value_or("0.5");
+		if (_standard == dcp::Standard::INTEROP) {
+			boost::replace_all(size, "em", "");
+		}
+		auto const space = raw_convert<float>(size);
+		if (parent.node) {
+			parent.node->space_before += space;
+		}
+		_elements.push_back({name, Role::IGNORE});
+		return;
+	}
+
+	ParseState state;
+	if (name == "Font") {
+		state = font_node_state(attributes);
+	} else if (name == "Subtitle") {
+		state = subtitle_node_state(attributes);
+	} else if (name == "Text") {
+		state = text_node_state(attributes);
+	} else if (name == "Image") {
+		state = image_node_state(attributes);
+	} else if (name != "SubtitleList") {
+		throw XMLError("unexpected node " + name);
+	}
+
+	if (parent.node || name == "Subtitle") {
+		unique_ptr<Node> node(new Node);
+		node->state = std::move(state);
+		auto raw = node.get();
+		if (parent.node) {
+			Node::Item item;
+			item.child = std::move(node);
+			parent.node->items.push_back(std::move(item));
+		} else {
+			_subtitle = std::move(node);
+		}
+		_elements.push_back({name, Role::IN_SUBTITLE, raw});
+	} else {
+		_state.push_back(std::move(state));
+		_elements.push_back({name, Role::OUTSIDE_SUBTITLE});
+	}
+}
+
+
+void
+TextParser::end_element()
+{
+	DCP_ASSERT(!_elements.empty());
+	auto const element = _elements.back();
+	_elements.pop_back();
+
+	summarise_end(element.name);
+
+	switch (element.role) {
+	case Role::OUTSIDE_SUBTITLE:
+		DCP_ASSERT(!_state.empty());
+		_state.pop_back();
+		break;
+	case Role::IN_SUBTITLE:
+		if (!_elements.back().node) {
+			/* This is the end of the outermost <Subtitle> so now we know everything about it */
+			DCP_ASSERT(_subtitle);
+			add_texts(*_subtitle);
+			_subtitle.reset();
+		}
+		break;
+	case Role::RUBY:
+	{
+		DCP_ASSERT(_ruby.base);
+		DCP_ASSERT(_ruby.annotation);
+		auto ruby = Ruby{*_ruby.base, *_ruby.annotation};
+		if (_ruby.size) {
+			ruby.size = *_ruby.size;
+		}
+		if (_ruby.position) {
+			ruby.position = *_ruby.position;
+		}
+		if (_ruby.offset) {
+			ruby.offset = *_ruby.offset;
+		}
+		if (_ruby.spacing) {
+			ruby.spacing = *_ruby.spacing;
+		}
+		if (_ruby.aspect_adjust) {
+			ruby.aspect_adjust = *_ruby.aspect_adjust;
+		}
+		if (element.node) {
+			element.node->rubies.push_back(ruby);
+		}
+		break;
+	}
+	case Role::RUBY_BASE:
+		_ruby.base = _element_content;
+		break;
+	case Role::RUBY_ANNOTATION:
+		_ruby.annotation = _element_content;
+		break;
+	case Role::LOAD_VARIABLE_Z:
+		/* Only <LoadVariableZ>s directly inside <Subtitle>s are used */
+		if (element.node && _elements.back().name == "Subtitle") {
+			if (!_load_variable_z_id) {
+				throw XMLError("missing attribute ID");
+			}
+			element.node->state.load_variable_z.push_back(LoadVariableZ(*_load_variable_z_id, _element_content));
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+
+void
+TextParser::content(string text)
+{
+	if (!text.empty()) {
+		std::fill(_open_texts.begin(), _open_texts.end(), true);
+	}
+
+	if (_elements.empty()) {
+		return;
+	}
+
+	auto& element = _elements.back();
+	switch (element.role) {
+	case Role::CHILD:
+		_children.back().content += text;
+		break;
+	case Role::IN_SUBTITLE:
+	{
+		Node::Item item;
+		item.content = text;
+		item.space_before = element.node->space_before;
+		element.node->space_before = 0;
+		element.node->items.push_back(std::move(item));
+		break;
+	}
+	case Role::RUBY_BASE:
+	case Role::RUBY_ANNOTATION:
+	case Role::LOAD_VARIABLE_Z:
+		_element_content += text;
+		break;
+	default:
+		/* Content outside a <Subtitle> can never make a text */
+		break;
+	}
+}
+
+
+void
+TextParser::summarise_start(string const& name, Attributes const& attributes)
+{
+	if (name == "Subtitle") {
+		TextAsset::XMLSummary::Subtitle subtitle;
+		subtitle.in = Time(attributes.string_attribute("TimeIn"), _tcr);
+		subtitle.out = Time(attributes.string_attribute("TimeOut"), _tcr);
+		_open_subtitles.push_back(_summary->subtitles.size());
+		_summary->subtitles.push_back(subtitle);
+	} else if (name == "Text") {
+		_summary->has_text = true;
+		if (_open_texts.empty() && !_open_subtitles.empty()) {
+			TextAsset::XMLSummary::TextElement text;
+			text.v_align = attributes.optional_string_attribute("VAlign");
+			if (!text.v_align) {
+				text.v_align = attributes.optional_string_attribute("Valign");
+			}
+			text.v_position = attributes.optional_number_attribute<float>("VPosition");
+			if (!text.v_position) {
+				text.v_position = attributes.optional_number_attribute<float>("Vposition");
+			}
+			_summary->subtitles[_open_subtitles.back()].texts.push_back(text);
+		}
+		_open_texts.push_back(false);
+	} else if (name == "LoadFont") {
+		if (auto id = attributes.optional_string_attribute("Id")) {
+			_summary->load_font_ids.push_back(*id);
+		} else if (auto id = attributes.optional_string_attribute("ID")) {
+			_summary->load_font_ids.push_back(*id);
+		}
+	} else if (name == "Font") {
+		if (auto id = attributes.optional_string_attribute("Id")) {
+			_summary->font_ids.push_back(*id);
+		}
+	}
+}
+
+
+void
+TextParser::summarise_end(string const& name)
+{
+	if (name == "Subtitle") {
+		DCP_ASSERT(!_open_subtitles.empty());
+		_open_subtitles.pop_back();
+	} else if (name == "Text") {
+		DCP_ASSERT(!_open_texts.empty());
+		if (!_open_texts.back()) {
+			_summary->empty_text = true;
+		}
+		_open_texts.pop_back();
+	}
+}
+
+
+TextParser::ParseState
+TextParser::font_node_state(Attributes const& attributes) const
+{
+	ParseState ps;
+
+	if (_standard == Standard::INTEROP) {
+		ps.font_id = attributes.optional_string_attribute("Id");
+	} else {
+		ps.font_id = attributes.optional_string_attribute("ID");
+	}
+	ps.size = attributes.optional_number_attribute<int64_t>("Size");
+	ps.aspect_adjust = attributes.optional_number_attribute<float>("AspectAdjust");
+	ps.italic = attributes.optional_bool_attribute("Italic");
+	ps.bold = attributes.optional_string_attribute("Weight").get_value_or("normal") == "bold";
+	if (_standard == Standard::INTEROP) {
+		ps.underline = attributes.optional_bool_attribute("Underlined");
+	} else {
+		ps.underline = attributes.optional_bool_attribute("Underline");
+	}
+	auto c = attributes.optional_string_attribute("Color");
+	if (c) {
+		ps.colour = Colour(c.get());
+	}
+	auto const e = attributes.optional_string_attribute("Effect");
+	if (e) {
+		ps.effect = string_to_effect(e.get());
+	}
+	c = attributes.optional_string_attribute("EffectColor");
+	if (c) {
+		ps.effect_colour = Colour(c.get());
+	}
+
+	return ps;
+}
+
+
+void
+TextParser::position_align(ParseState& ps, Attributes const& attributes) const
+{
+	auto hp = attributes.optional_number_attribute<float>("HPosition");
+	if (!hp) {
+		hp = attributes.optional_number_attribute<float>("Hposition");
+	}
+	if (hp) {
+		ps.h_position = hp.get() / 100;
+	}
+
+	auto ha = attributes.optional_string_attribute("HAlign");
+	if (!ha) {
+		ha = attributes.optional_string_attribute("Halign");
+	}
+	if (ha) {
+		ps.h_align = string_to_halign(ha.get());
+	}
+
+	auto vp = attributes.optional_number_attribute<float>("VPosition");
+	if (!vp) {
+		vp = attributes.optional_number_attribute<float>("Vposition");
+	}
+	if (vp) {
+		ps.v_position = vp.get() / 100;
+	}
+
+	auto va = attributes.optional_string_attribute("VAlign");
+	if (!va) {
+		va = attributes.optional_string_attribute("Valign");
+	}
+	if (va) {
+		ps.v_align = string_to_valign(va.get());
+	}
+
+	if (auto zp = attributes.optional_number_attribute<float>("Zposition")) {
+		ps.z_position = zp.get() / 100;
+	}
+
+	if (auto variable_z = attributes.optional_string_attribute("VariableZ")) {
+		ps.variable_z = *variable_z;
+	}
+}
+
+
+TextParser::ParseState
+TextParser::text_node_state(Attributes const& attributes) const
+{
+	ParseState ps;
+
+	position_align(ps, attributes);
+
+	auto d = attributes.optional_string_attribute("Direction");
+	if (d) {
+		ps.direction = string_to_direction(d.get());
+	}
+
+	ps.type = ParseState::Type::TEXT;
+
+	return ps;
+}
+
+
+TextParser::ParseState
+TextParser::image_node_state(Attributes const& attributes) const
+{
+	ParseState ps;
+
+	position_align(ps, attributes);
+
+	ps.type = ParseState::Type::IMAGE;
+
+	return ps;
+}
+
+
+TextParser::ParseState
+TextParser::subtitle_node_state(Attributes const& attributes) const
+{
+	ParseState ps;
+	ps.in = Time(attributes.string_attribute("TimeIn"), _tcr);
+	ps.out = Time(attributes.string_attribute("TimeOut"), _tcr);
+	ps.fade_up_time = fade_time(attributes, "FadeUpTime");
+	ps.fade_down_time = fade_time(attributes, "FadeDownTime");
+	return ps;
+}
+
+
+Time
+TextParser::fade_time(Attributes const& attributes, string name) const
+{
+	auto const u = attributes.optional_string_attribute(name).get_value_or("");
+	Time t;
+
+	if (u.empty()) {
+		t = Time(0, 0, 0, 20, 250);
+	} else if (u.find(":") != string::npos) {
+		t = Time(u, _tcr);
+	} else {
+		t = Time(0, 0, 0, lexical_cast<int>(u), _tcr.get_value_or(250));
+	}
+
+	if (t > Time(0, 0, 8, 0, 250)) {
+		t = Time(0, 0, 8, 0, 250);
+	}
+
+	return t;
+}
+
+
+/** Add the texts from a node, and its children, given that _state holds the states of its ancestors */
+void
+TextParser::add_texts(Node const& node)
+{
+	_state.push_back(node.state);
+
+	for (auto const& item: node.items) {
+		if (item.child) {
+			add_texts(*item.child);
+		} else {
+			maybe_add_text(item.content, item.space_before, node.rubies);
+		}
+	}
+
+	_state.pop_back();
+}
+
+
+void
+TextParser::maybe_add_text(string text, float space_before, vector<Ruby> const& rubies)
+{
+	if (!_add) {
+		return;
+	}
+
+	auto wanted = [](ParseState const& ps) {
+		return ps.type && (ps.type.get() == ParseState::Type::TEXT || ps.type.get() == ParseState::Type::IMAGE);
+	};
+
+	if (std::find_if(_state.begin(), _state.end(), wanted) == _state.end()) {
+		return;
+	}
+
+	ParseState ps;
+	for (auto const& i: _state) {
+		if (i.font_id) {
+			ps.font_id = i.font_id.get();
+		}
+		if (i.size) {
+			ps.size = i.size.get();
+		}
+		if (i.aspect_adjust) {
+			ps.aspect_adjust = i.aspect_adjust.get();
+		}
+		if (i.italic) {
+			ps.italic = i.italic.get();
+		}
+		if (i.bold) {
+			ps.bold = i.bold.get();
+		}
+		if (i.underline) {
+			ps.underline = i.underline.get();
+		}
+		if (i.colour) {
+			ps.colour = i.colour.get();
+		}
+		if (i.effect) {
+			ps.effect = i.effect.get();
+		}
+		if (i.effect_colour) {
+			ps.effect_colour = i.effect_colour.get();
+		}
+		if (i.h_position) {
+			ps.h_position = i.h_position.get();
+		}
+		if (i.h_align) {
+			ps.h_align = i.h_align.get();
+		}
+		if (i.v_position) {
+			ps.v_position = i.v_position.get();
+		}
+		if (i.v_align) {
+			ps.v_align = i.v_align.get();
+		}
+		if (i.z_position) {
+			ps.z_position = i.z_position.get();
+		}
+		if (i.variable_z) {
+			ps.variable_z = i.variable_z.get();
+		}
+		if (i.direction) {
+			ps.direction = i.direction.get();
+		}
+		if (i.in) {
+			ps.in = i.in.get();
+		}
+		if (i.out) {
+			ps.out = i.out.get();
+		}
+		if (i.fade_up_time) {
+			ps.fade_up_time = i.fade_up_time.get();
+		}
+		if (i.fade_down_time) {
+			ps.fade_down_time = i.fade_down_time.get();
+		}
+		if (i.type) {
+			ps.type = i.type.get();
+		}
+		for (auto j: i.load_variable_z) {
+			/* j is a LoadVariableZ from this "sub" ParseState. See if we should add it to the end result */
+			auto const k = std::find_if(ps.load_variable_z.begin(), ps.load_variable_z.end(), [j](LoadVariableZ const& z) { return j.id() == z.id(); });
+			if (k == ps.load_variable_z.end()) {
+				ps.load_variable_z.push_back(j);
+			}
+		}
+	}
+
+	if (!ps.in || !ps.out) {
+		/* We're not in a <Subtitle> node; just ignore this content */
+		return;
+	}
+
+	DCP_ASSERT(ps.type);
+
+	switch (ps.type.get()) {
+	case ParseState::Type::TEXT:
+	{
+		vector<Text::VariableZPosition> variable_z;
+		auto iter = std::find_if(ps.load_variable_z.begin(), ps.load_variable_z.end(), [&ps](LoadVariableZ const& z) { return z.id() == ps.variable_z; });
+		if (iter != ps.load_variable_z.end()) {
+			variable_z = iter->positions();
+		}
+		_add(
+			make_shared<TextString>(
+				ps.font_id,
+				ps.italic.get_value_or(false),
+				ps.bold.get_value_or(false),
+				ps.underline.get_value_or(false),
+				ps.colour.get_value_or(dcp::Colour(255, 255, 255)),
+				ps.size.get_value_or(42),
+				ps.aspect_adjust.get_value_or(1.0),
+				ps.in.get(),
+				ps.out.get(),
+				ps.h_position.get_value_or(0),
+				ps.h_align.get_value_or(HAlign::CENTER),
+				ps.v_position.get_value_or(0),
+				ps.v_align.get_value_or(VAlign::CENTER),
+				ps.z_position.get_value_or(0),
+				variable_z,
+				ps.direction.get_value_or(Direction::LTR),
+				text,
+				ps.effect.get_value_or(Effect::NONE),
+				ps.effect_colour.get_value_or(dcp::Colour(0, 0, 0)),
+				ps.fade_up_time.get_value_or(Time()),
+				ps.fade_down_time.get_value_or(Time()),
+				space_before,
+				rubies
+				)
+			);
+		break;
+	}
+	case ParseState::Type::IMAGE:
+	{
+		switch (_standard) {
+		case Standard::INTEROP:
+			if (text.size() >= 4) {
+				/* Remove file extension */
+				text = text.substr(0, text.size() - 4);
+			}
+			break;
+		case Standard::SMPTE:
+			/* It looks like this urn:uuid: is required, but DoM wasn't expecting it (and not writing it)
+			 * until around 2.15.140 so I guess either:
+			 *   a) it is not (always) used in the field, or
+			 *   b) nobody noticed / complained.
+			 */
+			if (text.substr(0, 9) == "urn:uuid:") {
+				text = text.substr(9);
+			}
+			break;
+		}
+
+		vector<Text::VariableZPosition> variable_z;
+		auto iter = std::find_if(ps.load_variable_z.begin(), ps.load_variable_z.end(), [&ps](LoadVariableZ const& z) { return ps.variable_z && z.id() == *ps.variable_z; });
+		if (iter != ps.load_variable_z.end()) {
+			variable_z = iter->positions();
+		}
+
+		/* Add a text with no image data and we'll fill that in later */
+		_add(
+			make_shared<TextImage>(
+				ArrayData(),
+				text,
+				ps.in.get(),
+				ps.out.get(),
+				ps.h_position.get_value_or(0),
+				ps.h_align.get_value_or(HAlign::CENTER),
+				ps.v_position.get_value_or(0),
+				ps.v_align.get_value_or(VAlign::CENTER),
+				ps.z_position.get_value_or(0),
+				variable_z,
+				ps.fade_up_time.get_value_or(Time()),
+				ps.fade_down_time.get_value_or(Time())
+				)
+			);
+		break;
+	}
+	}
+}
@@ -0,0 +1,269 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/text_parser.h
+ *  @brief TextParser class
+ */
+
+
+#ifndef LIBDCP_TEXT_PARSER_H
+#define LIBDCP_TEXT_PARSER_H
+
+
+#include "dcp_time.h"
+#include "load_variable_z.h"
+#include "text_asset.h"
+#include "types.h"
+#include <boost/optional.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace dcp {
+
+
+/** @class TextParser
+ *  @brief Single-pass reader for Interop and SMPTE subtitle / caption XML.
+ *
+ *  The document is read a node at a time with libxml2's xmlTextReader, so no DOM of it is ever built.
+ *  Simple children of the root element (e.g. <Language>) and <LoadFont>s are kept, each <Subtitle> is
+ *  turned into TextString and TextImage objects as soon as it ends, and the things that the verifier
+ *  needs to know about the XML are gathered into a TextAsset::XMLSummary on the way.
+ */
+class TextParser
+{
+public:
+	explicit TextParser(Standard standard);
+
+	TextParser(TextParser const&) = delete;
+	TextParser& operator=(TextParser const&) = delete;
+
+	/** Parse a complete document, throwing XMLError if it is malformed or does not have the
+	 *  expected root node.
+	 *  @param add Function to call with each text that is found, in document order, or an empty
+	 *  function to just gather the summary.
+	 */
+	void parse(std::string const& xml, std::string root_name, std::function<void (std::shared_ptr<Text>)> add);
+
+	class Attributes
+	{
+	public:
+		void add(std::string name, std::string value) {
+			_attributes.push_back(std::make_pair(name, value));
+		}
+
+		boost::optional<std::string> optional_string_attribute(std::string name) const;
+		/** @return the attribute's value, throwing XMLError if there is no such attribute */
+		std::string string_attribute(std::string name) const;
+		boost::optional<bool> optional_bool_attribute(std::string name) const;
+		template <class T>
+		boost::optional<T> optional_number_attribute(std::string name) const;
+
+	private:
+		std::vector<std::pair<std::string, std::string>> _attributes;
+	};
+
+	/** A child of the root element which is not part of the subtitle list */
+	struct Child
+	{
+		std::string name;
+		Attributes attributes;
+		std::string content;
+	};
+
+	std::string namespace_uri() const {
+		return _namespace_uri;
+	}
+
+	/** @return the content of the root's child called name, throwing XMLError if there is none */
+	std::string string_child(std::string name) const;
+	boost::optional<std::string> optional_string_child(std::string name) const;
+	/** @return all the root's children called name, in document order */
+	std::vector<Child> children(std::string name) const;
+
+	std::shared_ptr<TextAsset::XMLSummary> summary() const {
+		return _summary;
+	}
+
+	/** Properties of a text which can be set at any level of the tree; a text takes each one from
+	 *  the closest of its ancestors that sets it.
+	 */
+	struct ParseState {
+		boost::optional<std::string> font_id;
+		boost::optional<int64_t> size;
+		boost::optional<float> aspect_adjust;
+		boost::optional<bool> italic;
+		boost::optional<bool> bold;
+		boost::optional<bool> underline;
+		boost::optional<Colour> colour;
+		boost::optional<Effect> effect;
+		boost::optional<Colour> effect_colour;
+		boost::optional<float> h_position;
+		boost::optional<HAlign> h_align;
+		boost::optional<float> v_position;
+		boost::optional<VAlign> v_align;
+		boost::optional<float> z_position;
+		boost::optional<std::string> variable_z;
+		boost::optional<Direction> direction;
+		boost::optional<Time> in;
+		boost::optional<Time> out;
+		boost::optional<Time> fade_up_time;
+		boost::optional<Time> fade_down_time;
+		enum class Type {
+			TEXT,
+			IMAGE
+		};
+		boost::optional<Type> type;
+
+		std::vector<LoadVariableZ> load_variable_z;
+	};
+
+private:
+	/** An element inside a <Subtitle> (or the <Subtitle> itself).  These are kept until the
+	 *  outermost <Subtitle> ends, since <Ruby> and <LoadVariableZ> children affect all of
+	 *  their parent's content, including any which came before them.
+	 */
+	struct Node
+	{
+		struct Item
+		{
+			std::string content;
+			float space_before = 0;
+			/** Child element, or nullptr if this item is content */
+			std::unique_ptr<Node> child;
+		};
+
+		ParseState state;
+		std::vector<Ruby> rubies;
+		std::vector<Item> items;
+		/** Total size of <Space>s since the last content */
+		float space_before = 0;
+	};
+
+	/** What we are doing with an open element */
+	enum class Role
+	{
+		ROOT,
+		/** Child of the root that is not part of the subtitle list */
+		CHILD,
+		/** Part of the subtitle list but outside any <Subtitle> */
+		OUTSIDE_SUBTITLE,
+		/** Part of a <Subtitle> */
+		IN_SUBTITLE,
+		RUBY,
+		RUBY_BASE,
+		RUBY_ANNOTATION,
+		LOAD_VARIABLE_Z,
+		/** Something whose children and content we don't need */
+		IGNORE
+	};
+
+	struct Element
+	{
+		Element(std::string name_, Role role_, Node* node_ = nullptr)
+			: name(name_)
+			, role(role_)
+			, node(node_)
+		{}
+
+		std::string name;
+		Role role;
+		Node* node;
+	};
+
+	struct RubyParts
+	{
+		boost::optional<std::string> base;
+		boost::optional<std::string> annotation;
+		boost::optional<float> size;
+		boost::optional<RubyPosition> position;
+		boost::optional<float> offset;
+		boost::optional<float> spacing;
+		boost::optional<float> aspect_adjust;
+	};
+
+	void start_element(std::string name, Attributes const& attributes, int namespaces);
+	void end_element();
+	void content(std::string text);
+
+	void start_body_element(std::string const& name, Attributes const& attributes);
+	void summarise_start(std::string const& name, Attributes const& attributes);
+	void summarise_end(std::string const& name);
+
+	ParseState font_node_state(Attributes const& attributes) const;
+	ParseState text_node_state(Attributes const& attributes) const;
+	ParseState image_node_state(Attributes const& attributes) const;
+	ParseState subtitle_node_state(Attributes const& attributes) const;
+	Time fade_time(Attributes const& attributes, std::string name) const;
+	void position_align(ParseState& ps, Attributes const& attributes) const;
+
+	void add_texts(Node const& node);
+	void maybe_add_text(std::string text, float space_before, std::vector<Ruby> const& rubies);
+
+	Standard _standard;
+	std::function<void (std::shared_ptr<Text>)> _add;
+	bool _seen_root = false;
+
+	std::string _namespace_uri;
+	std::vector<Child> _children;
+	/** Timecode rate for SMPTE documents, taken from <TimeCodeRate> when the subtitle list starts */
+	boost::optional<int> _tcr;
+
+	/** Currently-open elements */
+	std::vector<Element> _elements;
+	/** States of the currently-open subtitle list elements, from the outermost */
+	std::vector<ParseState> _state;
+	/** The outermost <Subtitle> that we are in, if any */
+	std::unique_ptr<Node> _subtitle;
+	RubyParts _ruby;
+	boost::optional<std::string> _load_variable_z_id;
+	/** Content of the current <Rb>, <Rt> or <LoadVariableZ> */
+	std::string _element_content;
+
+	std::shared_ptr<TextAsset::XMLSummary> _summary;
+	/** Whether each currently-open <Text> has some content */
+	std::vector<bool> _open_texts;
+	/** Indices into _summary->subtitles of the currently-open <Subtitle>s */
+	std::vector<size_t> _open_subtitles;
+};
+
+
+}
+
+
+#endif
@@ -194,7 +194,9 @@ dcp::init (optional<boost::filesystem::path> given_resources_directory)
 
 	auto res = given_resources_directory.get_value_or(resources_directory());
 
-	load_language_tag_lists (res / "tags");
+	if (given_resources_directory || getenv("LIBDCP_RESOURCES")) {
+		load_language_tag_lists (res / "tags");
+	}
 	load_rating_list (res / "ratings");
 }
 
@@ -104,7 +104,9 @@ extern boost::optional<std::string> remove_urn_uuid(boost::optional<std::string>
  *  @param resources_directory Path to a directory containing the tags and xsd
  *  directories from the source code; if none is specified libdcp will look
  *  in the directory given by LIBDCP_RESOURCES or based on where the current
- *  executable is.
+ *  executable is.  The language tag lists are built in to the library, but
+ *  if a directory is given here or in LIBDCP_RESOURCES the lists in its tags
+ *  directory will be used instead.
  */
 extern void init (boost::optional<boost::filesystem::path> resources_directory = boost::optional<boost::filesystem::path>());
 
@@ -0,0 +1,241 @@
+/*
+    Copyright (C) 2025 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you must delete this exception
+    statement from your version.  If you delete this exception
+    statement from all source files in the program, then also delete
+    it here.
+*/
+
+
+/** @file  src/verification_cache.cc
+ *  @brief VerificationCache class
+ */
+
+
+
+
+#include "file_stamp.h"
+#include "filesystem.h"
+#include "verification_cache.h"
+#include "version.h"
+#include <libcxml/cxml.h>
+#include <libxml++/libxml++.h>
+#include <fmt/format.h>
+
+
+using std::make_shared;
+using std::string;
+using std::vector;
+using boost::optional;
+using namespace dcp;
+
+
+/** @return A string which changes whenever the notes that libdcp would give might change */
+static string
+cache_version()
+{
+	return fmt::format("{} {}", dcp::version, dcp::git_commit);
+}
+
+
+struct VerificationCache::Entry
+{
+	/** Size, modification time, device and inode of the file when the results were stored */
+	FileStamp stamp;
+	optional<string> hash;
+	/** Notes given by each check, keyed by the name of the check */
+	std::map<string, vector<VerificationNote>> notes;
+};
+
+
+static string
+cache_key(boost::filesystem::path const& asset)
+{
+	boost::system::error_code ec;
+	auto canonical = boost::filesystem::canonical(filesystem::fix_long_path(asset), ec);
+	return ec ? asset.string() : canonical.string();
+}
+
+
+VerificationCache::VerificationCache(boost::filesystem::path file)
+	: _file(file)
+{
+	if (!filesystem::exists(file)) {
+		return;
+	}
+
+	try {
+		cxml::Document doc("VerificationCache");
+		doc.read_file(filesystem::fix_long_path(file));
+		if (doc.string_attribute("version") != cache_version()) {
+			return;
+		}
+
+		for (auto asset: doc.node_children("Asset")) {
+			auto entry = make_shared<Entry>();
+			entry->stamp.size = asset->number_child<uint64_t>("Size");
+			entry->stamp.mtime = asset->number_child<int64_t>("ModificationTime");
+			entry->stamp.device = asset->number_child<uint64_t>("Device");
+			entry->stamp.inode = asset->number_child<uint64_t>("Inode");
+			entry->hash = asset->optional_string_child("Hash");
+			for (auto check: asset->node_children("Check")) {
+				auto& notes = entry->notes[check->string_attribute("name")];
+				for (auto note: check->node_children("Note")) {
+					notes.push_back(VerificationNote(note));
+				}
+			}
+			_entries[asset->string_child("Path")] = entry;
+		}
+	} catch (std::exception&) {
+		/* A damaged cache is no worse than no cache */
+		_entries.clear();
+	}
+}
+
+
+VerificationCache::Entry const*
+VerificationCache::find(boost::filesystem::path const& asset) const
+{
+	auto iter = _entries.find(cache_key(asset));
+	if (iter == _entries.end()) {
+		return nullptr;
+	}
+
+	auto stamp = FileStamp::of(asset);
+	if (!stamp || stamp->recent() || *stamp != iter->second->stamp) {
+		return nullptr;
+	}
+
+	return iter->second.get();
+}
+
+
+VerificationCache::Entry*
+VerificationCache::find_or_reset(boost::filesystem::path const& asset)
+{
+	auto const key = cache_key(asset);
+
+	auto stamp = FileStamp::of(asset);
+	if (!stamp || stamp->recent()) {
+		/* We can't tell if the file changes after this, so don't remember anything about it */
+		_entries.erase(key);
+		return nullptr;
+	}
+
+	auto& entry = _entries[key];
+	if (!entry || *stamp != entry->stamp) {
+		entry = make_shared<Entry>();
+		entry->stamp = *stamp;
+	}
+
+	return entry.get();
+}
+
+
+optional<string>
+VerificationCache::hash(boost::filesystem::path asset) const
+{
+	std::lock_guard<std::mutex> lm(_mutex);
+	auto entry = find(asset);
+	if (!entry) {
+		return {};
+	}
+	return entry->hash;
+}
+
+
+void
+VerificationCache::set_hash(boost::filesystem::path asset, string hash)
+{
+	std::lock_guard<std::mutex> lm(_mutex);
+	if (auto entry = find_or_reset(asset)) {
+		entry->hash = hash;
+	}
+}
+
+
+optional<vector<VerificationNote>>
+VerificationCache::notes(boost::filesystem::path asset, string const& check) const
+{
+	std::lock_guard<std::mutex> lm(_mutex);
+	auto entry = find(asset);
+	if (!entry) {
+		return {};
+	}
+
+	auto iter = entry->notes.find(check);
+	if (iter == entry->notes.end()) {
+		return {};
+	}
+
+	return iter->second;
+}
+
+
+void
+VerificationCache::set_notes(boost::filesystem::path asset, string const& check, vector<VerificationNote> notes)
+{
+	std::lock_guard<std::mutex> lm(_mutex);
+	if (auto entry = find_or_reset(asset)) {
+		entry->notes[check] = std::move(notes);
+	}
+}
+
+
+void
+VerificationCache::save() const
+{
+	std::lock_guard<std::mutex> lm(_mutex);
+
+	xmlpp::Document doc;
+	auto root = doc.create_root_node("VerificationCache");
+	root->set_attribute("version", cache_version());
+
+	for (auto const& i: _entries) {
+		auto asset = cxml::add_child(root, "Asset");
+		cxml::add_text_child(asset, "Path", i.first);
+		cxml::add_text_child(asset, "Size", fmt::to_string(i.second->stamp.size));
+		cxml::add_text_child(asset, "ModificationTime", fmt::to_string(i.second->stamp.mtime));
+		cxml::add_text_child(asset, "Device", fmt::to_string(i.second->stamp.device));
+		cxml::add_text_child(asset, "Inode", fmt::to_string(i.second->stamp.inode));
+		if (i.second->hash) {
+			cxml::add_text_child(asset, "Hash", *i.second->hash);
+		}
+		for (auto const& check: i.second->notes) {
+			auto node = cxml::add_child(asset, "Check");
+			node->set_attribute("name", check.first);
+			for (auto const& note: check.second) {
+				note.as_xml(node);
+			}
+		}
+	}
+
+	/* Write to a temporary file and then rename it so that a reader never sees a half-written cache */
+	auto const temp = _file.string() + ".tmp";
+	doc.write_to_file_formatted(filesystem::fix_long_path(temp).string(), "UTF-8");
+	filesystem::rename(temp, _file);
+}
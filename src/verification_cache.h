@@ -0,0 +1,104 @@
+/*
+    Copyright (C) 2025 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you must delete this exception
+    statement from your version.  If you delete this exception
+    statement from all source files in the program, then also delete
+    it here.
+*/
+
+
+/** @file  src/verification_cache.h
+ *  @brief VerificationCache class
+ */
+
+
+#ifndef LIBDCP_VERIFICATION_CACHE_H
+#define LIBDCP_VERIFICATION_CACHE_H
+
+
+#include "verify.h"
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace dcp {
+
+
+/** @class VerificationCache
+ *  @brief A record of the results of expensive verification checks, which can be kept on disk
+ *  between runs of dcp::verify().
+ *
+ *  Results are stored for each asset file and are discarded if the file's size, modification
+ *  time, device or inode change, or if the cache was written by a different version of libdcp.
+ *  Nothing is stored or used for a file which was modified in the last couple of seconds, since
+ *  it could then change again without its modification time changing.
+ */
+class VerificationCache
+{
+public:
+	/** @param file File to load the cache from (if it exists) and to save() it to */
+	explicit VerificationCache(boost::filesystem::path file);
+
+	VerificationCache(VerificationCache const&) = delete;
+	VerificationCache& operator=(VerificationCache const&) = delete;
+
+	/** @return Previously-calculated hash of an asset file, if it is known and the file has not changed */
+	boost::optional<std::string> hash(boost::filesystem::path asset) const;
+	void set_hash(boost::filesystem::path asset, std::string hash);
+
+	/** @param check Name of the check, including anything that would change the notes
+	 *  which it gives for the same asset.
+	 *  @return Notes previously given by the check, if they are known and the file has not changed.
+	 */
+	boost::optional<std::vector<VerificationNote>> notes(boost::filesystem::path asset, std::string const& check) const;
+	void set_notes(boost::filesystem::path asset, std::string const& check, std::vector<VerificationNote> notes);
+
+	/** Write the cache to the file that it was constructed with */
+	void save() const;
+
+private:
+	struct Entry;
+
+	Entry const* find(boost::filesystem::path const& asset) const;
+	Entry* find_or_reset(boost::filesystem::path const& asset);
+
+	boost::filesystem::path _file;
+	mutable std::mutex _mutex;
+	/** Entries, keyed by canonical path of the asset file */
+	std::map<std::string, std::shared_ptr<Entry>> _entries;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,189 @@
+/*
+    Copyright (C) 2025 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you must delete this exception
+    statement from your version.  If you delete this exception
+    statement from all source files in the program, then also delete
+    it here.
+*/
+
+
+
+
+/** @file  src/verification_shard.cc
+ *  @brief VerificationShard and VerificationShardResult classes, and functions to verify DCPs in shards
+ */
+
+
+#include "dcp.h"
+#include "dcp_assert.h"
+#include "exceptions.h"
+#include "filesystem.h"
+#include "verification_shard.h"
+#include <libcxml/cxml.h>
+#include <libxml++/libxml++.h>
+#include <fmt/format.h>
+#include <map>
+
+
+using std::make_shared;
+using std::map;
+using std::string;
+using std::vector;
+using boost::optional;
+using namespace dcp;
+
+
+VerificationShard::VerificationShard(int index, int count)
+	: _index(index)
+	, _count(count)
+{
+	DCP_ASSERT(count > 0);
+	DCP_ASSERT(index >= 0 && index < count);
+}
+
+
+bool
+VerificationShard::owns(string const& asset_id) const
+{
+	/* Use our own hash (FNV-1a) rather than std::hash so that every process, whatever it was
+	 * built with, agrees on which shard owns which asset.
+	 */
+	uint64_t hash = 14695981039346656037ULL;
+	for (auto c: asset_id) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 1099511628211ULL;
+	}
+	return static_cast<int>(hash % _count) == _index;
+}
+
+
+VerificationShardResult::VerificationShardResult(VerificationShard shard)
+	: _shard(shard)
+{
+
+}
+
+
+VerificationShardResult::VerificationShardResult(boost::filesystem::path file)
+	: _shard(0, 1)
+{
+	cxml::Document doc("VerificationShard");
+	doc.read_file(filesystem::fix_long_path(file));
+
+	_shard = VerificationShard(doc.number_attribute<int>("index"), doc.number_attribute<int>("count"));
+
+	for (auto node: doc.node_children("Section")) {
+		Section section;
+		section.check = node->optional_number_attribute<int>("check");
+		section.done = node->number_attribute<int>("done") != 0;
+		for (auto note: node->node_children("Note")) {
+			section.notes.push_back(VerificationNote(note));
+		}
+		_sections.push_back(section);
+	}
+}
+
+
+void
+VerificationShardResult::write(boost::filesystem::path file) const
+{
+	xmlpp::Document doc;
+	auto root = doc.create_root_node("VerificationShard");
+	root->set_attribute("index", fmt::to_string(_shard.index()));
+	root->set_attribute("count", fmt::to_string(_shard.count()));
+
+	for (auto const& section: _sections) {
+		auto node = cxml::add_child(root, "Section");
+		if (section.check) {
+			node->set_attribute("check", fmt::to_string(*section.check));
+		}
+		node->set_attribute("done", section.done ? "1" : "0");
+		for (auto const& note: section.notes) {
+			note.as_xml(node);
+		}
+	}
+
+	doc.write_to_file_formatted(filesystem::fix_long_path(file).string(), "UTF-8");
+}
+
+
+VerificationResult
+dcp::merge_verification_shards(vector<VerificationShardResult> const& shards, vector<boost::filesystem::path> directories)
+{
+	if (shards.empty()) {
+		throw MiscError("No verification shards to merge");
+	}
+
+	auto const count = shards[0].shard().count();
+	vector<VerificationShardResult const*> by_index(count, nullptr);
+	for (auto const& shard: shards) {
+		auto const index = shard.shard().index();
+		if (shard.shard().count() != count || by_index[index]) {
+			throw MiscError("Verification shards do not belong together");
+		}
+		by_index[index] = &shard;
+	}
+
+	/* Find the notes from every sharded check, from whichever shard did it */
+	map<int, vector<VerificationNote> const*> checks;
+	for (auto shard: by_index) {
+		if (!shard) {
+			throw MiscError("Some verification shards are missing");
+		}
+		for (auto const& section: shard->sections()) {
+			if (section.check && section.done) {
+				checks[*section.check] = &section.notes;
+			}
+		}
+	}
+
+	/* Shard 0 has everything in order, either with the notes or with a placeholder for them */
+	VerificationResult result;
+	for (auto const& section: by_index[0]->sections()) {
+		auto notes = &section.notes;
+		if (section.check) {
+			auto iter = checks.find(*section.check);
+			if (iter == checks.end()) {
+				throw MiscError(fmt::format("No verification shard has the results of check {}", *section.check));
+			}
+			notes = iter->second;
+		}
+		result.notes.insert(result.notes.end(), notes->begin(), notes->end());
+	}
+
+	for (auto directory: directories) {
+		auto dcp = make_shared<DCP>(directory);
+		try {
+			dcp->read(nullptr, true);
+		} catch (std::exception&) {
+			/* Any problems will already have been noted by the shards */
+		}
+		result.dcps.push_back(dcp);
+	}
+
+	return result;
+}
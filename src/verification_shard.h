@@ -0,0 +1,159 @@
+/*
+    Copyright (C) 2025 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you must delete this exception
+    statement from your version.  If you delete this exception
+    statement from all source files in the program, then also delete
+    it here.
+*/
+
+
+
+
+/** @file  src/verification_shard.h
+ *  @brief VerificationShard and VerificationShardResult classes, and functions to verify DCPs in shards
+ */
+
+
+#ifndef LIBDCP_VERIFICATION_SHARD_H
+#define LIBDCP_VERIFICATION_SHARD_H
+
+
+#include "verify.h"
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+
+namespace dcp {
+
+
+/** @class VerificationShard
+ *  @brief One part of a verification which has been split up so that it can be done by several processes.
+ *
+ *  The expensive checks of each asset (hashes and picture details) are given to one shard, chosen
+ *  using the asset's ID.  Every shard does the other checks, but only shard 0 reports what they find.
+ */
+class VerificationShard
+{
+public:
+	/** @param index Index of this shard, counting from 0.
+	 *  @param count Total number of shards.
+	 */
+	VerificationShard(int index, int count);
+
+	int index() const {
+		return _index;
+	}
+
+	int count() const {
+		return _count;
+	}
+
+	/** @return true if this shard should do the expensive checks of the asset with the given ID */
+	bool owns(std::string const& asset_id) const;
+
+private:
+	int _index;
+	int _count;
+};
+
+
+/** @class VerificationShardResult
+ *  @brief The notes found by verifying one VerificationShard.
+ *
+ *  These can be written to a file, read back (perhaps on a different machine) and then
+ *  merged with those from the other shards using merge_verification_shards().
+ */
+class VerificationShardResult
+{
+public:
+	explicit VerificationShardResult(VerificationShard shard);
+
+	/** Read a result which was written by write() */
+	explicit VerificationShardResult(boost::filesystem::path file);
+
+	void write(boost::filesystem::path file) const;
+
+	struct Section
+	{
+		/** Number of the sharded check that these notes came from, or empty for notes from checks which are not sharded */
+		boost::optional<int> check;
+		/** true if the check was done by this shard, false if it was left for another */
+		bool done = true;
+		std::vector<VerificationNote> notes;
+	};
+
+	VerificationShard shard() const {
+		return _shard;
+	}
+
+	/** @return sections of notes, in the order that they were found */
+	std::vector<Section> const& sections() const {
+		return _sections;
+	}
+
+	void add_section(Section section) {
+		_sections.push_back(std::move(section));
+	}
+
+private:
+	VerificationShard _shard;
+	std::vector<Section> _sections;
+};
+
+
+/** Verify one shard of some DCPs.  Every shard must be verified with the same DCPs, KDMs and options.
+ *  The parameters are otherwise as for dcp::verify().
+ */
+VerificationShardResult verify_shard(
+	std::vector<boost::filesystem::path> directories,
+	std::vector<dcp::DecryptedKDM> kdms,
+	std::function<void (std::string, boost::optional<boost::filesystem::path>)> stage,
+	std::function<void (float)> progress,
+	VerificationShard shard,
+	VerificationOptions options = {},
+	boost::optional<boost::filesystem::path> xsd_dtd_directory = boost::optional<boost::filesystem::path>()
+	);
+
+
+/** Merge the results of verifying every shard of some DCPs.  Throws MiscError if the results
+ *  do not cover every shard exactly once.
+ *  @param shards Result of each shard, in any order.
+ *  @param directories Directories of the DCPs which were verified.
+ *  @return the same result as dcp::verify() would have given.
+ */
+VerificationResult merge_verification_shards(
+	std::vector<VerificationShardResult> const& shards,
+	std::vector<boost::filesystem::path> directories
+	);
+
+
+}
+
+
+#endif
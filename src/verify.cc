@@ -57,10 +57,13 @@
 #include "smpte_text_asset.h"
 #include "stereo_j2k_picture_asset.h"
 #include "stereo_j2k_picture_frame.h"
+#include "verification_cache.h"
+#include "verification_shard.h"
 #include "verify.h"
 #include "verify_internal.h"
 #include "verify_j2k.h"
 #include <libxml/parserInternals.h>
+#include <libxml++/libxml++.h>
 #include <xercesc/dom/DOMAttr.hpp>
 #include <xercesc/dom/DOMDocument.hpp>
 #include <xercesc/dom/DOMError.hpp>
@@ -84,6 +87,7 @@
 #include <iostream>
 #include <map>
 #include <numeric>
+#include <random>
 #include <regex>
 #include <set>
 #include <vector>
@@ -403,10 +407,23 @@ verify_asset(
 	 * can check it.  unset_hash() means that this calculation will happen on the
 	 * call to hash().
 	 */
-	reel_file_asset->asset_ref()->unset_hash();
-	*calculated_hash = reel_file_asset->asset_ref()->hash([&context](int64_t done, int64_t total) {
-		context.progress(float(done) / total);
-	});
+	auto const file = reel_file_asset->asset_ref()->file();
+	optional<string> cached_hash;
+	if (context.options.cache && file) {
+		cached_hash = context.options.cache->hash(*file);
+	}
+
+	if (cached_hash) {
+		*calculated_hash = *cached_hash;
+	} else {
+		reel_file_asset->asset_ref()->unset_hash();
+		*calculated_hash = reel_file_asset->asset_ref()->hash([&context](int64_t done, int64_t total) {
+			context.progress(float(done) / total);
+		});
+		if (context.options.cache && file) {
+			context.options.cache->set_hash(*file, *calculated_hash);
+		}
+	}
 
 	auto pkls = context.dcp->pkls();
 	/* We've read this DCP in so it must have at least one PKL */
@@ -449,6 +466,94 @@ verify_language_tag(Context& context, string tag)
 }
 
 
+PictureSampling
+PictureSampling::every_nth_frame(int n)
+{
+	DCP_ASSERT(n > 0);
+	return PictureSampling(Mode::EVERY_NTH_FRAME, n, 0);
+}
+
+
+PictureSampling
+PictureSampling::random(int frames, uint32_t seed)
+{
+	DCP_ASSERT(frames > 0);
+	return PictureSampling(Mode::RANDOM, frames, seed);
+}
+
+
+PictureSampling
+PictureSampling::reel_heads_and_tails(int frames)
+{
+	DCP_ASSERT(frames > 0);
+	return PictureSampling(Mode::REEL_HEADS_AND_TAILS, frames, 0);
+}
+
+
+vector<int64_t>
+PictureSampling::frames(int64_t duration) const
+{
+	vector<int64_t> frames;
+
+	switch (_mode) {
+	case Mode::ALL:
+		for (int64_t i = 0; i < duration; ++i) {
+			frames.push_back(i);
+		}
+		break;
+	case Mode::EVERY_NTH_FRAME:
+		for (int64_t i = 0; i < duration; i += _parameter) {
+			frames.push_back(i);
+		}
+		break;
+	case Mode::RANDOM:
+	{
+		if (_parameter >= duration) {
+			return PictureSampling().frames(duration);
+		}
+		/* Use the generator's output directly, rather than a std::uniform_int_distribution,
+		 * so that the same seed gives the same frames on every platform.
+		 */
+		std::mt19937 generator(_seed);
+		set<int64_t> chosen;
+		while (static_cast<int>(chosen.size()) < _parameter) {
+			chosen.insert(generator() % duration);
+		}
+		frames.assign(chosen.begin(), chosen.end());
+		break;
+	}
+	case Mode::REEL_HEADS_AND_TAILS:
+		for (int64_t i = 0; i < duration; ++i) {
+			if (i < _parameter || i >= (duration - _parameter)) {
+				frames.push_back(i);
+			}
+		}
+		break;
+	}
+
+	return frames;
+}
+
+
+string
+PictureSampling::as_string() const
+{
+	switch (_mode) {
+	case Mode::ALL:
+		return "all";
+	case Mode::EVERY_NTH_FRAME:
+		return fmt::format("every-nth-frame {}", _parameter);
+	case Mode::RANDOM:
+		return fmt::format("random {} {}", _parameter, _seed);
+	case Mode::REEL_HEADS_AND_TAILS:
+		return fmt::format("reel-heads-and-tails {}", _parameter);
+	}
+
+	DCP_ASSERT(false);
+	return "";
+}
+
+
 static void
 verify_picture_details(
 	Context& context,
@@ -463,11 +568,37 @@ verify_picture_details(
 		return;
 	}
 
+	/* The notes depend on start_frame, on whether we can see inside the frames, and on which frames we look at */
+	auto const check = fmt::format(
+		"picture-details {} {} {}", start_frame, (!asset->encrypted() || asset->key()) ? 1 : 0, context.options.picture_sampling.as_string()
+		);
+
+	if (context.options.cache) {
+		if (auto cached = context.options.cache->notes(file, check)) {
+			for (auto const& note: *cached) {
+				context.add_note(note);
+			}
+			return;
+		}
+	}
+
+	/* Record the notes that we find so that they can be cached */
+	vector<VerificationNote> new_notes;
+	auto const sink = context.sink;
+	if (context.options.cache) {
+		context.sink = [&new_notes, sink](VerificationNote const& note) {
+			new_notes.push_back(note);
+			sink(note);
+		};
+	}
+	dcp::ScopeGuard sg = [&context, sink]() { context.sink = sink; };
+
 	auto const duration = asset->intrinsic_duration ();
+	auto const frames = context.options.picture_sampling.frames(duration);
 
 	auto check_and_add = [&context](vector<VerificationNote> const& j2k_notes) {
 		for (auto i: j2k_notes) {
-			context.add_note_if_not_existing(i);
+			context.add_note(i);
 		}
 	};
 
@@ -496,7 +627,8 @@ verify_picture_details(
 
 	if (auto mono_asset = dynamic_pointer_cast<MonoJ2KPictureAsset>(reel_file_asset->asset_ref().asset())) {
 		auto reader = mono_asset->start_read ();
-		for (int64_t i = 0; i < duration; ++i) {
+		for (size_t j = 0; j < frames.size(); ++j) {
+			auto const i = frames[j];
 			auto frame = reader->get_frame (i);
 			check_frame_size(context, i, frame->size(), mono_asset->frame_rate().numerator);
 			if (!mono_asset->encrypted() || mono_asset->key()) {
@@ -504,11 +636,12 @@ verify_picture_details(
 				verify_j2k(frame, start_frame, i, mono_asset->frame_rate().numerator, j2k_notes);
 				check_and_add (j2k_notes);
 			}
-			context.progress(float(i) / duration);
+			context.progress(float(j) / frames.size());
 		}
 	} else if (auto stereo_asset = dynamic_pointer_cast<StereoJ2KPictureAsset>(asset)) {
 		auto reader = stereo_asset->start_read ();
-		for (int64_t i = 0; i < duration; ++i) {
+		for (size_t j = 0; j < frames.size(); ++j) {
+			auto const i = frames[j];
 			auto frame = reader->get_frame (i);
 			check_frame_size(context, i, frame->left()->size(), stereo_asset->frame_rate().numerator);
 			check_frame_size(context, i, frame->right()->size(), stereo_asset->frame_rate().numerator);
@@ -518,14 +651,24 @@ verify_picture_details(
 				verify_j2k(frame->right(), start_frame, i, stereo_asset->frame_rate().numerator, j2k_notes);
 				check_and_add (j2k_notes);
 			}
-			context.progress(float(i) / duration);
+			context.progress(float(j) / frames.size());
 		}
 
 	}
 
-	if (!any_bad_frames_seen) {
+	if (static_cast<int64_t>(frames.size()) < duration) {
+		context.add_note(
+			VerificationNote(
+				VerificationNote::Code::SAMPLED_PICTURE_FRAMES, file
+				).set_checked_frames(frames.size()).set_duration(duration)
+			);
+	} else if (!any_bad_frames_seen) {
 		context.add_note(VerificationNote::Code::VALID_PICTURE_FRAME_SIZES_IN_BYTES, file);
 	}
+
+	if (context.options.cache) {
+		context.options.cache->set_notes(file, check, new_notes);
+	}
 }
 
 
@@ -535,37 +678,39 @@ verify_main_picture_asset(Context& context, shared_ptr<const ReelPictureAsset> r
 	auto asset = reel_asset->asset();
 	auto const file = *asset->file();
 
-	if (
-		context.options.check_asset_hashes &&
-		(!context.options.maximum_asset_size_for_hash_check || filesystem::file_size(file) < *context.options.maximum_asset_size_for_hash_check) &&
-		context.should_verify_asset(reel_asset->id())
-	   ) {
-		context.stage("Checking picture asset hash", file);
-		string reference_hash;
-		string calculated_hash;
-		auto const r = verify_asset(context, reel_asset, &reference_hash, &calculated_hash);
-		switch (r) {
-			case VerifyAssetResult::BAD:
-				context.add_note(
-					dcp::VerificationNote(
-						VerificationNote::Code::INCORRECT_PICTURE_HASH,
-						file
-						).set_reference_hash(reference_hash).set_calculated_hash(calculated_hash)
-					);
-				break;
-			case VerifyAssetResult::CPL_PKL_DIFFER:
-				context.add_note(VerificationNote::Code::MISMATCHED_PICTURE_HASHES, file);
-				break;
-			default:
-				context.add_note(VerificationNote::Code::CORRECT_PICTURE_HASH, file);
-				break;
+	context.sharded_check(reel_asset->id(), [&context, reel_asset, file, start_frame]() {
+		if (
+			context.options.check_asset_hashes &&
+			(!context.options.maximum_asset_size_for_hash_check || filesystem::file_size(file) < *context.options.maximum_asset_size_for_hash_check) &&
+			context.should_verify_asset(reel_asset->id())
+		   ) {
+			context.stage("Checking picture asset hash", file);
+			string reference_hash;
+			string calculated_hash;
+			auto const r = verify_asset(context, reel_asset, &reference_hash, &calculated_hash);
+			switch (r) {
+				case VerifyAssetResult::BAD:
+					context.add_note(
+						dcp::VerificationNote(
+							VerificationNote::Code::INCORRECT_PICTURE_HASH,
+							file
+							).set_reference_hash(reference_hash).set_calculated_hash(calculated_hash)
+						);
+					break;
+				case VerifyAssetResult::CPL_PKL_DIFFER:
+					context.add_note(VerificationNote::Code::MISMATCHED_PICTURE_HASHES, file);
+					break;
+				default:
+					context.add_note(VerificationNote::Code::CORRECT_PICTURE_HASH, file);
+					break;
+			}
 		}
-	}
 
-	if (context.options.check_picture_details) {
-		context.stage("Checking picture asset details", asset->file());
-		verify_picture_details(context, reel_asset, file, start_frame);
-	}
+		if (context.options.check_picture_details) {
+			context.stage("Checking picture asset details", file);
+			verify_picture_details(context, reel_asset, file, start_frame);
+		}
+	});
 
 	if (dynamic_pointer_cast<const J2KPictureAsset>(asset)) {
 		/* Only flat/scope allowed by Bv2.1 */
@@ -614,31 +759,33 @@ verify_main_sound_asset(Context& context, shared_ptr<const ReelSoundAsset> reel_
 	auto asset = reel_asset->asset();
 	auto const file = *asset->file();
 
-	if (
-		context.options.check_asset_hashes &&
-		(!context.options.maximum_asset_size_for_hash_check || filesystem::file_size(file) < *context.options.maximum_asset_size_for_hash_check) &&
-		context.should_verify_asset(reel_asset->id())
-	   ) {
-		context.stage("Checking sound asset hash", file);
-		string reference_hash;
-		string calculated_hash;
-		auto const r = verify_asset(context, reel_asset, &reference_hash, &calculated_hash);
-		switch (r) {
-			case VerifyAssetResult::BAD:
-				context.add_note(
-					dcp::VerificationNote(
-						VerificationNote::Code::INCORRECT_SOUND_HASH,
-						file
-						).set_reference_hash(reference_hash).set_calculated_hash(calculated_hash)
-					);
-				break;
-			case VerifyAssetResult::CPL_PKL_DIFFER:
-				context.add_note(VerificationNote::Code::MISMATCHED_SOUND_HASHES, file);
-				break;
-			default:
-				break;
+	context.sharded_check(reel_asset->id(), [&context, reel_asset, file]() {
+		if (
+			context.options.check_asset_hashes &&
+			(!context.options.maximum_asset_size_for_hash_check || filesystem::file_size(file) < *context.options.maximum_asset_size_for_hash_check) &&
+			context.should_verify_asset(reel_asset->id())
+		   ) {
+			context.stage("Checking sound asset hash", file);
+			string reference_hash;
+			string calculated_hash;
+			auto const r = verify_asset(context, reel_asset, &reference_hash, &calculated_hash);
+			switch (r) {
+				case VerifyAssetResult::BAD:
+					context.add_note(
+						dcp::VerificationNote(
+							VerificationNote::Code::INCORRECT_SOUND_HASH,
+							file
+							).set_reference_hash(reference_hash).set_calculated_hash(calculated_hash)
+						);
+					break;
+				case VerifyAssetResult::CPL_PKL_DIFFER:
+					context.add_note(VerificationNote::Code::MISMATCHED_SOUND_HASHES, file);
+					break;
+				default:
+					break;
+			}
 		}
-	}
+	});
 
 	if (!context.audio_channels) {
 		context.audio_channels = asset->channels();
@@ -783,11 +930,10 @@ verify_smpte_subtitle_asset(Context& context, shared_ptr<const SMPTETextAsset> a
 		context.add_note(VerificationNote::Code::MISSED_CHECK_OF_ENCRYPTED);
 	}
 
-	if (asset->raw_xml()) {
+	auto summary = asset->xml_summary();
+	if (summary && summary->issue_date) {
 		/* Deluxe require this in their QC even if it seems never to be mentioned in any standard */
-		cxml::Document doc("SubtitleReel");
-		doc.read_string(*asset->raw_xml());
-		auto issue_date = doc.string_child("IssueDate");
+		auto const& issue_date = *summary->issue_date;
 		std::regex reg("^\\d\\d\\d\\d-\\d\\d-\\d\\dT\\d\\d:\\d\\d:\\d\\d$");
 		if (!std::regex_match(issue_date, reg)) {
 			context.add_note(VerificationNote(VerificationNote::Code::INVALID_SUBTITLE_ISSUE_DATE).set_issue_date(issue_date));
@@ -810,21 +956,15 @@ verify_subtitle_asset(Context& context, shared_ptr<const TextAsset> asset, optio
 		context.add_note(VerificationNote::Code::MISSED_CHECK_OF_ENCRYPTED);
 	}
 
-	auto namespace_count = [](shared_ptr<const TextAsset> asset, string root_node) {
-		cxml::Document doc(root_node);
-		doc.read_string(asset->raw_xml().get());
-		auto root = dynamic_cast<xmlpp::Element const*>(doc.node())->cobj();
-		int count = 0;
-		for (auto ns = root->nsDef; ns != nullptr; ns = ns->next) {
-			++count;
-		}
-		return count;
+	auto namespace_count = [](shared_ptr<const TextAsset> asset) {
+		auto summary = asset->xml_summary();
+		return summary ? summary->root_namespaces : 0;
 	};
 
 	auto interop = dynamic_pointer_cast<const InteropTextAsset>(asset);
 	if (interop) {
 		verify_interop_text_asset(context, interop);
-		if (namespace_count(asset, "DCSubtitle") > 1) {
+		if (namespace_count(asset) > 1) {
 			context.add_note(VerificationNote(VerificationNote::Code::INCORRECT_SUBTITLE_NAMESPACE_COUNT).set_asset_id(asset->id()));
 		}
 	}
@@ -834,7 +974,7 @@ verify_subtitle_asset(Context& context, shared_ptr<const TextAsset> asset, optio
 		verify_smpte_timed_text_asset(context, smpte, reel_asset_duration);
 		verify_smpte_subtitle_asset(context, smpte);
 		/* This asset may be encrypted and in that case we'll have no raw_xml() */
-		if (asset->raw_xml() && namespace_count(asset, "SubtitleReel") > 1) {
+		if (asset->raw_xml() && namespace_count(asset) > 1) {
 			context.add_note(VerificationNote(VerificationNote::Code::INCORRECT_SUBTITLE_NAMESPACE_COUNT).set_asset_id(asset->id()));
 		}
 	}
@@ -881,7 +1021,7 @@ verify_text_details (
 	int edit_rate,
 	std::function<std::string (shared_ptr<Reel>)> asset_id,
 	std::function<bool (shared_ptr<Reel>)> check,
-	std::function<optional<string> (shared_ptr<Reel>)> xml,
+	std::function<shared_ptr<const TextAsset> (shared_ptr<Reel>)> asset,
 	std::function<int64_t (shared_ptr<Reel>)> duration,
 	std::function<std::string (shared_ptr<Reel>)> id
 	)
@@ -900,78 +1040,6 @@ verify_text_details (
 		optional<string> missing_load_font_id;
 	};
 
-	std::function<void (Errors&, cxml::ConstNodePtr, optional<int>, optional<Time>, int, bool, bool&, vector<string>&)> parse;
-
-	parse = [&parse, &last_out, &reel_offset](
-		Errors& errors,
-		cxml::ConstNodePtr node,
-		optional<int> tcr,
-		optional<Time> start_time,
-		int er,
-		bool first_reel,
-		bool& has_text,
-		vector<string>& font_ids
-		) {
-		if (node->name() == "Subtitle") {
-			Time in (node->string_attribute("TimeIn"), tcr);
-			if (start_time) {
-				in -= *start_time;
-			}
-			Time out (node->string_attribute("TimeOut"), tcr);
-			if (start_time) {
-				out -= *start_time;
-			}
-			if (first_reel && tcr && in < Time(0, 0, 4, 0, *tcr)) {
-				errors.too_early = true;
-			}
-			auto length = out - in;
-			if (length.as_editable_units_ceil(er) <= 0) {
-				errors.too_short = true;
-			} else if (length.as_editable_units_ceil(er) < 15) {
-				errors.too_short_bv21 = true;
-			}
-			if (last_out) {
-				/* XXX: this feels dubious - is it really what Bv2.1 means? */
-				auto distance = reel_offset + in.as_editable_units_ceil(er) - *last_out;
-				if (distance >= 0 && distance < 2) {
-					errors.too_close = true;
-				}
-			}
-			last_out = reel_offset + out.as_editable_units_floor(er);
-		} else if (node->name() == "Text") {
-			std::function<bool (cxml::ConstNodePtr)> node_has_content = [&](cxml::ConstNodePtr node) {
-				if (!node->content().empty()) {
-					return true;
-				}
-				for (auto i: node->node_children()) {
-					if (node_has_content(i)) {
-						return true;
-					}
-				}
-				return false;
-			};
-			if (!node_has_content(node)) {
-				errors.empty_text = true;
-			}
-			has_text = true;
-		} else if (node->name() == "LoadFont") {
-			if (auto const id = node->optional_string_attribute("Id")) {
-				font_ids.push_back(*id);
-			} else if (auto const id = node->optional_string_attribute("ID")) {
-				font_ids.push_back(*id);
-			}
-		} else if (node->name() == "Font") {
-			if (auto const font_id = node->optional_string_attribute("Id")) {
-				if (std::find_if(font_ids.begin(), font_ids.end(), [font_id](string const& id) { return id == font_id; }) == font_ids.end()) {
-					errors.missing_load_font_id = font_id;
-				}
-			}
-		}
-		for (auto i: node->node_children()) {
-			parse(errors, i, tcr, start_time, er, first_reel, has_text, font_ids);
-		}
-	};
-
 	for (auto i = 0U; i < reels.size(); ++i) {
 
 		bool reel_overlap = false;
@@ -985,43 +1053,64 @@ verify_text_details (
 			continue;
 		}
 
-		auto reel_xml = xml(reels[i]);
-		if (!reel_xml) {
+		auto summary = asset(reels[i])->xml_summary();
+		if (!summary) {
 			context.add_note(VerificationNote::Code::MISSED_CHECK_OF_ENCRYPTED);
 			continue;
 		}
 
 		/* We need to look at <Subtitle> instances in the XML being checked, so we can't use the subtitles
-		 * read in by libdcp's parser.
+		 * that libdcp made from them; the summary has what was actually written.
 		 */
 
-		shared_ptr<cxml::Document> doc;
 		optional<int> tcr;
 		optional<Time> start_time;
-		switch (context.dcp->standard().get_value_or(dcp::Standard::SMPTE)) {
-		case dcp::Standard::INTEROP:
-			doc = make_shared<cxml::Document>("DCSubtitle");
-			doc->read_string (*reel_xml);
-			break;
-		case dcp::Standard::SMPTE:
-			doc = make_shared<cxml::Document>("SubtitleReel");
-			doc->read_string (*reel_xml);
-			tcr = doc->number_child<int>("TimeCodeRate");
-			if (auto start_time_string = doc->optional_string_child("StartTime")) {
-				start_time = Time(*start_time_string, tcr);
+		if (context.dcp->standard().get_value_or(dcp::Standard::SMPTE) == dcp::Standard::SMPTE) {
+			tcr = summary->time_code_rate;
+			start_time = summary->start_time;
+		}
+
+		for (auto const& subtitle: summary->subtitles) {
+			auto in = subtitle.in;
+			auto out = subtitle.out;
+			if (start_time) {
+				in -= *start_time;
+				out -= *start_time;
+			}
+			if (i == 0 && tcr && in < Time(0, 0, 4, 0, *tcr)) {
+				errors.too_early = true;
+			}
+			auto length = out - in;
+			if (length.as_editable_units_ceil(edit_rate) <= 0) {
+				errors.too_short = true;
+			} else if (length.as_editable_units_ceil(edit_rate) < 15) {
+				errors.too_short_bv21 = true;
+			}
+			if (last_out) {
+				/* XXX: this feels dubious - is it really what Bv2.1 means? */
+				auto distance = reel_offset + in.as_editable_units_ceil(edit_rate) - *last_out;
+				if (distance >= 0 && distance < 2) {
+					errors.too_close = true;
+				}
+			}
+			last_out = reel_offset + out.as_editable_units_floor(edit_rate);
+		}
+
+		errors.empty_text = summary->empty_text;
+		auto const& font_ids = summary->load_font_ids;
+		for (auto const& font_id: summary->font_ids) {
+			if (std::find(font_ids.begin(), font_ids.end(), font_id) == font_ids.end()) {
+				errors.missing_load_font_id = font_id;
 			}
-			break;
 		}
-		bool has_text = false;
-		vector<string> font_ids;
-		parse(errors, doc, tcr, start_time, edit_rate, i == 0, has_text, font_ids);
+
 		auto end = reel_offset + duration(reels[i]);
 		if (last_out && *last_out > end) {
 			reel_overlap = true;
 		}
 		reel_offset = end;
 
-		if (context.dcp->standard() && *context.dcp->standard() == dcp::Standard::SMPTE && has_text && font_ids.empty()) {
+		if (context.dcp->standard() && *context.dcp->standard() == dcp::Standard::SMPTE && summary->has_text && font_ids.empty()) {
 			context.add_note(dcp::VerificationNote(VerificationNote::Code::MISSING_LOAD_FONT).set_asset_id(id(reels[i])));
 		}
 
@@ -1064,64 +1153,38 @@ static
 void
 verify_closed_caption_details(Context& context, vector<shared_ptr<Reel>> reels)
 {
-	std::function<void (cxml::ConstNodePtr node, std::vector<cxml::ConstNodePtr>& text_or_image)> find_text_or_image;
-	find_text_or_image = [&find_text_or_image](cxml::ConstNodePtr node, std::vector<cxml::ConstNodePtr>& text_or_image) {
-		for (auto i: node->node_children()) {
-			if (i->name() == "Text") {
-				text_or_image.push_back (i);
-			} else {
-				find_text_or_image (i, text_or_image);
-			}
-		}
-	};
-
 	auto mismatched_valign = false;
 	auto incorrect_order = false;
 
-	std::function<void (cxml::ConstNodePtr)> parse;
-	parse = [&parse, &find_text_or_image, &mismatched_valign, &incorrect_order](cxml::ConstNodePtr node) {
-		if (node->name() == "Subtitle") {
-			vector<cxml::ConstNodePtr> text_or_image;
-			find_text_or_image (node, text_or_image);
-			optional<string> last_valign;
-			optional<float> last_vpos;
-			for (auto i: text_or_image) {
-				auto valign = i->optional_string_attribute("VAlign");
-				if (!valign) {
-					valign = i->optional_string_attribute("Valign").get_value_or("center");
-				}
-				auto vpos = i->optional_number_attribute<float>("VPosition");
-				if (!vpos) {
-					vpos = i->optional_number_attribute<float>("Vposition").get_value_or(50);
-				}
+	auto check = [&mismatched_valign, &incorrect_order](TextAsset::XMLSummary::Subtitle const& subtitle) {
+		optional<string> last_valign;
+		optional<float> last_vpos;
+		for (auto const& text: subtitle.texts) {
+			auto const valign = text.v_align.get_value_or("center");
+			auto const vpos = text.v_position.get_value_or(50);
 
-				if (last_valign) {
-					if (*last_valign != valign) {
-						mismatched_valign = true;
-					}
+			if (last_valign) {
+				if (*last_valign != valign) {
+					mismatched_valign = true;
 				}
-				last_valign = valign;
+			}
+			last_valign = valign;
 
-				if (!mismatched_valign) {
-					if (last_vpos) {
-						if (*last_valign == "top" || *last_valign == "center") {
-							if (*vpos < *last_vpos) {
-								incorrect_order = true;
-							}
-						} else {
-							if (*vpos > *last_vpos) {
-								incorrect_order = true;
-							}
+			if (!mismatched_valign) {
+				if (last_vpos) {
+					if (*last_valign == "top" || *last_valign == "center") {
+						if (vpos < *last_vpos) {
+							incorrect_order = true;
+						}
+					} else {
+						if (vpos > *last_vpos) {
+							incorrect_order = true;
 						}
 					}
-					last_vpos = vpos;
 				}
+				last_vpos = vpos;
 			}
 		}
-
-		for (auto i: node->node_children()) {
-			parse(i);
-		}
 	};
 
 	int reel_index = 0;
@@ -1129,27 +1192,18 @@ verify_closed_caption_details(Context& context, vector<shared_ptr<Reel>> reels)
 		context.reel_index = reel_index;
 		dcp::ScopeGuard sg = [&context]() { context.reel_index = boost::none; };
 		for (auto ccap: reel->closed_captions()) {
-			auto reel_xml = ccap->asset()->raw_xml();
-			if (!reel_xml) {
+			auto summary = ccap->asset()->xml_summary();
+			if (!summary) {
 				context.add_note(VerificationNote::Code::MISSED_CHECK_OF_ENCRYPTED);
 				continue;
 			}
 
 			/* We need to look at <Subtitle> instances in the XML being checked, so we can't use the subtitles
-			 * read in by libdcp's parser.
+			 * that libdcp made from them; the summary has what was actually written.
 			 */
-
-			shared_ptr<cxml::Document> doc;
-			optional<int> tcr;
-			optional<Time> start_time;
-			try {
-				doc = make_shared<cxml::Document>("SubtitleReel");
-				doc->read_string (*reel_xml);
-			} catch (...) {
-				doc = make_shared<cxml::Document>("DCSubtitle");
-				doc->read_string (*reel_xml);
+			for (auto const& subtitle: summary->subtitles) {
+				check(subtitle);
 			}
-			parse (doc);
 		}
 
 		++reel_index;
@@ -1286,7 +1340,7 @@ verify_text_details(Context& context, vector<shared_ptr<Reel>> reels)
 				return static_cast<bool>(reel->main_subtitle());
 			},
 			[](shared_ptr<Reel> reel) {
-				return reel->main_subtitle()->asset()->raw_xml();
+				return reel->main_subtitle()->asset();
 			},
 			[](shared_ptr<Reel> reel) {
 				return reel->main_subtitle()->actual_duration();
@@ -1306,7 +1360,7 @@ verify_text_details(Context& context, vector<shared_ptr<Reel>> reels)
 				return i < reel->closed_captions().size();
 			},
 			[i](shared_ptr<Reel> reel) {
-				return reel->closed_captions()[i]->asset()->raw_xml();
+				return reel->closed_captions()[i]->asset();
 			},
 			[i](shared_ptr<Reel> reel) {
 				return reel->closed_captions()[i]->actual_duration();
@@ -1848,14 +1902,19 @@ verify_assetmap(Context& context, shared_ptr<const DCP> dcp)
 }
 
 
-dcp::VerificationResult
-dcp::verify (
+/** Verify some DCPs, calling finished with each one when its checks are done */
+static void
+verify_dcps(
 	vector<boost::filesystem::path> directories,
 	vector<dcp::DecryptedKDM> kdms,
 	function<void (string, optional<boost::filesystem::path>)> stage,
 	function<void (float)> progress,
+	function<void (VerificationNote const&)> sink,
 	VerificationOptions options,
-	optional<boost::filesystem::path> xsd_dtd_directory
+	optional<boost::filesystem::path> xsd_dtd_directory,
+	function<void (shared_ptr<DCP>)> finished,
+	optional<VerificationShard> shard = {},
+	function<void (optional<int>, bool)> shard_section = {}
 	)
 {
 	if (!xsd_dtd_directory) {
@@ -1863,22 +1922,36 @@ dcp::verify (
 	}
 	*xsd_dtd_directory = filesystem::canonical(*xsd_dtd_directory);
 
-	vector<VerificationNote> notes;
-	Context context(notes, *xsd_dtd_directory, stage, progress, options);
+	Context context(sink, *xsd_dtd_directory, stage, progress, options);
+	context.shard = shard;
+	context.shard_section = shard_section;
 
-	vector<shared_ptr<DCP>> dcps;
-	for (auto i: directories) {
-		dcps.push_back (make_shared<DCP>(i));
-	}
+	/* Only the first shard reports the results of checks which are not sharded */
+	auto unsharded_sink = [&sink, shard](VerificationNote const& note) {
+		if (!shard || shard->index() == 0) {
+			sink(note);
+		}
+	};
 
-	for (auto dcp: dcps) {
+	for (auto i: directories) {
+		auto dcp = make_shared<DCP>(i);
 		stage ("Checking DCP", dcp->directory());
 
 		context.dcp = dcp;
+		dcp::ScopeGuard sg = [&context, &finished, dcp]() {
+			context.dcp.reset();
+			finished(dcp);
+		};
 
 		bool carry_on = true;
 		try {
-			dcp->read (&notes, true);
+			vector<VerificationNote> read_notes;
+			dcp::ScopeGuard read_sg = [&read_notes, &unsharded_sink]() {
+				for (auto const& note: read_notes) {
+					unsharded_sink(note);
+				}
+			};
+			dcp->read (&read_notes, true);
 		} catch (MissingAssetmapError& e) {
 			context.add_note(VerificationNote(VerificationNote::Code::FAILED_READ).set_error(e.what()));
 			carry_on = false;
@@ -1902,7 +1975,7 @@ dcp::verify (
 		}
 
 		if (dcp->standard() != Standard::SMPTE) {
-			notes.push_back({VerificationNote::Code::INVALID_STANDARD});
+			unsharded_sink({VerificationNote::Code::INVALID_STANDARD});
 		}
 
 		for (auto kdm: kdms) {
@@ -1917,7 +1990,7 @@ dcp::verify (
 				context.audio_channels.reset();
 				context.subtitle_language.reset();
 			} catch (ReadError& e) {
-				notes.push_back(VerificationNote(VerificationNote::Code::FAILED_READ).set_error(e.what()));
+				unsharded_sink(VerificationNote(VerificationNote::Code::FAILED_READ).set_error(e.what()));
 			}
 		}
 
@@ -1934,7 +2007,112 @@ dcp::verify (
 		}
 	}
 
-	return { notes, dcps };
+	if (options.cache) {
+		options.cache->save();
+	}
+}
+
+
+dcp::VerificationResult
+dcp::verify (
+	vector<boost::filesystem::path> directories,
+	vector<dcp::DecryptedKDM> kdms,
+	function<void (string, optional<boost::filesystem::path>)> stage,
+	function<void (float)> progress,
+	VerificationOptions options,
+	optional<boost::filesystem::path> xsd_dtd_directory
+	)
+{
+	VerificationResult result;
+	verify_dcps(
+		directories,
+		kdms,
+		stage,
+		progress,
+		[&result](VerificationNote const& note) { result.notes.push_back(note); },
+		options,
+		xsd_dtd_directory,
+		[&result](shared_ptr<DCP> dcp) { result.dcps.push_back(dcp); }
+		);
+	return result;
+}
+
+
+void
+dcp::verify(
+	vector<boost::filesystem::path> directories,
+	vector<dcp::DecryptedKDM> kdms,
+	function<void (string, optional<boost::filesystem::path>)> stage,
+	function<void (float)> progress,
+	VerificationNoteSink& sink,
+	VerificationOptions options,
+	optional<boost::filesystem::path> xsd_dtd_directory
+	)
+{
+	verify_dcps(
+		directories,
+		kdms,
+		stage,
+		progress,
+		[&sink](VerificationNote const& note) { sink.add(note); },
+		options,
+		xsd_dtd_directory,
+		[](shared_ptr<DCP>) {}
+		);
+}
+
+
+VerificationShardResult
+dcp::verify_shard(
+	vector<boost::filesystem::path> directories,
+	vector<dcp::DecryptedKDM> kdms,
+	function<void (string, optional<boost::filesystem::path>)> stage,
+	function<void (float)> progress,
+	VerificationShard shard,
+	VerificationOptions options,
+	optional<boost::filesystem::path> xsd_dtd_directory
+	)
+{
+	VerificationShardResult result(shard);
+	VerificationShardResult::Section section;
+
+	auto finish_section = [&result, &section]() {
+		if (section.check || !section.notes.empty()) {
+			result.add_section(std::move(section));
+		}
+		section = {};
+	};
+
+	verify_dcps(
+		directories,
+		kdms,
+		stage,
+		progress,
+		[&section](VerificationNote const& note) { section.notes.push_back(note); },
+		options,
+		xsd_dtd_directory,
+		[](shared_ptr<DCP>) {},
+		shard,
+		[&section, &finish_section](optional<int> check, bool done) {
+			finish_section();
+			section.check = check;
+			section.done = done;
+		});
+
+	finish_section();
+	return result;
+}
+
+
+void
+dcp::VerificationNoteSink::add(VerificationNote const& note)
+{
+	if (_deduplicate && !_seen.insert(note).second) {
+		return;
+	}
+
+	++_count;
+	_handler(note);
 }
 
 
@@ -2216,6 +2394,8 @@ dcp::note_to_string(VerificationNote note, function<string (string)> process_str
 		return compose("The CPL %1 has no <ContentVersion> tag", note.cpl_id().get());
 	case VerificationNote::Code::INVALID_PKL_NAMESPACE:
 		return compose("The namespace %1 in PKL %2 is invalid", *note.xml_namespace(), note.file()->filename());
+	case VerificationNote::Code::SAMPLED_PICTURE_FRAMES:
+		return compose("Only %1 of the %2 frames of the picture asset %3 were checked in detail.", *note.checked_frames(), *note.duration(), filename());
 	}
 
 	return "";
@@ -2231,6 +2411,7 @@ dcp::VerificationNote::type() const
 	case Code::MATCHING_CPL_HASHES:
 	case Code::MATCHING_PKL_ANNOTATION_TEXT_WITH_CPL:
 	case Code::NONE_ENCRYPTED:
+	case Code::SAMPLED_PICTURE_FRAMES:
 	case Code::VALID_CONTENT_KIND:
 	case Code::VALID_CONTENT_VERSION_LABEL_TEXT:
 	case Code::VALID_CPL_ANNOTATION_TEXT:
@@ -2379,6 +2560,7 @@ dcp::operator== (dcp::VerificationNote const& a, dcp::VerificationNote const& b)
 		a.annotation_text() == b.annotation_text() &&
 		a.bit_depth() == b.bit_depth() &&
 		a.capabilities() == b.capabilities() &&
+		a.checked_frames() == b.checked_frames() &&
 		a.code_block_height() == b.code_block_height() &&
 		a.code_block_width() == b.code_block_width() &&
 		a.content_kind() == b.content_kind() &&
@@ -2540,6 +2722,10 @@ dcp::operator< (dcp::VerificationNote const& a, dcp::VerificationNote const& b)
 		return less_than_optional(a.capabilities(), b.capabilities());
 	}
 
+	if (a.checked_frames() != b.checked_frames()) {
+		return less_than_optional(a.checked_frames(), b.checked_frames());
+	}
+
 	if (a.code_block_height() != b.code_block_height()) {
 		return less_than_optional(a.code_block_height(), b.code_block_height());
 	}
@@ -2671,3 +2857,112 @@ dcp::VerificationNote::location_as_string(Location location) const
        return "";
 }
 
+
+/** Write a value from one of VerificationNote's maps as a child of parent, noting its type
+ *  so that it can be read back by any_from_xml().
+ */
+static void
+any_as_xml(xmlpp::Element* parent, string name, int key, boost::any const& value)
+{
+	auto node = cxml::add_child(parent, name);
+	node->set_attribute("key", fmt::to_string(key));
+
+	auto const& type = value.type();
+	if (type == typeid(string)) {
+		node->set_attribute("type", "string");
+		node->add_child_text(boost::any_cast<string>(value));
+	} else if (type == typeid(int)) {
+		node->set_attribute("type", "int");
+		node->add_child_text(fmt::to_string(boost::any_cast<int>(value)));
+	} else if (type == typeid(uint64_t)) {
+		node->set_attribute("type", "uint64");
+		node->add_child_text(fmt::to_string(boost::any_cast<uint64_t>(value)));
+	} else if (type == typeid(int64_t)) {
+		node->set_attribute("type", "int64");
+		node->add_child_text(fmt::to_string(boost::any_cast<int64_t>(value)));
+	} else if (type == typeid(boost::filesystem::path)) {
+		node->set_attribute("type", "path");
+		node->add_child_text(boost::any_cast<boost::filesystem::path>(value).generic_string());
+	} else if (type == typeid(dcp::Fraction)) {
+		node->set_attribute("type", "fraction");
+		node->add_child_text(boost::any_cast<dcp::Fraction>(value).as_string());
+	} else if (type == typeid(dcp::Size)) {
+		auto size = boost::any_cast<dcp::Size>(value);
+		node->set_attribute("type", "size");
+		node->add_child_text(fmt::format("{} {}", size.width, size.height));
+	} else if (type == typeid(dcp::Time)) {
+		auto time = boost::any_cast<dcp::Time>(value);
+		node->set_attribute("type", "time");
+		node->add_child_text(fmt::format("{} {} {} {} {}", time.h, time.m, time.s, time.e, time.tcr));
+	} else {
+		DCP_ASSERT(false);
+	}
+}
+
+
+static boost::any
+any_from_xml(cxml::ConstNodePtr node)
+{
+	auto const type = node->string_attribute("type");
+	auto const content = node->content();
+
+	if (type == "string") {
+		return content;
+	} else if (type == "int") {
+		return raw_convert<int>(content);
+	} else if (type == "uint64") {
+		return raw_convert<uint64_t>(content);
+	} else if (type == "int64") {
+		return raw_convert<int64_t>(content);
+	} else if (type == "path") {
+		return boost::filesystem::path(content);
+	} else if (type == "fraction") {
+		return dcp::Fraction(content);
+	}
+
+	vector<string> parts;
+	boost::algorithm::split(parts, content, boost::is_any_of(" "));
+
+	if (type == "size" && parts.size() == 2) {
+		return dcp::Size(raw_convert<int>(parts[0]), raw_convert<int>(parts[1]));
+	} else if (type == "time" && parts.size() == 5) {
+		return dcp::Time(
+			raw_convert<int>(parts[0]),
+			raw_convert<int>(parts[1]),
+			raw_convert<int>(parts[2]),
+			raw_convert<int>(parts[3]),
+			raw_convert<int>(parts[4])
+			);
+	}
+
+	throw XMLError(fmt::format("Unrecognised verification note value of type {}", type));
+}
+
+
+dcp::VerificationNote::VerificationNote(cxml::ConstNodePtr node)
+	: _code(static_cast<Code>(node->number_attribute<int>("code")))
+{
+	for (auto location: node->node_children("Location")) {
+		_location[static_cast<Location>(location->number_attribute<int>("key"))] = any_from_xml(location);
+	}
+
+	for (auto data: node->node_children("Data")) {
+		_data[static_cast<Data>(data->number_attribute<int>("key"))] = any_from_xml(data);
+	}
+}
+
+
+void
+dcp::VerificationNote::as_xml(xmlpp::Element* parent) const
+{
+	auto node = cxml::add_child(parent, "Note");
+	node->set_attribute("code", fmt::to_string(static_cast<int>(_code)));
+
+	for (auto const& location: _location) {
+		any_as_xml(node, "Location", static_cast<int>(location.first), location.second);
+	}
+
+	for (auto const& data: _data) {
+		any_as_xml(node, "Data", static_cast<int>(data.first), data.second);
+	}
+}
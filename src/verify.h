@@ -49,10 +49,17 @@
 #include <boost/function.hpp>
 #include <boost/optional.hpp>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
 
+namespace xmlpp {
+	class Element;
+}
+
+
 /* windows.h defines this but we want to use it */
 #undef ERROR
 
@@ -62,6 +69,7 @@ namespace dcp {
 
 class DCP;
 class TextAsset;
+class VerificationCache;
 
 
 class VerificationNote
@@ -597,6 +605,12 @@ public:
 		 *  file contains the PKL filename
 		 */
 		INVALID_PKL_NAMESPACE,
+		/** Only some frames of a picture asset were given detailed checks, as requested by VerificationOptions::picture_sampling
+		 *  file contains the picture asset filename
+		 *  checked_frames contains the number of frames that were checked
+		 *  duration contains the number of frames in the asset
+		 */
+		SAMPLED_PICTURE_FRAMES,
 	};
 
 	VerificationNote(Code code)
@@ -616,6 +630,14 @@ public:
 		_location[Location::LINE] = line;
 	}
 
+	/** Read a VerificationNote which was written by as_xml() */
+	explicit VerificationNote(cxml::ConstNodePtr node);
+
+	/** Add a &lt;Note&gt; node describing this note to parent.  The code is written as a number,
+	 *  so the XML should only be read back by the same version of libdcp.
+	 */
+	void as_xml(xmlpp::Element* parent) const;
+
 	Type type() const;
 
 	Code code () const {
@@ -643,6 +665,7 @@ private:
 		BIT_DEPTH,
 		CALCULATED_HASH,
 		CAPABILITIES,
+		CHECKED_FRAMES,
 		CODE_BLOCK_HEIGHT,
 		CODE_BLOCK_WIDTH,
 		CONTENT_KIND,
@@ -949,6 +972,15 @@ public:
 		return data<int64_t>(Data::DURATION);
 	}
 
+	VerificationNote& set_checked_frames(int64_t checked_frames) {
+		_data[Data::CHECKED_FRAMES] = std::move(checked_frames);
+		return *this;
+	}
+
+	boost::optional<int64_t> checked_frames() const {
+		return data<int64_t>(Data::CHECKED_FRAMES);
+	}
+
 	VerificationNote& set_other_duration(int64_t other_duration) {
 		_data[Data::OTHER_DURATION] = std::move(other_duration);
 		return *this;
@@ -1010,6 +1042,50 @@ private:
 };
 
 
+/** @class PictureSampling
+ *  @brief A choice of which frames of each picture asset should be given detailed checks
+ *  (frame sizes and J2K bitstream) by dcp::verify().
+ */
+class PictureSampling
+{
+public:
+	/** Check every frame */
+	PictureSampling() = default;
+
+	/** Check frames 0, n, 2n and so on */
+	static PictureSampling every_nth_frame(int n);
+	/** Check a random selection of frames, which is the same each time for a given seed */
+	static PictureSampling random(int frames, uint32_t seed);
+	/** Check some frames at the start and end of each picture asset */
+	static PictureSampling reel_heads_and_tails(int frames);
+
+	/** @return indices of the frames to check in an asset of the given duration, in ascending order */
+	std::vector<int64_t> frames(int64_t duration) const;
+
+	/** @return a string which describes this sampling, and which differs between samplings that would check different frames */
+	std::string as_string() const;
+
+private:
+	enum class Mode {
+		ALL,
+		EVERY_NTH_FRAME,
+		RANDOM,
+		REEL_HEADS_AND_TAILS
+	};
+
+	PictureSampling(Mode mode, int parameter, uint32_t seed)
+		: _mode(mode)
+		, _parameter(parameter)
+		, _seed(seed)
+	{}
+
+	Mode _mode = Mode::ALL;
+	/** n for EVERY_NTH_FRAME, otherwise number of frames */
+	int _parameter = 0;
+	uint32_t _seed = 0;
+};
+
+
 struct VerificationOptions
 {
 	///< If set, any assets larger than this number of bytes will not have their hashes checked
@@ -1019,6 +1095,12 @@ struct VerificationOptions
 	bool check_asset_hashes = true;
 	///< true to do some time-consuming detailed picture checks (e.g. J2K bitstream)
 	bool check_picture_details = true;
+	///< Frames of each picture asset to check when check_picture_details is true
+	PictureSampling picture_sampling;
+	///< If set, asset hashes and the results of detailed picture checks are taken from here when
+	///< the asset file has not changed since they were stored, and new results are added to it.
+	///< The cache is saved at the end of dcp::verify().
+	std::shared_ptr<VerificationCache> cache;
 };
 
 
@@ -1050,6 +1132,51 @@ bool operator< (dcp::VerificationNote const& a, dcp::VerificationNote const& b);
 
 std::ostream& operator<<(std::ostream& s, dcp::VerificationNote const& note);
 
+
+/** @class VerificationNoteSink
+ *  @brief Receiver for VerificationNotes as they are found by dcp::verify().
+ */
+class VerificationNoteSink
+{
+public:
+	/** @param handler Handler to call with each note.
+	 *  @param deduplicate true to call the handler only once for each distinct note.  To do this the
+	 *  sink must remember every distinct note that it has seen, so its memory use will grow with the
+	 *  number of different notes (but not with repeats of the same note).
+	 */
+	explicit VerificationNoteSink(std::function<void (VerificationNote const&)> handler, bool deduplicate = false)
+		: _handler(handler)
+		, _deduplicate(deduplicate)
+	{}
+
+	void add(VerificationNote const& note);
+
+	/** @return the number of notes that have been passed to the handler */
+	int64_t count() const {
+		return _count;
+	}
+
+private:
+	std::function<void (VerificationNote const&)> _handler;
+	bool _deduplicate = false;
+	std::set<VerificationNote> _seen;
+	int64_t _count = 0;
+};
+
+
+/** Verify some DCPs, passing notes to a sink as they are found rather than collecting them.
+ *  Each DCP is released as soon as its checks are finished.
+ */
+void verify(
+	std::vector<boost::filesystem::path> directories,
+	std::vector<dcp::DecryptedKDM> kdms,
+	std::function<void (std::string, boost::optional<boost::filesystem::path>)> stage,
+	std::function<void (float)> progress,
+	VerificationNoteSink& sink,
+	VerificationOptions options = {},
+	boost::optional<boost::filesystem::path> xsd_dtd_directory = boost::optional<boost::filesystem::path>()
+	);
+
 }
 
 #endif
@@ -45,6 +45,8 @@
 
 
 #include "cpl.h"
+#include "scope_guard.h"
+#include "verification_shard.h"
 #include "verify.h"
 #include <boost/filesystem.hpp>
 #include <boost/optional.hpp>
@@ -77,24 +79,38 @@ class Context
 {
 public:
 	Context(
-		std::vector<VerificationNote>& notes_,
+		std::function<void (VerificationNote const&)> sink_,
 		boost::filesystem::path xsd_dtd_directory_,
 		std::function<void (std::string, boost::optional<boost::filesystem::path>)> stage_,
 		std::function<void (float)> progress_,
 		VerificationOptions options_
 	       )
-		: notes(notes_)
+		: sink(sink_)
 		, xsd_dtd_directory(xsd_dtd_directory_)
 		, stage(stage_)
 		, progress(progress_)
 		, options(options_)
 	{}
 
+	Context(
+		std::vector<VerificationNote>& notes_,
+		boost::filesystem::path xsd_dtd_directory_,
+		std::function<void (std::string, boost::optional<boost::filesystem::path>)> stage_,
+		std::function<void (float)> progress_,
+		VerificationOptions options_
+	       )
+		: Context([&notes_](VerificationNote const& note) { notes_.push_back(note); }, xsd_dtd_directory_, stage_, progress_, options_)
+	{}
+
 	Context(Context const&) = delete;
 	Context& operator=(Context const&) = delete;
 
 	void add_note(dcp::VerificationNote note)
 	{
+		if (shard && !in_sharded_check && shard->index() != 0) {
+			/* Only the first shard reports the results of checks which are not sharded */
+			return;
+		}
 		if (cpl) {
 			note.set_cpl_id(cpl->id());
 		}
@@ -104,7 +120,7 @@ public:
 		if (asset_id) {
 			note.set_asset_id(*asset_id);
 		}
-		notes.push_back(std::move(note));
+		sink(note);
 	}
 
 	template<typename... Args>
@@ -113,11 +129,25 @@ public:
 		add_note(dcp::VerificationNote{code, std::forward<Args>(args)...});
 	}
 
-	void add_note_if_not_existing(dcp::VerificationNote note)
+	/** Run some expensive checks of an asset, if they have been given to this shard.
+	 *  Every shard must make the same calls to this method, in the same order.
+	 */
+	void sharded_check(std::string const& asset_id, std::function<void ()> check)
 	{
-		if (find(notes.begin(), notes.end(), note) == notes.end()) {
-			add_note(note);
+		auto const number = sharded_checks++;
+		if (!shard) {
+			check();
+			return;
 		}
+
+		auto const done = shard->owns(asset_id);
+		shard_section(number, done);
+		if (done) {
+			in_sharded_check = true;
+			dcp::ScopeGuard sg = [this]() { in_sharded_check = false; };
+			check();
+		}
+		shard_section({}, true);
 	}
 
 	bool should_verify_asset(std::string const& id)
@@ -127,7 +157,8 @@ public:
 		return should;
 	}
 
-	std::vector<VerificationNote>& notes;
+	/** Called with each note as it is found */
+	std::function<void (VerificationNote const&)> sink;
 	std::shared_ptr<const DCP> dcp;
 	std::shared_ptr<const CPL> cpl;
 	boost::optional<int> reel_index;
@@ -141,6 +172,16 @@ public:
 
 	boost::optional<std::string> subtitle_language;
 	boost::optional<int> audio_channels;
+
+	/** Shard that we are verifying, or empty to verify everything */
+	boost::optional<VerificationShard> shard;
+	/** Called with the number of a sharded check, and whether this shard is doing it, when the check
+	 *  starts; then called with an empty number when the check is finished.
+	 */
+	std::function<void (boost::optional<int>, bool)> shard_section;
+	/** Number of calls to sharded_check() so far */
+	int sharded_checks = 0;
+	bool in_sharded_check = false;
 };
 
 
@@ -0,0 +1,149 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/xyz_image.cc
+ *  @brief XYZImage class
+ */
+
+
+#include "dcp_assert.h"
+#include "exceptions.h"
+#include "openjpeg_image.h"
+#include "xyz_image.h"
+#include <openjpeg.h>
+#include <algorithm>
+
+
+using std::make_shared;
+using std::max;
+using std::min;
+using std::shared_ptr;
+using namespace dcp;
+
+
+XYZImage::XYZImage(Size size)
+	: _size(size)
+	, _data(size.width * size.height * 3)
+{
+
+}
+
+
+/** @return the size of an image that we can copy into an XYZImage, throwing J2KDecompressionError
+ *  if it does not have 3 unsigned, full-size components of at most 16 bits.
+ */
+static Size
+checked_size(opj_image_t const* image)
+{
+	if (image->numcomps != 3) {
+		throw J2KDecompressionError("JPEG2000 image does not have 3 components");
+	}
+
+	if (image->x1 <= image->x0 || image->y1 <= image->y0) {
+		throw J2KDecompressionError("JPEG2000 image is empty");
+	}
+
+	Size const size(image->x1 - image->x0, image->y1 - image->y0);
+
+	for (int c = 0; c < 3; ++c) {
+		auto const& comp = image->comps[c];
+		if (comp.dx != 1 || comp.dy != 1) {
+			throw J2KDecompressionError("JPEG2000 image has a subsampled component");
+		}
+		if (static_cast<int>(comp.w) != size.width || static_cast<int>(comp.h) != size.height) {
+			throw J2KDecompressionError("JPEG2000 image has a component whose size is not the same as the image's");
+		}
+		if (comp.sgnd || comp.prec > 16) {
+			throw J2KDecompressionError("JPEG2000 image has a signed component, or one of more than 16 bits");
+		}
+		if (!comp.data) {
+			throw J2KDecompressionError("JPEG2000 image has a component with no data");
+		}
+	}
+
+	return size;
+}
+
+
+XYZImage::XYZImage(opj_image_t const* image)
+	: _size(checked_size(image))
+	, _data(_size.width * _size.height * 3)
+{
+	auto const pixels = _size.width * _size.height;
+	for (int c = 0; c < 3; ++c) {
+		auto in = image->comps[c].data;
+		auto out = data(c);
+		for (int i = 0; i < pixels; ++i) {
+			*out++ = min(max(*in++, 0), 65535);
+		}
+	}
+}
+
+
+XYZImage::XYZImage(OpenJPEGImage const& image)
+	: XYZImage(image.opj_image())
+{
+
+}
+
+
+uint16_t*
+XYZImage::data(int c)
+{
+	DCP_ASSERT(c >= 0 && c < 3);
+	return _data.data() + c * _size.width * _size.height;
+}
+
+
+uint16_t const*
+XYZImage::data(int c) const
+{
+	DCP_ASSERT(c >= 0 && c < 3);
+	return _data.data() + c * _size.width * _size.height;
+}
+
+
+shared_ptr<OpenJPEGImage>
+XYZImage::to_openjpeg() const
+{
+	auto image = make_shared<OpenJPEGImage>(_size);
+
+	auto const pixels = _size.width * _size.height;
+	for (int c = 0; c < 3; ++c) {
+		std::copy(data(c), data(c) + pixels, image->data(c));
+	}
+
+	return image;
+}
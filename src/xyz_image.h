@@ -0,0 +1,107 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/xyz_image.h
+ *  @brief XYZImage class
+ */
+
+
+#ifndef LIBDCP_XYZ_IMAGE_H
+#define LIBDCP_XYZ_IMAGE_H
+
+
+#include "types.h"
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+
+struct opj_image;
+typedef struct opj_image opj_image_t;
+
+
+namespace dcp {
+
+
+class OpenJPEGImage;
+
+
+/** @class XYZImage
+ *  @brief A 3-component image (usually 12-bit XYZ) with each component stored as a 16-bit plane.
+ *
+ *  This holds the same data as an OpenJPEGImage in half the memory, which makes it a better
+ *  choice for keeping decoded frames around, and faster to work on when converting colours.
+ */
+class XYZImage
+{
+public:
+	/** Construct a black XYZImage, with every sample set to 0
+	 *  @param size Size in pixels
+	 */
+	explicit XYZImage(Size size);
+
+	/** Construct an XYZImage from a copy of the data in an opj_image_t.  J2KDecompressionError is thrown
+	 *  unless the image has 3 unsigned components of at most 16 bits, each the full size of the image.
+	 */
+	explicit XYZImage(opj_image_t const* image);
+
+	/** Construct an XYZImage from a copy of the data in an OpenJPEGImage */
+	explicit XYZImage(OpenJPEGImage const& image);
+
+	/** @param c Component index (0, 1 or 2)
+	 *  @return Pointer to the data for component c.
+	 */
+	uint16_t* data(int c);
+	uint16_t const* data(int c) const;
+
+	/** @return Size of the image in pixels */
+	Size size() const {
+		return _size;
+	}
+
+	/** @return A new OpenJPEGImage (and hence opj_image_t) containing a copy of this image's data */
+	std::shared_ptr<OpenJPEGImage> to_openjpeg() const;
+
+private:
+	Size _size;
+	/** All three planes, one after the other */
+	std::vector<uint16_t> _data;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,301 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/yuv_xyz.cc
+ *  @brief Conversion between YUV420P FFmpegImages and XYZ
+ */
+
+
+#include "colour_conversion.h"
+#include "dcp_assert.h"
+#include "openjpeg_image.h"
+#include "piecewise_lut.h"
+#include "rgb_xyz.h"
+#include "transfer_function.h"
+#include "yuv_xyz.h"
+extern "C" {
+#include <libavutil/pixfmt.h>
+}
+#include <cmath>
+
+
+using std::make_shared;
+using std::max;
+using std::min;
+using std::shared_ptr;
+using std::vector;
+using namespace dcp;
+
+
+static auto constexpr DCI_COEFFICIENT = 48.0 / 52.37;
+
+/** Number of rows that we convert in one go; the working buffers for a band this
+ *  size stay in cache, and bands are what we share out between OpenMP threads.
+ */
+static int constexpr band_height = 16;
+
+
+namespace {
+
+/** Coefficients for the conversion of Y'CbCr (with Y' in [0, 1] and CbCr in [-0.5, 0.5]) to and from R'G'B' */
+class YUVMatrix
+{
+public:
+	explicit YUVMatrix(YUVToRGB yuv_to_rgb)
+	{
+		switch (yuv_to_rgb) {
+		case YUVToRGB::REC601:
+			kr = 0.299f;
+			kb = 0.114f;
+			break;
+		case YUVToRGB::REC709:
+			kr = 0.2126f;
+			kb = 0.0722f;
+			break;
+		case YUVToRGB::REC2020:
+			kr = 0.2627f;
+			kb = 0.0593f;
+			break;
+		default:
+			DCP_ASSERT(false);
+		}
+
+		kg = 1 - kr - kb;
+		cr_to_r = 2 * (1 - kr);
+		cb_to_b = 2 * (1 - kb);
+		cb_to_g = -cb_to_b * kb / kg;
+		cr_to_g = -cr_to_r * kr / kg;
+	}
+
+	float kr = 0;
+	float kg = 0;
+	float kb = 0;
+	float cr_to_r = 0;
+	float cb_to_b = 0;
+	float cb_to_g = 0;
+	float cr_to_g = 0;
+};
+
+
+inline int
+clamp_12_bit(float value)
+{
+	return lrintf(min(max(value, 0.0f), 1.0f) * 4095);
+}
+
+
+inline uint8_t
+clamp_8_bit(float value)
+{
+	return static_cast<uint8_t>(lrintf(min(max(value, 0.0f), 255.0f)));
+}
+
+}
+
+
+shared_ptr<OpenJPEGImage>
+dcp::yuv_to_xyz(FFmpegImage const& yuv, ColourConversion const& conversion)
+{
+	DCP_ASSERT(yuv.frame()->format == AV_PIX_FMT_YUV420P);
+
+	auto const size = yuv.size();
+	auto xyz = make_shared<OpenJPEGImage>(size);
+
+	YUVMatrix const yuv_matrix(conversion.yuv_to_rgb());
+
+	bool const full_range = yuv.frame()->color_range == AVCOL_RANGE_JPEG;
+	float const luma_offset = full_range ? 0 : 16;
+	float const luma_scale = full_range ? 1 / 255.0f : 1 / 219.0f;
+	float const chroma_scale = full_range ? 1 / 255.0f : 1 / 224.0f;
+
+	auto const lut_in = conversion.in()->double_lut(0, 1, 12, false);
+	auto const lut_out = make_inverse_gamma_lut(conversion.out());
+
+	/* This is is the product of the RGB to XYZ matrix, the Bradford transform and the DCI companding */
+	double fast_matrix[9];
+	combined_rgb_to_xyz(conversion, fast_matrix);
+
+	int const bands = (size.height + band_height - 1) / band_height;
+
+#ifdef LIBDCP_OPENMP
+#pragma omp parallel for
+#endif
+	for (int band = 0; band < bands; ++band) {
+		/* Gamma-corrected RGB for one row; kept as separate planes so that the YUV to RGB
+		 * loop below can be vectorised by the compiler.
+		 */
+		vector<float> red(size.width);
+		vector<float> green(size.width);
+		vector<float> blue(size.width);
+
+		int const end = min(size.height, (band + 1) * band_height);
+		for (int y = band * band_height; y < end; ++y) {
+			auto const luma = yuv.y() + y * yuv.y_stride();
+			auto const cb = yuv.u() + (y / 2) * yuv.u_stride();
+			auto const cr = yuv.v() + (y / 2) * yuv.v_stride();
+
+			/* YUV to RGB */
+			for (int x = 0; x < size.width; ++x) {
+				float const l = (luma[x] - luma_offset) * luma_scale;
+				float const pb = (cb[x / 2] - 128) * chroma_scale;
+				float const pr = (cr[x / 2] - 128) * chroma_scale;
+				red[x] = l + yuv_matrix.cr_to_r * pr;
+				green[x] = l + yuv_matrix.cb_to_g * pb + yuv_matrix.cr_to_g * pr;
+				blue[x] = l + yuv_matrix.cb_to_b * pb;
+			}
+
+			int* xyz_x = xyz->data(0) + y * size.width;
+			int* xyz_y = xyz->data(1) + y * size.width;
+			int* xyz_z = xyz->data(2) + y * size.width;
+
+			for (int x = 0; x < size.width; ++x) {
+				/* In gamma LUT */
+				double const sr = lut_in[clamp_12_bit(red[x])];
+				double const sg = lut_in[clamp_12_bit(green[x])];
+				double const sb = lut_in[clamp_12_bit(blue[x])];
+
+				/* RGB to XYZ, Bradford transform and DCI companding */
+				double const dx = sr * fast_matrix[0] + sg * fast_matrix[1] + sb * fast_matrix[2];
+				double const dy = sr * fast_matrix[3] + sg * fast_matrix[4] + sb * fast_matrix[5];
+				double const dz = sr * fast_matrix[6] + sg * fast_matrix[7] + sb * fast_matrix[8];
+
+				/* Clamp and out gamma LUT */
+				*xyz_x++ = lut_out.lookup(min(max(dx, 0.0), 1.0));
+				*xyz_y++ = lut_out.lookup(min(max(dy, 0.0), 1.0));
+				*xyz_z++ = lut_out.lookup(min(max(dz, 0.0), 1.0));
+			}
+		}
+	}
+
+	return xyz;
+}
+
+
+FFmpegImage
+dcp::xyz_to_yuv(shared_ptr<const OpenJPEGImage> xyz, ColourConversion const& conversion)
+{
+	auto const size = xyz->size();
+	FFmpegImage yuv(size, 0);
+
+	YUVMatrix const yuv_matrix(conversion.yuv_to_rgb());
+
+	auto const lut_in = conversion.out()->double_lut(0, 1, 12, false);
+	auto const lut_out = conversion.in()->double_lut(0, 1, 16, true);
+	auto const matrix = conversion.xyz_to_rgb();
+
+	double const fast_matrix[9] = {
+		matrix(0, 0) / DCI_COEFFICIENT, matrix(0, 1) / DCI_COEFFICIENT, matrix(0, 2) / DCI_COEFFICIENT,
+		matrix(1, 0) / DCI_COEFFICIENT, matrix(1, 1) / DCI_COEFFICIENT, matrix(1, 2) / DCI_COEFFICIENT,
+		matrix(2, 0) / DCI_COEFFICIENT, matrix(2, 1) / DCI_COEFFICIENT, matrix(2, 2) / DCI_COEFFICIENT
+	};
+
+	/* band_height is even, so each band covers whole rows of chroma */
+	static_assert(band_height % 2 == 0, "band_height must be even");
+	int const bands = (size.height + band_height - 1) / band_height;
+	int const chroma_width = (size.width + 1) / 2;
+
+#ifdef LIBDCP_OPENMP
+#pragma omp parallel for
+#endif
+	for (int band = 0; band < bands; ++band) {
+		/* Gamma-corrected RGB for a pair of rows */
+		vector<float> red(size.width * 2);
+		vector<float> green(size.width * 2);
+		vector<float> blue(size.width * 2);
+
+		int const end = min(size.height, (band + 1) * band_height);
+		for (int y = band * band_height; y < end; y += 2) {
+			int const rows = min(2, end - y);
+
+			for (int row = 0; row < rows; ++row) {
+				auto xyz_x = xyz->data(0) + (y + row) * size.width;
+				auto xyz_y = xyz->data(1) + (y + row) * size.width;
+				auto xyz_z = xyz->data(2) + (y + row) * size.width;
+				auto r = red.data() + row * size.width;
+				auto g = green.data() + row * size.width;
+				auto b = blue.data() + row * size.width;
+
+				for (int x = 0; x < size.width; ++x) {
+					/* In gamma LUT */
+					double const sx = lut_in[max(min(xyz_x[x], 4095), 0)];
+					double const sy = lut_in[max(min(xyz_y[x], 4095), 0)];
+					double const sz = lut_in[max(min(xyz_z[x], 4095), 0)];
+
+					/* DCI companding and XYZ to RGB */
+					double const dr = sx * fast_matrix[0] + sy * fast_matrix[1] + sz * fast_matrix[2];
+					double const dg = sx * fast_matrix[3] + sy * fast_matrix[4] + sz * fast_matrix[5];
+					double const db = sx * fast_matrix[6] + sy * fast_matrix[7] + sz * fast_matrix[8];
+
+					/* Clamp and out gamma LUT */
+					r[x] = lut_out[lrint(min(max(dr, 0.0), 1.0) * 65535)];
+					g[x] = lut_out[lrint(min(max(dg, 0.0), 1.0) * 65535)];
+					b[x] = lut_out[lrint(min(max(db, 0.0), 1.0) * 65535)];
+				}
+
+				/* RGB to Y */
+				auto luma = yuv.y() + (y + row) * yuv.y_stride();
+				for (int x = 0; x < size.width; ++x) {
+					luma[x] = clamp_8_bit(16 + 219 * (yuv_matrix.kr * r[x] + yuv_matrix.kg * g[x] + yuv_matrix.kb * b[x]));
+				}
+			}
+
+			/* Average each 2x2 block of RGB and convert that to U and V */
+			auto cb = yuv.u() + (y / 2) * yuv.u_stride();
+			auto cr = yuv.v() + (y / 2) * yuv.v_stride();
+			for (int cx = 0; cx < chroma_width; ++cx) {
+				float r = 0;
+				float g = 0;
+				float b = 0;
+				int n = 0;
+				for (int row = 0; row < rows; ++row) {
+					for (int x = cx * 2; x < min(cx * 2 + 2, size.width); ++x) {
+						r += red[row * size.width + x];
+						g += green[row * size.width + x];
+						b += blue[row * size.width + x];
+						++n;
+					}
+				}
+				r /= n;
+				g /= n;
+				b /= n;
+				float const l = yuv_matrix.kr * r + yuv_matrix.kg * g + yuv_matrix.kb * b;
+				cb[cx] = clamp_8_bit(128 + 224 * (b - l) / yuv_matrix.cb_to_b);
+				cr[cx] = clamp_8_bit(128 + 224 * (r - l) / yuv_matrix.cr_to_r);
+			}
+		}
+	}
+
+	return yuv;
+}
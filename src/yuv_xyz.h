@@ -0,0 +1,85 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+/** @file  src/yuv_xyz.h
+ *  @brief Conversion between YUV420P FFmpegImages and XYZ
+ */
+
+
+#ifndef LIBDCP_YUV_XYZ_H
+#define LIBDCP_YUV_XYZ_H
+
+
+#include "ffmpeg_image.h"
+#include <memory>
+
+
+namespace dcp {
+
+
+class ColourConversion;
+class OpenJPEGImage;
+
+
+/** Convert a YUV420P image (such as one decoded from an MPEG2 asset) straight to
+ *  12-bit XYZ, without going through any intermediate RGB image.
+ *
+ *  The YUV to RGB matrix is taken from conversion.yuv_to_rgb(), and the rest of the
+ *  conversion is the same as in rgb_to_xyz().  Unless the image's AVFrame says that it
+ *  is full-range it is assumed to be video-range (16-235 for Y, 16-240 for U/V).
+ *  Chroma is upsampled by repeating each sample.
+ *
+ *  @param yuv Image to convert.
+ *  @param conversion Colour conversion to use.
+ *  @return XYZ image of the same size as yuv.
+ */
+extern std::shared_ptr<OpenJPEGImage> yuv_to_xyz(FFmpegImage const& yuv, ColourConversion const& conversion);
+
+
+/** Convert a 12-bit XYZ image to a video-range YUV420P image, without going through
+ *  any intermediate RGB image.  This is the inverse of yuv_to_xyz(), with chroma
+ *  downsampled by averaging each 2x2 block.
+ *
+ *  @param xyz Image to convert.
+ *  @param conversion Colour conversion to use.
+ *  @return YUV420P image of the same size as xyz, with a PTS of 0.
+ */
+extern FFmpegImage xyz_to_yuv(std::shared_ptr<const OpenJPEGImage> xyz, ColourConversion const& conversion);
+
+
+}
+
+
+#endif
@@ -0,0 +1,260 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+#include "equality_options.h"
+#include "j2k_transcode.h"
+#include "mono_j2k_picture_asset.h"
+#include "openjpeg_image.h"
+#include "sound_asset.h"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+
+using std::make_shared;
+using std::string;
+using std::vector;
+
+
+static bool
+has_note(vector<string> const& notes, string note)
+{
+	return std::find(notes.begin(), notes.end(), note) != notes.end();
+}
+
+
+BOOST_AUTO_TEST_CASE(asset_equality_identical_files_test)
+{
+	boost::filesystem::path const dir = "build/test/asset_equality_identical_files_test";
+	boost::filesystem::remove_all(dir);
+	boost::filesystem::create_directories(dir);
+	boost::filesystem::copy_file("test/ref/DCP/dcp_test1/video.mxf", dir / "video.mxf");
+	boost::filesystem::copy_file("test/ref/DCP/dcp_test1/audio.mxf", dir / "audio.mxf");
+
+	vector<string> notes;
+	auto note = [&notes](dcp::NoteType, string message) { notes.push_back(message); };
+
+	auto picture = make_shared<dcp::MonoJ2KPictureAsset>("test/ref/DCP/dcp_test1/video.mxf");
+	BOOST_CHECK(picture->equals(picture, dcp::EqualityOptions(), note));
+	BOOST_CHECK(has_note(notes, "Asset files are the same file"));
+
+	notes.clear();
+	auto picture_copy = make_shared<dcp::MonoJ2KPictureAsset>(dir / "video.mxf");
+	BOOST_CHECK(picture->equals(picture_copy, dcp::EqualityOptions(), note));
+	BOOST_CHECK(has_note(notes, "Asset files are identical"));
+
+	notes.clear();
+	auto sound = make_shared<dcp::SoundAsset>("test/ref/DCP/dcp_test1/audio.mxf");
+	auto sound_copy = make_shared<dcp::SoundAsset>(dir / "audio.mxf");
+	BOOST_CHECK(sound->equals(sound_copy, dcp::EqualityOptions(), note));
+	BOOST_CHECK(has_note(notes, "Asset files are identical"));
+}
+
+
+BOOST_AUTO_TEST_CASE(asset_equality_known_hashes_test)
+{
+	boost::filesystem::path const dir = "build/test/asset_equality_known_hashes_test";
+	boost::filesystem::remove_all(dir);
+	boost::filesystem::create_directories(dir);
+	boost::filesystem::copy_file("test/ref/DCP/dcp_test1/video.mxf", dir / "video.mxf");
+
+	vector<string> notes;
+	auto note = [&notes](dcp::NoteType, string message) { notes.push_back(message); };
+
+	auto a = make_shared<dcp::MonoJ2KPictureAsset>("test/ref/DCP/dcp_test1/video.mxf");
+	auto b = make_shared<dcp::MonoJ2KPictureAsset>(dir / "video.mxf");
+
+	dcp::EqualityOptions options;
+	options.trust_known_hashes = true;
+
+	a->set_hash("foo");
+	b->set_hash("foo");
+	BOOST_CHECK(a->equals(b, options, note));
+	BOOST_CHECK(has_note(notes, "Asset hashes are the same"));
+
+	/* With different known hashes the frames should be compared */
+	notes.clear();
+	b->set_hash("bar");
+	BOOST_CHECK(a->equals(b, options, note));
+	BOOST_CHECK(!has_note(notes, "Asset hashes are the same"));
+	BOOST_CHECK(has_note(notes, "J2K identical"));
+}
+
+
+BOOST_AUTO_TEST_CASE(asset_equality_untrusted_known_hashes_test)
+{
+	boost::filesystem::path const dir = "build/test/asset_equality_untrusted_known_hashes_test";
+	boost::filesystem::remove_all(dir);
+	boost::filesystem::create_directories(dir);
+	boost::filesystem::copy_file("test/ref/DCP/dcp_test1/video.mxf", dir / "video.mxf");
+
+	/* Make a file which is the same size but not the same as the original */
+	auto mod = fopen((dir / "video.mxf").string().c_str(), "r+b");
+	BOOST_REQUIRE(mod);
+	BOOST_REQUIRE_EQUAL(fseek(mod, -16, SEEK_END), 0);
+	int x = 42;
+	BOOST_REQUIRE(fwrite(&x, sizeof(x), 1, mod) == 1);
+	fclose(mod);
+
+	vector<string> notes;
+	auto note = [&notes](dcp::NoteType, string message) { notes.push_back(message); };
+
+	auto a = make_shared<dcp::MonoJ2KPictureAsset>("test/ref/DCP/dcp_test1/video.mxf");
+	auto b = make_shared<dcp::MonoJ2KPictureAsset>(dir / "video.mxf");
+
+	/* Without trust_known_hashes these (wrong) hashes should be ignored and the frames compared */
+	a->set_hash("foo");
+	b->set_hash("foo");
+	BOOST_CHECK(a->equals(b, dcp::EqualityOptions(), note));
+	BOOST_CHECK(!has_note(notes, "Asset hashes are the same"));
+	BOOST_CHECK(!has_note(notes, "Asset files are identical"));
+	BOOST_CHECK(has_note(notes, "J2K identical"));
+}
+
+
+/** MonoJ2KPictureAsset with its frame comparison made public so that we can test it */
+class FrameComparingAsset : public dcp::MonoJ2KPictureAsset
+{
+public:
+	FrameComparingAsset()
+		: dcp::MonoJ2KPictureAsset(dcp::Fraction(24, 1), dcp::Standard::SMPTE)
+	{}
+
+	using dcp::J2KPictureAsset::frame_buffer_equals;
+};
+
+
+static bool
+find_note(vector<string> const& notes, string prefix, string& found)
+{
+	for (auto const& i: notes) {
+		if (i.substr(0, prefix.length()) == prefix) {
+			found = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+BOOST_AUTO_TEST_CASE(asset_equality_frame_statistics_test)
+{
+	dcp::Size const size(1998, 1080);
+
+	auto image_a = make_shared<dcp::OpenJPEGImage>(size);
+	auto image_b = make_shared<dcp::OpenJPEGImage>(size);
+	for (int c = 0; c < 3; ++c) {
+		for (int y = 0; y < size.height; ++y) {
+			for (int x = 0; x < size.width; ++x) {
+				auto const offset = y * size.width + x;
+				image_a->data(c)[offset] = ((x + y) * 4 + c * 512) % 4096;
+				image_b->data(c)[offset] = image_a->data(c)[offset];
+			}
+		}
+	}
+	/* Make B a bit different in the top-left corner */
+	for (int y = 0; y < 64; ++y) {
+		for (int x = 0; x < 256; ++x) {
+			image_b->data(0)[y * size.width + x] = 4095 - image_a->data(0)[y * size.width + x];
+		}
+	}
+
+	auto const j2k_a = dcp::compress_j2k(image_a, 100000000, 24, false, false);
+	auto const j2k_b = dcp::compress_j2k(image_b, 100000000, 24, false, false);
+
+	/* Work out the statistics that we expect from the decoded frames, the long way round */
+	auto const decoded_a = dcp::decompress_j2k(j2k_a, 0);
+	auto const decoded_b = dcp::decompress_j2k(j2k_b, 0);
+	vector<int> differences;
+	for (int c = 0; c < 3; ++c) {
+		for (int i = 0; i < size.width * size.height; ++i) {
+			differences.push_back(std::abs(decoded_a->data(c)[i] - decoded_b->data(c)[i]));
+		}
+	}
+	double mean = 0;
+	for (auto i: differences) {
+		mean += i;
+	}
+	mean /= differences.size();
+	double variance = 0;
+	for (auto i: differences) {
+		variance += pow(i - mean, 2);
+	}
+	auto const std_dev = sqrt(variance / differences.size());
+	auto const max_diff = *std::max_element(differences.begin(), differences.end());
+	BOOST_REQUIRE(mean > 0);
+
+	FrameComparingAsset asset;
+	vector<string> notes;
+	auto note = [&notes](dcp::NoteType, string message) { notes.push_back(message); };
+
+	dcp::EqualityOptions options;
+	options.max_mean_pixel_error = 4096;
+	options.max_std_dev_pixel_error = 4096;
+	BOOST_CHECK(asset.frame_buffer_equals(0, options, note, j2k_a.data(), j2k_a.size(), j2k_b.data(), j2k_b.size()));
+
+	string summary;
+	BOOST_REQUIRE(find_note(notes, "mean difference ", summary));
+	double note_mean;
+	double note_std_dev;
+	int note_max;
+	BOOST_REQUIRE_EQUAL(sscanf(summary.c_str(), "mean difference %lf deviation %lf maximum %d", &note_mean, &note_std_dev, &note_max), 3);
+	/* The note's numbers are only written with 6 significant figures */
+	BOOST_CHECK_CLOSE(note_mean, mean, 1e-3);
+	BOOST_CHECK_CLOSE(note_std_dev, std_dev, 1e-3);
+	BOOST_CHECK_EQUAL(note_max, max_diff);
+
+	/* A standard deviation limit below the real value should fail after the summary */
+	notes.clear();
+	options.max_std_dev_pixel_error = std_dev / 2;
+	BOOST_CHECK(!asset.frame_buffer_equals(0, options, note, j2k_a.data(), j2k_a.size(), j2k_b.data(), j2k_b.size()));
+	BOOST_CHECK(find_note(notes, "mean difference ", summary));
+	BOOST_CHECK(find_note(notes, "standard deviation ", summary));
+
+	/* A mean limit below the real value should stop the comparison early, reporting a lower bound for the mean */
+	notes.clear();
+	options.max_mean_pixel_error = mean / 2;
+	options.max_std_dev_pixel_error = 4096;
+	BOOST_CHECK(!asset.frame_buffer_equals(0, options, note, j2k_a.data(), j2k_a.size(), j2k_b.data(), j2k_b.size()));
+	BOOST_CHECK(!find_note(notes, "mean difference ", summary));
+	string early;
+	BOOST_REQUIRE(find_note(notes, "mean at least ", early));
+	double bound;
+	BOOST_REQUIRE_EQUAL(sscanf(early.c_str(), "mean at least %lf", &bound), 1);
+	BOOST_CHECK(bound > options.max_mean_pixel_error);
+	BOOST_CHECK(bound <= mean * (1 + 1e-5));
+	BOOST_CHECK_EQUAL(notes.size(), 1U);
+}
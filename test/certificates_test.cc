@@ -33,15 +33,18 @@
 
 #include "certificate.h"
 #include "certificate_chain.h"
+#include "certificate_chain_validator.h"
 #include "util.h"
 #include "exceptions.h"
 #include "test.h"
 #include <boost/test/unit_test.hpp>
 #include <iostream>
+#include <set>
 
 using std::list;
 using std::string;
 using std::shared_ptr;
+using std::vector;
 
 /** Check that loading certificates from files via strings works */
 BOOST_AUTO_TEST_CASE (certificates1)
@@ -210,6 +213,61 @@ BOOST_AUTO_TEST_CASE (certificates_validation8)
 	BOOST_CHECK_THROW (bad.root_to_leaf(), dcp::CertificateChainError);
 }
 
+/** Check that dcp::CertificateChainValidator agrees with dcp::CertificateChain::root_to_leaf() */
+BOOST_AUTO_TEST_CASE (certificate_chain_validator_test)
+{
+	dcp::Certificate root (dcp::file_to_string("test/ref/crypt/ca.self-signed.pem"));
+	dcp::Certificate intermediate (dcp::file_to_string("test/ref/crypt/intermediate.signed.pem"));
+	dcp::Certificate leaf (dcp::file_to_string("test/ref/crypt/leaf.signed.pem"));
+
+	vector<dcp::CertificateChain> chains(5);
+	/* Good, in any order */
+	chains[0].add (leaf);
+	chains[0].add (root);
+	chains[0].add (intermediate);
+	/* Good */
+	chains[1].add (root);
+	/* Bad: no root */
+	chains[2].add (intermediate);
+	chains[2].add (leaf);
+	/* Bad: no intermediate */
+	chains[3].add (root);
+	chains[3].add (leaf);
+	/* Bad: no intermediate, and the root twice */
+	chains[4].add (root);
+	chains[4].add (intermediate);
+	chains[4].add (root);
+
+	vector<bool> const expected = { true, true, false, false, false };
+
+	dcp::CertificateChainValidator validator;
+	for (size_t i = 0; i < chains.size(); ++i) {
+		/* The validator should give the same answer as root_to_leaf() (which does not check the private key) */
+		bool chain_ok = true;
+		try {
+			chains[i].root_to_leaf();
+		} catch (dcp::CertificateChainError&) {
+			chain_ok = false;
+		}
+		BOOST_CHECK_EQUAL (chain_ok, expected[i]);
+		/* Check twice to use the remembered results the second time */
+		BOOST_CHECK_EQUAL (validator.valid(chains[i]), expected[i]);
+		BOOST_CHECK_EQUAL (validator.valid(chains[i]), expected[i]);
+	}
+
+	BOOST_CHECK (validator.valid(chains) == expected);
+
+	/* A chain must lead to a trusted certificate, once there are some */
+	dcp::CertificateChainValidator other_root;
+	other_root.add_trusted (dcp::CertificateChain(10 * 365).root());
+	BOOST_CHECK (!other_root.valid(chains[0]));
+
+	dcp::CertificateChainValidator our_root;
+	our_root.add_trusted (root);
+	BOOST_CHECK (our_root.valid(chains[0]));
+}
+
+
 /** Check that we can create a valid chain */
 BOOST_AUTO_TEST_CASE (certificates_validation9)
 {
@@ -233,6 +291,31 @@ BOOST_AUTO_TEST_CASE (certificates_validation10)
 	BOOST_CHECK_NO_THROW (good.root_to_leaf());
 }
 
+/** Check that we can create several valid, independent chains at once */
+BOOST_AUTO_TEST_CASE (certificates_generate)
+{
+	auto chains = dcp::CertificateChain::generate(8, 10 * 365, "dcpomatic.com", "dcpomatic.com", ".dcpomatic.ROOT", ".dcpomatic.INTERMEDIATE", "CS.dcpomatic.LEAF");
+	BOOST_REQUIRE_EQUAL(chains.size(), 8U);
+
+	std::set<string> keys;
+	for (auto const& chain: chains) {
+		BOOST_CHECK(chain.valid());
+		auto certificates = chain.root_to_leaf();
+		BOOST_REQUIRE_EQUAL(certificates.size(), 3U);
+		BOOST_CHECK_EQUAL(certificates[0].subject_common_name(), ".dcpomatic.ROOT");
+		BOOST_CHECK_EQUAL(certificates[1].subject_common_name(), ".dcpomatic.INTERMEDIATE");
+		BOOST_CHECK_EQUAL(certificates[2].subject_common_name(), "CS.dcpomatic.LEAF");
+		BOOST_CHECK_EQUAL(certificates[2].subject_organization_name(), "dcpomatic.com");
+		BOOST_CHECK_EQUAL(certificates[0].serial(), "5");
+		BOOST_CHECK_EQUAL(certificates[1].serial(), "6");
+		BOOST_CHECK_EQUAL(certificates[2].serial(), "7");
+		BOOST_REQUIRE(chain.key());
+		keys.insert(*chain.key());
+	}
+
+	BOOST_CHECK_EQUAL(keys.size(), 8U);
+}
+
 /** Check that dcp::Signer::valid() basically works */
 BOOST_AUTO_TEST_CASE (signer_validation)
 {
@@ -295,7 +378,7 @@ BOOST_AUTO_TEST_CASE(certificate_public_key_digest)
 BOOST_AUTO_TEST_CASE(certificate_dn_qualifiers)
 {
 	for (auto i = 0; i < 50; ++i) {
-		dcp::CertificateChain chain(boost::filesystem::path("openssl"), 10 * 365);
+		dcp::CertificateChain chain(10 * 365);
 		for (auto cert: chain.unordered()) {
 			BOOST_CHECK_EQUAL(dcp::escape_digest(cert.subject_dn_qualifier()), dcp::public_key_digest(cert.public_key()));
 		}
@@ -32,11 +32,13 @@
 */
 
 
+#include "asset_proxy.h"
 #include "combine.h"
 #include "cpl.h"
 #include "dcp.h"
 #include "equality_options.h"
 #include "interop_text_asset.h"
+#include "mono_j2k_picture_asset.h"
 #include "reel_text_asset.h"
 #include "reel_mono_picture_asset.h"
 #include "reel_sound_asset.h"
@@ -45,12 +47,14 @@
 #include "verify.h"
 #include "reel_interop_text_asset.h"
 #include "reel_markers_asset.h"
+#include "sound_asset.h"
 #include <boost/algorithm/string.hpp>
 #include <boost/optional.hpp>
 #include <boost/test/unit_test.hpp>
 #include <iostream>
 
 
+using std::dynamic_pointer_cast;
 using std::list;
 using std::string;
 using std::make_shared;
@@ -173,6 +177,58 @@ BOOST_AUTO_TEST_CASE (combine_single_dcp_test)
 }
 
 
+/** Combine a lazily-read DCP by hand, in the same way as dcp::combine(), and check that the
+ *  assets come out as their real types rather than as proxies.
+ */
+BOOST_AUTO_TEST_CASE(combine_lazily_read_dcp_test)
+{
+	using namespace boost::filesystem;
+	boost::filesystem::path const in = "test/ref/DCP/dcp_test1";
+	boost::filesystem::path const out = "build/test/combine_lazily_read_dcp_test";
+	remove_all(out);
+	create_directories(out);
+
+	dcp::DCP input(in);
+	input.read(nullptr, false, true);
+
+	dcp::DCP output_dcp(out);
+	for (auto i: input.cpls()) {
+		output_dcp.add(i);
+	}
+
+	vector<shared_ptr<dcp::Asset>> assets;
+	int pictures = 0;
+	int sounds = 0;
+	for (auto i: input.assets(true)) {
+		BOOST_CHECK(!dynamic_pointer_cast<dcp::AssetProxy>(i));
+		if (dynamic_pointer_cast<dcp::MonoJ2KPictureAsset>(i)) {
+			++pictures;
+		} else if (dynamic_pointer_cast<dcp::SoundAsset>(i)) {
+			++sounds;
+		}
+		if (!dynamic_pointer_cast<dcp::CPL>(i)) {
+			assets.push_back(i);
+		}
+	}
+	BOOST_CHECK_EQUAL(pictures, 1);
+	BOOST_CHECK_EQUAL(sounds, 1);
+
+	output_dcp.resolve_refs(assets);
+
+	for (auto i: assets) {
+		auto const file = i->file();
+		BOOST_REQUIRE(file);
+		copy_file(*file, out / file->filename());
+		i->set_file_preserving_hash(out / file->filename());
+	}
+
+	output_dcp.write_xml();
+
+	check_no_errors(out);
+	check_combined({in}, out);
+}
+
+
 BOOST_AUTO_TEST_CASE (combine_two_dcps_with_same_asset_filenames_test)
 {
 	using namespace boost::algorithm;
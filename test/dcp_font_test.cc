@@ -89,7 +89,7 @@ BOOST_AUTO_TEST_CASE (interop_dcp_font_test)
 	f.read(ref.get(), 1, size);
 	f.close();
 
-	BOOST_CHECK_EQUAL (memcmp (subs2->_fonts.front().data.data(), ref.get(), size), 0);
+	BOOST_CHECK_EQUAL (memcmp (subs2->_fonts.front().data.get().data(), ref.get(), size), 0);
 }
 
 /** Create a DCP with SMPTE subtitles and check that the font is written and read back correctly */
@@ -126,6 +126,52 @@ BOOST_AUTO_TEST_CASE (smpte_dcp_font_test)
 	f.read(ref.get(), 1, size);
 	f.close();
 
-	BOOST_REQUIRE (subs2->_fonts.front().data.data());
-	BOOST_CHECK_EQUAL (memcmp (subs2->_fonts.front().data.data(), ref.get(), size), 0);
+	BOOST_REQUIRE (subs2->_fonts.front().data.get().data());
+	BOOST_CHECK_EQUAL (memcmp (subs2->_fonts.front().data.get().data(), ref.get(), size), 0);
+}
+
+
+/** Write a DCP with SMPTE subtitles, read it lazily and check that the font comes back, and that two lazily-read
+ *  copies of the subtitle asset share one copy of the font.
+ */
+BOOST_AUTO_TEST_CASE(smpte_dcp_font_lazy_test)
+{
+	boost::filesystem::path directory = "build/test/smpte_dcp_font_lazy_test";
+	boost::filesystem::remove_all(directory);
+	dcp::DCP dcp(directory);
+
+	auto subs = make_shared<dcp::SMPTETextAsset>();
+	subs->add_font("theFontId", dcp::ArrayData("test/data/dummy.ttf"));
+	auto const mxf = directory / "frobozz.mxf";
+	subs->write(mxf);
+
+	auto reel = make_shared<dcp::Reel>();
+	reel->add(make_shared<dcp::ReelSMPTETextAsset>(dcp::TextType::OPEN_SUBTITLE, subs, dcp::Fraction(24, 1), 24, 0));
+
+	auto cpl = make_shared<dcp::CPL>("", dcp::ContentKind::TRAILER, dcp::Standard::SMPTE);
+	cpl->add(reel);
+
+	dcp.add(cpl);
+	dcp.write_xml();
+
+	dcp::DCP dcp2(directory);
+	dcp2.read(nullptr, false, true);
+	auto subs2 = dynamic_pointer_cast<dcp::SMPTETextAsset>(
+		dcp2.cpls().front()->reels().front()->main_subtitle()->asset_ref().asset()
+		);
+	BOOST_REQUIRE(subs2);
+	auto fonts = subs2->font_data();
+	BOOST_REQUIRE_EQUAL(fonts.size(), 1U);
+	BOOST_CHECK(fonts["theFontId"] == dcp::ArrayData("test/data/dummy.ttf"));
+
+	dcp::SMPTETextAsset subs3(mxf, true);
+	dcp::SMPTETextAsset subs4(mxf, true);
+
+	auto fonts3 = subs3.font_data();
+	auto fonts4 = subs4.font_data();
+	BOOST_REQUIRE_EQUAL(fonts3.size(), 1U);
+	BOOST_REQUIRE_EQUAL(fonts4.size(), 1U);
+
+	BOOST_CHECK(fonts3["theFontId"] == dcp::ArrayData("test/data/dummy.ttf"));
+	BOOST_CHECK(fonts3["theFontId"].data() == fonts4["theFontId"].data());
 }
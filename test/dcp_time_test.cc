@@ -169,4 +169,18 @@ BOOST_AUTO_TEST_CASE (dcp_time)
 	BOOST_CHECK (dcp::Time (0, 7, 0, 0, 24) > dcp::Time (0, 6, 0, 0, 24));
 	BOOST_CHECK (dcp::Time (0, 0, 7, 0, 24) > dcp::Time (0, 0, 6, 0, 24));
 	BOOST_CHECK (dcp::Time (0, 0, 0, 7, 24) > dcp::Time (0, 0, 0, 6, 24));
+
+	/* Check comparisons between different tcrs */
+	BOOST_CHECK (dcp::Time (0, 0, 1, 12, 24) == dcp::Time (0, 0, 1, 125, 250));
+	BOOST_CHECK (dcp::Time (0, 0, 1, 12, 24) < dcp::Time (0, 0, 1, 126, 250));
+	BOOST_CHECK (dcp::Time (0, 0, 1, 12, 24) >= dcp::Time (0, 0, 1, 124, 250));
+	BOOST_CHECK (dcp::Time (1, 0, 0, 0, 24) > dcp::Time (0, 59, 59, 999, 1000));
+
+	/* Subtraction giving a negative time borrows from the hours */
+	r = dcp::Time (0, 0, 1, 0, 24) - dcp::Time (0, 0, 2, 1, 24);
+	BOOST_CHECK_EQUAL (r.h, -1);
+	BOOST_CHECK_EQUAL (r.m, 59);
+	BOOST_CHECK_EQUAL (r.s, 58);
+	BOOST_CHECK_EQUAL (r.e, 23);
+	BOOST_CHECK_EQUAL (r + dcp::Time (0, 0, 2, 1, 24), dcp::Time (0, 0, 1, 0, 24));
 }
@@ -38,6 +38,7 @@
 #include "encrypted_kdm.h"
 #include "mono_j2k_picture_asset.h"
 #include "mono_j2k_picture_asset_reader.h"
+#include "mono_j2k_picture_asset_writer.h"
 #include "mono_j2k_picture_frame.h"
 #include "openjpeg_image.h"
 #include "j2k_picture_asset_writer.h"
@@ -241,3 +242,47 @@ BOOST_AUTO_TEST_CASE (decryption_test2)
 	BOOST_CHECK (smpte_sub->key());
 }
 
+
+
+/** Decrypt a picture asset by passing its frames straight through to a new writer */
+BOOST_AUTO_TEST_CASE (decryption_pass_through_test)
+{
+	boost::filesystem::path dir = "build/test/decryption_pass_through_test";
+	boost::filesystem::remove_all(dir);
+	boost::filesystem::create_directories(dir);
+
+	dcp::Key key;
+	dcp::ArrayData picture("test/data/flat_red.j2c");
+
+	dcp::MonoJ2KPictureAsset encrypted(dcp::Fraction(24, 1), dcp::Standard::SMPTE);
+	encrypted.set_key(key);
+	auto encrypted_writer = encrypted.start_write(dir / "encrypted.mxf", dcp::Behaviour::MAKE_NEW);
+	for (int i = 0; i < 24; ++i) {
+		encrypted_writer->write(picture);
+	}
+	encrypted_writer->finalize();
+
+	dcp::MonoJ2KPictureAsset in(dir / "encrypted.mxf");
+	in.set_key(key);
+	dcp::MonoJ2KPictureAsset out(in.edit_rate(), dcp::Standard::SMPTE);
+	auto writer = dynamic_pointer_cast<dcp::MonoJ2KPictureAssetWriter>(out.start_write(dir / "decrypted.mxf", dcp::Behaviour::MAKE_NEW));
+	BOOST_REQUIRE(writer);
+	writer->copy_descriptor_from(in);
+	auto reader = in.start_read();
+	for (int64_t i = 0; i < in.intrinsic_duration(); ++i) {
+		auto frame = reader->get_frame(i);
+		writer->write_pass_through(frame->data(), frame->size());
+	}
+	writer->finalize();
+
+	dcp::MonoJ2KPictureAsset check(dir / "decrypted.mxf");
+	BOOST_CHECK(!check.key_id());
+	BOOST_CHECK_EQUAL(check.intrinsic_duration(), 24);
+	BOOST_CHECK(check.size() == in.size());
+	auto check_reader = check.start_read();
+	for (int64_t i = 0; i < check.intrinsic_duration(); ++i) {
+		auto frame = check_reader->get_frame(i);
+		BOOST_REQUIRE_EQUAL(frame->size(), picture.size());
+		BOOST_CHECK_EQUAL(memcmp(frame->data(), picture.data(), picture.size()), 0);
+	}
+}
@@ -748,6 +748,20 @@ BOOST_AUTO_TEST_CASE (read_interop_subtitle_test3)
 }
 
 
+/** The same, but leaving the PNG to be read when it is needed */
+BOOST_AUTO_TEST_CASE(read_interop_subtitle_test3_lazy)
+{
+	dcp::InteropTextAsset subs("test/data/subs3.xml", true);
+
+	BOOST_REQUIRE_EQUAL(subs.texts().size(), 1U);
+	auto si = dynamic_pointer_cast<const dcp::TextImage>(subs.texts().front());
+	BOOST_REQUIRE(si);
+	BOOST_CHECK(si->has_png_image());
+	BOOST_CHECK(si->file() == boost::filesystem::path("test/data/sub.png"));
+	BOOST_CHECK(si->png_image() == dcp::ArrayData("test/data/sub.png"));
+}
+
+
 /** Write some subtitle content as Interop XML and check that it is right */
 BOOST_AUTO_TEST_CASE (write_interop_subtitle_test)
 {
@@ -1032,3 +1046,91 @@ BOOST_AUTO_TEST_CASE (write_interop_subtitle_test3)
 		);
 }
 
+
+
+/** Check that texts_during gives the same answers as a simple search through every text,
+ *  including after more texts have been added.
+ */
+BOOST_AUTO_TEST_CASE(interop_subtitle_texts_during_test)
+{
+	dcp::InteropTextAsset asset;
+
+	srand(1);
+
+	auto add = [&asset](int count) {
+		for (int i = 0; i < count; ++i) {
+			int const in = rand() % 2000;
+			int const out = in + rand() % 200;
+			asset.add(
+				std::make_shared<dcp::TextString>(
+					optional<string>(), false, false, false, dcp::Colour(255, 255, 255), 42, 1,
+					dcp::Time(in, 24, 24), dcp::Time(out, 24, 24),
+					0, dcp::HAlign::CENTER, 0.8, dcp::VAlign::TOP, 0, vector<dcp::Text::VariableZPosition>(),
+					dcp::Direction::LTR, "Hello world", dcp::Effect::NONE, dcp::Colour(0, 0, 0),
+					dcp::Time(), dcp::Time(), 0, vector<dcp::Ruby>()
+					)
+				);
+		}
+	};
+
+	auto check = [&asset]() {
+		for (int from = 0; from < 2300; from += 7) {
+			for (auto length: { 0, 1, 50 }) {
+				dcp::Time const f(from, 24, 24);
+				dcp::Time const t(from + length, 24, 24);
+				for (auto starting: { false, true }) {
+					vector<shared_ptr<const dcp::Text>> expected;
+					for (auto i: asset.texts()) {
+						if ((starting && f <= i->in() && i->in() < t) || (!starting && i->out() >= f && i->in() <= t)) {
+							expected.push_back(i);
+						}
+					}
+					BOOST_REQUIRE(asset.texts_during(f, t, starting) == expected);
+				}
+			}
+		}
+	};
+
+	check();
+	add(500);
+	check();
+	add(100);
+	check();
+}
+
+
+/** Check the summary of the XML that the verifier uses */
+BOOST_AUTO_TEST_CASE(interop_subtitle_xml_summary_test)
+{
+	dcp::InteropTextAsset asset("test/data/subs1.xml");
+
+	auto summary = asset.xml_summary();
+	BOOST_REQUIRE(summary);
+	BOOST_REQUIRE_EQUAL(summary->subtitles.size(), 4U);
+	BOOST_CHECK(summary->subtitles[0].in == dcp::Time(0, 0, 5, 198, 250));
+	BOOST_CHECK(summary->subtitles[0].out == dcp::Time(0, 0, 7, 115, 250));
+	BOOST_REQUIRE_EQUAL(summary->subtitles[0].texts.size(), 1U);
+	BOOST_CHECK_EQUAL(summary->subtitles[0].texts[0].v_align.get_value_or(""), "bottom");
+	BOOST_CHECK_CLOSE(summary->subtitles[0].texts[0].v_position.get_value_or(0), 15, 1e-3);
+	BOOST_REQUIRE_EQUAL(summary->load_font_ids.size(), 1U);
+	BOOST_CHECK_EQUAL(summary->load_font_ids[0], "theFontId");
+	BOOST_CHECK(summary->has_text);
+	BOOST_CHECK(!summary->empty_text);
+	BOOST_CHECK_EQUAL(summary->root_namespaces, 0);
+
+	/* A summary is made on demand from XML that we write */
+	dcp::InteropTextAsset written;
+	written.set_reel_number("1");
+	written.set_language("EN");
+	written.set_movie_title("Test");
+	BOOST_CHECK(!written.xml_summary());
+	for (auto text: asset.texts()) {
+		written.add(std::const_pointer_cast<dcp::Text>(text));
+	}
+	boost::filesystem::create_directories("build/test/interop_subtitle_xml_summary_test");
+	written.write("build/test/interop_subtitle_xml_summary_test/subs.xml");
+	summary = written.xml_summary();
+	BOOST_REQUIRE(summary);
+	BOOST_CHECK_EQUAL(summary->subtitles.size(), 4U);
+	BOOST_CHECK(summary->has_text);
+}
@@ -33,11 +33,13 @@
 
 
 #include "certificate_chain.h"
+#include "compose.hpp"
 #include "cpl.h"
 #include "decrypted_kdm.h"
 #include "encrypted_kdm.h"
 #include "mono_j2k_picture_asset.h"
 #include "j2k_picture_asset_writer.h"
+#include "kdm_decrypter.h"
 #include "reel.h"
 #include "reel_mono_picture_asset.h"
 #include "reel_sound_asset.h"
@@ -86,6 +88,47 @@ BOOST_AUTO_TEST_CASE (kdm_test)
 }
 
 
+/** Check decryption of KDMs with KDMDecrypter, and its cache */
+BOOST_AUTO_TEST_CASE (kdm_decrypter_test)
+{
+	boost::filesystem::path const cache = "build/test/kdm_decrypter_test";
+	boost::filesystem::remove_all (cache);
+
+	dcp::EncryptedKDM encrypted (
+		dcp::file_to_string ("test/data/kdm_TONEPLATES-SMPTE-ENC_.smpte-430-2.ROOT.NOT_FOR_PRODUCTION_20130706_20230702_CAR_OV_t1_8971c838.xml")
+		);
+	auto const private_key = dcp::file_to_string ("test/data/private.key");
+	dcp::DecryptedKDM reference (encrypted, private_key);
+
+	{
+		dcp::KDMDecrypter decrypter (private_key);
+		decrypter.enable_cache (cache);
+		auto decrypted = decrypter.decrypt (vector<dcp::EncryptedKDM>{encrypted, encrypted, encrypted});
+		BOOST_REQUIRE_EQUAL (decrypted.size(), 3U);
+		for (auto const& kdm: decrypted) {
+			BOOST_CHECK (kdm.keys() == reference.keys());
+		}
+		BOOST_CHECK_EQUAL (decrypter.cache_hits(), 0);
+		BOOST_CHECK (decrypter.decrypt(encrypted).keys() == reference.keys());
+		BOOST_CHECK_EQUAL (decrypter.cache_hits(), 1);
+	}
+
+	/* A new decrypter should find the keys in the cache directory */
+	dcp::KDMDecrypter decrypter (private_key);
+	decrypter.enable_cache (cache);
+	BOOST_CHECK (decrypter.decrypt(encrypted).keys() == reference.keys());
+	BOOST_CHECK_EQUAL (decrypter.cache_hits(), 1);
+
+#ifndef LIBDCP_WINDOWS
+	/* The cache directory and files should be private */
+	BOOST_CHECK (boost::filesystem::status(cache).permissions() == boost::filesystem::owner_all);
+	for (auto const& i: boost::filesystem::directory_iterator(cache)) {
+		BOOST_CHECK (i.status().permissions() == (boost::filesystem::owner_read | boost::filesystem::owner_write));
+	}
+#endif
+}
+
+
 /** Check that we can read in a KDM and then write it back out again the same */
 BOOST_AUTO_TEST_CASE (kdm_passthrough_test)
 {
@@ -382,3 +425,79 @@ BOOST_AUTO_TEST_CASE (vf_kdm_test)
 	reader->set_check_hmac(false);
 	reader->get_frame(0)->xyz_image();
 }
+
+
+/** Make several KDMs at once and check that each of them can be decrypted to give the same keys */
+BOOST_AUTO_TEST_CASE (kdm_batch_encrypt_test)
+{
+	dcp::DecryptedKDM decrypted (
+		dcp::EncryptedKDM (
+			dcp::file_to_string ("test/data/kdm_TONEPLATES-SMPTE-ENC_.smpte-430-2.ROOT.NOT_FOR_PRODUCTION_20130706_20230702_CAR_OV_t1_8971c838.xml")
+			),
+		dcp::file_to_string ("test/data/private.key")
+		);
+
+	auto signer = make_shared<dcp::CertificateChain>(dcp::file_to_string("test/data/certificate_chain"));
+	signer->set_key(dcp::file_to_string("test/data/private.key"));
+
+	vector<dcp::KDMRecipient> recipients;
+	for (int i = 0; i < 8; ++i) {
+		recipients.push_back(dcp::KDMRecipient(signer->leaf(), { dcp::String::compose("trusted-%1", i) }));
+	}
+
+	auto kdms = decrypted.encrypt(signer, recipients, dcp::Formulation::MULTIPLE_MODIFIED_TRANSITIONAL_1, false, optional<int>(), 4);
+	BOOST_REQUIRE_EQUAL(kdms.size(), recipients.size());
+
+	boost::filesystem::path const dir = "build/test/kdm_batch_encrypt_test";
+	boost::filesystem::remove_all(dir);
+	boost::filesystem::create_directories(dir);
+	dcp::write_string_to_file(signer->leaf().certificate(true), dir / "leaf.pem");
+	dcp::write_string_to_file(signer->root().certificate(true), dir / "root.pem");
+	auto const chain = signer->root_to_leaf();
+	BOOST_REQUIRE_EQUAL(chain.size(), 3U);
+	dcp::write_string_to_file(chain[1].certificate(true), dir / "intermediate.pem");
+
+	for (size_t i = 0; i < kdms.size(); ++i) {
+		BOOST_REQUIRE_EQUAL(kdms[i].recipient_x509_subject_name(), signer->leaf().subject());
+		BOOST_REQUIRE_EQUAL(kdms[i].trusted_devices().size(), 1U);
+		BOOST_CHECK_EQUAL(kdms[i].trusted_devices()[0], dcp::String::compose("trusted-%1", i));
+
+		/* Check the signature */
+		auto const kdm_file = dir / dcp::String::compose("kdm_%1.xml", i);
+		kdms[i].as_xml(kdm_file);
+		auto const r = system(
+			dcp::String::compose(
+				"xmlsec1 verify "
+				"--pubkey-cert-pem %1 "
+				"--trusted-pem %2 "
+				"--trusted-pem %3 "
+				"--id-attr:Id http://www.smpte-ra.org/schemas/430-3/2006/ETM:AuthenticatedPublic "
+				"--id-attr:Id http://www.smpte-ra.org/schemas/430-3/2006/ETM:AuthenticatedPrivate --crypto openssl "
+				"%4 "
+#ifndef LIBDCP_WINDOWS
+				"> %5 2>&1 < /dev/null"
+#endif
+				,
+				(dir / "leaf.pem").string(),
+				(dir / "intermediate.pem").string(),
+				(dir / "root.pem").string(),
+				kdm_file.string(),
+				(dir / dcp::String::compose("xmlsec1_%1.log", i)).string()
+				).c_str()
+			);
+#ifdef LIBDCP_WINDOWS
+		BOOST_CHECK_EQUAL(r, 0);
+#else
+		BOOST_CHECK_EQUAL(WEXITSTATUS(r), 0);
+#endif
+
+		/* Check that the KDM can be read back from its XML and decrypted to give the same keys */
+		dcp::EncryptedKDM reread(kdms[i].as_xml());
+		dcp::DecryptedKDM check(reread, dcp::file_to_string("test/data/private.key"));
+		BOOST_REQUIRE_EQUAL(check.keys().size(), decrypted.keys().size());
+		for (size_t j = 0; j < check.keys().size(); ++j) {
+			BOOST_CHECK(check.keys()[j].key() == decrypted.keys()[j].key());
+			BOOST_CHECK_EQUAL(check.keys()[j].id(), decrypted.keys()[j].id());
+		}
+	}
+}
@@ -34,6 +34,7 @@
 
 #include "exceptions.h"
 #include "language_tag.h"
+#include <boost/algorithm/string.hpp>
 #include <boost/test/unit_test.hpp>
 
 
@@ -204,3 +205,39 @@ BOOST_AUTO_TEST_CASE (language_tag_parse_test)
 	BOOST_CHECK_EQUAL(dcp::LanguageTag("de-Dogr-DE-aranes-lemosin-abv-zsm").as_string(), "de-Dogr-DE-aranes-lemosin-abv-zsm");
 }
 
+
+
+/** Check that every subtag can be found, whatever its case */
+BOOST_AUTO_TEST_CASE(language_tag_find_all_test)
+{
+	for (auto type: { dcp::LanguageTag::SubtagType::LANGUAGE, dcp::LanguageTag::SubtagType::SCRIPT, dcp::LanguageTag::SubtagType::REGION, dcp::LanguageTag::SubtagType::VARIANT, dcp::LanguageTag::SubtagType::EXTLANG }) {
+		auto const all = dcp::LanguageTag::get_all(type);
+		BOOST_REQUIRE(!all.empty());
+		for (auto const& subtag: all) {
+			auto found = dcp::LanguageTag::get_subtag_data(type, boost::algorithm::to_upper_copy(subtag.subtag));
+			BOOST_REQUIRE(found);
+			BOOST_CHECK_EQUAL(found->subtag, subtag.subtag);
+			found = dcp::LanguageTag::get_subtag_data(type, boost::algorithm::to_lower_copy(subtag.subtag));
+			BOOST_REQUIRE(found);
+			BOOST_CHECK_EQUAL(found->description, subtag.description);
+		}
+	}
+
+	BOOST_CHECK(!dcp::LanguageTag::get_subtag_data(dcp::LanguageTag::SubtagType::LANGUAGE, "fish"));
+}
+
+
+/** Check that a list from get_all() is still usable after the lists have been reloaded */
+BOOST_AUTO_TEST_CASE(language_tag_get_all_after_reload_test)
+{
+	auto const& all = dcp::LanguageTag::get_all(dcp::LanguageTag::SubtagType::REGION);
+	auto const size = all.size();
+	BOOST_REQUIRE(size > 0);
+	auto const first = all.front().subtag;
+
+	dcp::load_language_tag_lists("tags");
+
+	BOOST_CHECK(&all == &dcp::LanguageTag::get_all(dcp::LanguageTag::SubtagType::REGION));
+	BOOST_REQUIRE_EQUAL(all.size(), size);
+	BOOST_CHECK_EQUAL(all.front().subtag, first);
+}
@@ -35,6 +35,11 @@
 #include <boost/optional/optional_io.hpp>
 #include "dcp.h"
 #include "cpl.h"
+#include "mono_j2k_picture_asset.h"
+#include "reel.h"
+#include "reel_mono_picture_asset.h"
+#include "reel_sound_asset.h"
+#include "sound_asset.h"
 #include "stream_operators.h"
 #include "test.h"
 
@@ -74,6 +79,40 @@ BOOST_AUTO_TEST_CASE (read_dcp_test2)
 }
 
 
+/** Read a DCP lazily and check that the MXFs are only opened when their assets are used */
+BOOST_AUTO_TEST_CASE(read_dcp_lazy_test)
+{
+	boost::filesystem::path const dir = "build/test/read_dcp_lazy_test";
+	boost::filesystem::remove_all(dir);
+	boost::filesystem::create_directories(dir);
+	for (auto i: boost::filesystem::directory_iterator("test/ref/DCP/dcp_test1")) {
+		boost::filesystem::copy_file(i.path(), dir / i.path().filename());
+	}
+
+	dcp::DCP eager("test/ref/DCP/dcp_test1");
+	eager.read();
+	auto eager_reel = eager.cpls()[0]->reels()[0];
+
+	dcp::DCP lazy(dir);
+	lazy.read(nullptr, false, true);
+	auto lazy_reel = lazy.cpls()[0]->reels()[0];
+	BOOST_REQUIRE(lazy_reel->main_picture()->asset_ref().resolved());
+	BOOST_REQUIRE(lazy_reel->main_sound()->asset_ref().resolved());
+
+	/* With the picture MXF gone the read should still have worked, but using the picture asset should fail */
+	boost::filesystem::remove(dir / "video.mxf");
+	BOOST_CHECK_THROW(lazy_reel->main_picture()->asset_ref().asset(), dcp::ReadError);
+
+	auto sound = lazy_reel->main_sound()->asset();
+	BOOST_REQUIRE(sound);
+	BOOST_CHECK_EQUAL(sound->id(), eager_reel->main_sound()->asset()->id());
+	BOOST_CHECK_EQUAL(sound->intrinsic_duration(), eager_reel->main_sound()->asset()->intrinsic_duration());
+	BOOST_CHECK_EQUAL(sound->hash(), eager_reel->main_sound()->asset()->hash());
+	/* The same object should come back every time */
+	BOOST_CHECK(lazy_reel->main_sound()->asset() == sound);
+}
+
+
 /** Read a DCP that previously gave: Unrecognised channel ID 'dbox2' */
 BOOST_AUTO_TEST_CASE(read_dcp_test3)
 {
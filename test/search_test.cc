@@ -32,14 +32,112 @@
 */
 
 
+#include "cpl.h"
+#include "dcp.h"
+#include "interop_text_asset.h"
+#include "reel.h"
+#include "reel_file_asset.h"
+#include "reel_interop_text_asset.h"
+#include "reel_mono_picture_asset.h"
+#include "reel_sound_asset.h"
 #include "search.h"
+#include "test.h"
 #include "util.h"
 #include <boost/test/unit_test.hpp>
 
 
+using std::make_shared;
+using std::shared_ptr;
 using std::vector;
 
 
+BOOST_AUTO_TEST_CASE(find_and_resolve_cpls_test)
+{
+	auto cpls = dcp::find_and_resolve_cpls({"test/ref/DCP/dcp_test1", "test/ref/DCP/dcp_test3", "build/test/does_not_exist"}, true);
+	BOOST_REQUIRE_EQUAL(cpls.size(), 2U);
+	BOOST_CHECK_EQUAL(cpls[0]->annotation_text().get_value_or(""), "A Test DCP");
+	for (auto cpl: cpls) {
+		for (auto asset: cpl->reel_file_assets()) {
+			BOOST_CHECK(asset->asset_ref().resolved());
+		}
+	}
+}
+
+
+/** Find a VF along with two copies of its OV and check that the VF's reels resolve to the assets
+ *  in whichever OV comes first.
+ */
+BOOST_AUTO_TEST_CASE(find_and_resolve_cpls_with_vf_test)
+{
+	boost::filesystem::path const dir = "build/test/find_and_resolve_cpls_with_vf_test";
+	boost::filesystem::remove_all(dir);
+
+	auto ov = make_simple(dir / "ov", 1, 24, dcp::Standard::INTEROP);
+	ov->write_xml();
+
+	boost::filesystem::create_directories(dir / "ov2");
+	for (auto i: boost::filesystem::directory_iterator(dir / "ov")) {
+		boost::filesystem::copy_file(i.path(), dir / "ov2" / i.path().filename());
+	}
+
+	boost::filesystem::create_directories(dir / "vf");
+	auto vf = make_shared<dcp::DCP>(dir / "vf");
+	auto vf_cpl = make_shared<dcp::CPL>("A Test VF", dcp::ContentKind::TRAILER, dcp::Standard::INTEROP);
+	auto subs = make_shared<dcp::InteropTextAsset>();
+	subs->add(simple_text());
+	subs->write(dir / "vf" / "subs.xml");
+	vf_cpl->add(
+		make_shared<dcp::Reel>(
+			ov->cpls()[0]->reels()[0]->main_picture(),
+			ov->cpls()[0]->reels()[0]->main_sound(),
+			make_shared<dcp::ReelInteropTextAsset>(dcp::TextType::OPEN_SUBTITLE, subs, dcp::Fraction(24, 1), 24, 0)
+			)
+		);
+	vf->add(vf_cpl);
+	vf->write_xml();
+
+	auto find_vf = [&vf_cpl](vector<shared_ptr<dcp::CPL>> const& cpls) {
+		for (auto cpl: cpls) {
+			if (cpl->id() == vf_cpl->id()) {
+				return cpl;
+			}
+		}
+		return shared_ptr<dcp::CPL>();
+	};
+
+	auto in = [](shared_ptr<dcp::ReelFileAsset> reel_asset, boost::filesystem::path directory) {
+		auto const file = reel_asset->asset_ref().asset()->file();
+		return file && boost::filesystem::canonical(file->parent_path()) == boost::filesystem::canonical(directory);
+	};
+
+	for (auto first: { dir / "ov", dir / "ov2" }) {
+		auto const second = first == dir / "ov" ? dir / "ov2" : dir / "ov";
+		auto cpls = dcp::find_and_resolve_cpls({dir / "vf", first, second}, true);
+		BOOST_REQUIRE_EQUAL(cpls.size(), 3U);
+
+		auto cpl = find_vf(cpls);
+		BOOST_REQUIRE(cpl);
+		BOOST_REQUIRE_EQUAL(cpl->reels().size(), 1U);
+		auto reel = cpl->reels()[0];
+		BOOST_REQUIRE(reel->main_picture()->asset_ref().resolved());
+		BOOST_REQUIRE(reel->main_sound()->asset_ref().resolved());
+		BOOST_CHECK(in(reel->main_picture(), first));
+		BOOST_CHECK(in(reel->main_sound(), first));
+		BOOST_CHECK(in(reel->main_subtitle(), dir / "vf"));
+
+		/* Every CPL, including the second OV's, should now point to the first OV's assets */
+		for (auto other: cpls) {
+			for (auto reel_asset: other->reel_file_assets()) {
+				BOOST_REQUIRE(reel_asset->asset_ref().resolved());
+				if (reel_asset->asset_ref().id() != reel->main_subtitle()->asset_ref().id()) {
+					BOOST_CHECK(in(reel_asset, first));
+				}
+			}
+		}
+	}
+}
+
+
 /* boost::filesystem::permissions does not work on Windows as we need. Let's hope the test on
  * Linux/macOS finds problems.
  */
@@ -55,9 +55,13 @@
 #include "stream_operators.h"
 #include "test.h"
 #include "util.h"
+#include "verification_cache.h"
+#include "verification_shard.h"
 #include "verify.h"
 #include "verify_internal.h"
 #include "verify_j2k.h"
+#include <libcxml/cxml.h>
+#include <libxml++/libxml++.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/random.hpp>
 #include <boost/test/unit_test.hpp>
@@ -5918,3 +5922,168 @@ BOOST_AUTO_TEST_CASE(verify_dcp_with_two_cpls)
 	});
 }
 
+
+
+BOOST_AUTO_TEST_CASE(verify_with_cache)
+{
+	auto dir = setup(1, "with_cache");
+	auto const cache_file = path("build/test/verify_with_cache.xml");
+	remove(cache_file);
+
+	/* The cache ignores files which have just been modified, so make these look older */
+	for (auto i: directory_iterator(dir)) {
+		if (is_regular_file(i.path())) {
+			last_write_time(i.path(), time(nullptr) - 60);
+		}
+	}
+
+	dcp::VerificationOptions options;
+	options.cache = make_shared<dcp::VerificationCache>(cache_file);
+	auto const first = dcp::verify({dir}, {}, &stage, &progress, options, xsd_test).notes;
+	BOOST_REQUIRE(exists(cache_file));
+
+	/* Notes should survive a round trip through XML */
+	for (auto const& i: first) {
+		xmlpp::Document doc;
+		auto root = doc.create_root_node("Test");
+		i.as_xml(root);
+		cxml::Document read("Test");
+		read.read_string(doc.write_to_string());
+		BOOST_CHECK(dcp::VerificationNote(read.node_child("Note")) == i);
+	}
+
+	/* Verifying again using the saved cache should give the same result */
+	options.cache = make_shared<dcp::VerificationCache>(cache_file);
+	BOOST_CHECK(dcp::verify({dir}, {}, &stage, &progress, options, xsd_test).notes == first);
+
+	/* Damage the picture asset; the cached hash should no longer be used */
+	auto video_path = path(dir / "video.mxf");
+	HashCalculator video_calc(video_path);
+	auto mod = fopen(video_path.string().c_str(), "r+b");
+	BOOST_REQUIRE(mod);
+	BOOST_REQUIRE_EQUAL(fseek(mod, -16, SEEK_END), 0);
+	int x = 42;
+	BOOST_REQUIRE(fwrite(&x, sizeof(x), 1, mod) == 1);
+	fclose(mod);
+
+	auto const third = dcp::verify({dir}, {}, &stage, &progress, options, xsd_test).notes;
+	BOOST_CHECK(
+		std::find_if(third.begin(), third.end(), [&video_calc](dcp::VerificationNote const& note) {
+			return note.code() == dcp::VerificationNote::Code::INCORRECT_PICTURE_HASH && note.calculated_hash() == video_calc.new_hash();
+		}) != third.end()
+	);
+}
+
+
+/** Check that the cache only remembers things about files which have not been modified very recently */
+BOOST_AUTO_TEST_CASE(verification_cache_recent_file_test)
+{
+	auto const dir = path("build/test/verification_cache_recent_file_test");
+	remove_all(dir);
+	create_directories(dir);
+	auto const asset = dir / "asset";
+	dcp::write_string_to_file("foo", asset);
+
+	dcp::VerificationCache cache(dir / "cache.xml");
+
+	/* Just written, so it could change again without its modification time changing */
+	cache.set_hash(asset, "abc");
+	BOOST_CHECK(!cache.hash(asset));
+
+	last_write_time(asset, time(nullptr) - 60);
+	cache.set_hash(asset, "abc");
+	BOOST_CHECK(cache.hash(asset) == string("abc"));
+	cache.set_notes(asset, "check", {});
+	BOOST_CHECK(cache.notes(asset, "check"));
+
+	/* Re-writing it with the same size should stop the cached results being used */
+	dcp::write_string_to_file("bar", asset);
+	BOOST_CHECK(!cache.hash(asset));
+	BOOST_CHECK(!cache.notes(asset, "check"));
+}
+
+
+BOOST_AUTO_TEST_CASE(verify_sampled_picture_frames)
+{
+	auto dir = setup(1, "sampled_picture_frames");
+	auto const video = canonical(dir / "video.mxf");
+	auto const duration = dcp::MonoJ2KPictureAsset(video).intrinsic_duration();
+
+	auto sampled = [](vector<dcp::VerificationNote> const& notes) {
+		return std::find_if(notes.begin(), notes.end(), [](dcp::VerificationNote const& note) {
+			return note.code() == dcp::VerificationNote::Code::SAMPLED_PICTURE_FRAMES;
+		});
+	};
+
+	dcp::VerificationOptions options;
+	options.picture_sampling = dcp::PictureSampling::every_nth_frame(10);
+	auto notes = dcp::verify({dir}, {}, &stage, &progress, options, xsd_test).notes;
+	auto note = sampled(notes);
+	BOOST_REQUIRE(note != notes.end());
+	BOOST_CHECK_EQUAL(note->file().get_value_or(""), video);
+	BOOST_CHECK_EQUAL(note->checked_frames().get_value_or(0), (duration + 9) / 10);
+	BOOST_CHECK_EQUAL(note->duration().get_value_or(0), duration);
+
+	BOOST_CHECK(dcp::PictureSampling::reel_heads_and_tails(2).frames(10) == vector<int64_t>({0, 1, 8, 9}));
+	BOOST_CHECK_EQUAL(dcp::PictureSampling::random(4, 42).frames(100).size(), 4U);
+	BOOST_CHECK(dcp::PictureSampling::random(4, 42).frames(100) == dcp::PictureSampling::random(4, 42).frames(100));
+	BOOST_CHECK_EQUAL(dcp::PictureSampling::random(400, 42).frames(100).size(), 100U);
+
+	/* Checking everything should give no such note */
+	notes = dcp::verify({dir}, {}, &stage, &progress, {}, xsd_test).notes;
+	BOOST_CHECK(sampled(notes) == notes.end());
+}
+
+
+BOOST_AUTO_TEST_CASE(verify_with_note_sink)
+{
+	auto dir = setup(1, "with_note_sink");
+
+	auto const expected = dcp::verify({dir}, {}, &stage, &progress, {}, xsd_test).notes;
+
+	vector<dcp::VerificationNote> notes;
+	dcp::VerificationNoteSink sink([&notes](dcp::VerificationNote const& note) { notes.push_back(note); });
+	dcp::verify({dir}, {}, &stage, &progress, sink, {}, xsd_test);
+	BOOST_CHECK(notes == expected);
+	BOOST_CHECK_EQUAL(sink.count(), static_cast<int64_t>(expected.size()));
+
+	int handled = 0;
+	dcp::VerificationNoteSink deduplicating([&handled](dcp::VerificationNote const&) { ++handled; }, true);
+	deduplicating.add(dcp::VerificationNote(dcp::VerificationNote::Code::INVALID_STANDARD));
+	deduplicating.add(dcp::VerificationNote(dcp::VerificationNote::Code::INVALID_STANDARD));
+	deduplicating.add(dcp::VerificationNote(dcp::VerificationNote::Code::MISSING_ASSETMAP));
+	BOOST_CHECK_EQUAL(handled, 2);
+	BOOST_CHECK_EQUAL(deduplicating.count(), 2);
+}
+
+
+BOOST_AUTO_TEST_CASE(verify_in_shards)
+{
+	auto dir = setup(1, "in_shards");
+
+	auto const expected = dcp::verify({dir}, {}, &stage, &progress, {}, xsd_test);
+
+	int const count = 3;
+	vector<dcp::VerificationShardResult> shards;
+	for (int i = 0; i < count; ++i) {
+		auto const file = path(dcp::String::compose("build/test/verify_in_shards_%1.xml", i));
+		dcp::verify_shard({dir}, {}, &stage, &progress, dcp::VerificationShard(i, count), {}, xsd_test).write(file);
+		shards.push_back(dcp::VerificationShardResult(file));
+	}
+
+	/* Everything except the sharded checks should only be reported by the first shard */
+	for (int i = 1; i < count; ++i) {
+		for (auto const& section: shards[i].sections()) {
+			BOOST_CHECK(section.check);
+			BOOST_CHECK(section.done || section.notes.empty());
+		}
+	}
+
+	auto merged = dcp::merge_verification_shards(shards, {dir});
+	BOOST_CHECK(merged.notes == expected.notes);
+	BOOST_CHECK_EQUAL(merged.dcps.size(), expected.dcps.size());
+
+	/* Any missing shard should be noticed */
+	shards.pop_back();
+	BOOST_CHECK_THROW(dcp::merge_verification_shards(shards, {dir}), dcp::MiscError);
+}
@@ -0,0 +1,164 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+#include "colour_conversion.h"
+#include "exceptions.h"
+#include "j2k_transcode.h"
+#include "openjpeg_image.h"
+#include "rgb_xyz.h"
+#include "test.h"
+#include "xyz_image.h"
+#include <boost/random.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/test/unit_test.hpp>
+#include <openjpeg.h>
+
+
+using std::make_shared;
+using std::shared_ptr;
+using boost::scoped_array;
+
+
+static
+shared_ptr<dcp::OpenJPEGImage>
+random_openjpeg_image(dcp::Size size)
+{
+	boost::random::mt19937 rng(1);
+	boost::random::uniform_int_distribution<> dist(0, 4095);
+
+	auto image = make_shared<dcp::OpenJPEGImage>(size);
+	for (int c = 0; c < 3; ++c) {
+		for (int i = 0; i < size.width * size.height; ++i) {
+			image->data(c)[i] = dist(rng);
+		}
+	}
+
+	return image;
+}
+
+
+BOOST_AUTO_TEST_CASE(xyz_image_openjpeg_round_trip_test)
+{
+	dcp::Size const size(640, 480);
+	auto ref = random_openjpeg_image(size);
+
+	dcp::XYZImage xyz(*ref);
+	BOOST_REQUIRE(xyz.size() == size);
+
+	auto back = xyz.to_openjpeg();
+	BOOST_REQUIRE(back->size() == size);
+
+	for (int c = 0; c < 3; ++c) {
+		for (int i = 0; i < size.width * size.height; ++i) {
+			BOOST_REQUIRE_EQUAL(ref->data(c)[i], xyz.data(c)[i]);
+			BOOST_REQUIRE_EQUAL(ref->data(c)[i], back->data(c)[i]);
+		}
+	}
+}
+
+
+/** Check that the XYZImage versions of rgb_to_xyz and xyz_to_rgb give the same results as the OpenJPEGImage ones */
+/** Check that images whose components do not match the image size are rejected */
+BOOST_AUTO_TEST_CASE(xyz_image_bad_components_test)
+{
+	dcp::Size const size(64, 32);
+
+	auto image = random_openjpeg_image(size);
+	BOOST_CHECK_NO_THROW(dcp::XYZImage{*image});
+
+	image->opj_image()->comps[1].w = size.width * 2;
+	BOOST_CHECK_THROW(dcp::XYZImage{*image}, dcp::J2KDecompressionError);
+
+	image = random_openjpeg_image(size);
+	image->opj_image()->comps[2].dx = 2;
+	BOOST_CHECK_THROW(dcp::XYZImage{*image}, dcp::J2KDecompressionError);
+
+	image = random_openjpeg_image(size);
+	image->opj_image()->x1 = size.width * 2;
+	BOOST_CHECK_THROW(dcp::XYZImage{*image}, dcp::J2KDecompressionError);
+}
+
+
+BOOST_AUTO_TEST_CASE(xyz_image_colour_conversion_test)
+{
+	dcp::Size const size(640, 480);
+
+	boost::random::mt19937 rng(1);
+	boost::random::uniform_int_distribution<> dist(0, 65535);
+
+	scoped_array<uint8_t> rgb(new uint8_t[size.width * size.height * 6]);
+	auto p = reinterpret_cast<uint16_t*>(rgb.get());
+	for (int i = 0; i < size.width * size.height * 3; ++i) {
+		*p++ = dist(rng);
+	}
+
+	auto const& conversion = dcp::ColourConversion::srgb_to_xyz();
+
+	auto ref = dcp::rgb_to_xyz(rgb.get(), size, size.width * 6, conversion);
+	dcp::XYZImage xyz(size);
+	dcp::rgb_to_xyz(rgb.get(), xyz, size.width * 6, conversion);
+
+	for (int c = 0; c < 3; ++c) {
+		for (int i = 0; i < size.width * size.height; ++i) {
+			BOOST_REQUIRE_EQUAL(ref->data(c)[i], xyz.data(c)[i]);
+		}
+	}
+
+	scoped_array<uint8_t> ref_rgb(new uint8_t[size.width * size.height * 6]);
+	dcp::xyz_to_rgb(ref, conversion, ref_rgb.get(), size.width * 6);
+	scoped_array<uint8_t> check_rgb(new uint8_t[size.width * size.height * 6]);
+	dcp::xyz_to_rgb(xyz, conversion, check_rgb.get(), size.width * 6);
+
+	BOOST_CHECK(memcmp(ref_rgb.get(), check_rgb.get(), size.width * size.height * 6) == 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(xyz_image_j2k_test)
+{
+	auto const image = dcp::decompress_j2k_xyz(dcp::ArrayData("test/data/flat_red.j2c"), 0);
+	auto const ref = dcp::decompress_j2k(dcp::ArrayData("test/data/flat_red.j2c"), 0);
+
+	BOOST_REQUIRE(image->size() == ref->size());
+	for (int c = 0; c < 3; ++c) {
+		for (int i = 0; i < ref->size().width * ref->size().height; ++i) {
+			BOOST_REQUIRE_EQUAL(ref->data(c)[i], image->data(c)[i]);
+		}
+	}
+
+	/* The result should be the same as compressing the OpenJPEGImage that we started with */
+	auto const compressed = dcp::compress_j2k(*image, 100000000, 24, false, false);
+	auto const ref_compressed = dcp::compress_j2k(ref, 100000000, 24, false, false);
+	BOOST_CHECK(compressed == ref_compressed);
+}
@@ -0,0 +1,108 @@
+/*
+    Copyright (C) 2024 Carl Hetherington <cth@carlh.net>
+
+    This file is part of libdcp.
+
+    libdcp is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    libdcp is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with libdcp.  If not, see <http://www.gnu.org/licenses/>.
+
+    In addition, as a special exception, the copyright holders give
+    permission to link the code of portions of this program with the
+    OpenSSL library under certain conditions as described in each
+    individual source file, and distribute linked combinations
+    including the two.
+
+    You must obey the GNU General Public License in all respects
+    for all of the code used other than OpenSSL.  If you modify
+    file(s) with this exception, you may extend this exception to your
+    version of the file(s), but you are not obligated to do so.  If you
+    do not wish to do so, delete this exception statement from your
+    version.  If you delete this exception statement from all source
+    files in the program, then also delete it here.
+*/
+
+
+
+#include "colour_conversion.h"
+#include "ffmpeg_image.h"
+#include "openjpeg_image.h"
+#include "yuv_xyz.h"
+#include <boost/random.hpp>
+#include <boost/test/unit_test.hpp>
+
+
+/** Check that FFmpegImage gets its size from the frame */
+BOOST_AUTO_TEST_CASE(ffmpeg_image_size_test)
+{
+	dcp::FFmpegImage image(dcp::Size(1998, 1080), 0);
+	BOOST_CHECK(image.size() == dcp::Size(1998, 1080));
+	BOOST_CHECK_EQUAL(image.u_stride(), 999);
+
+	dcp::FFmpegImage odd(dcp::Size(641, 361), 0);
+	BOOST_CHECK(odd.size() == dcp::Size(641, 361));
+	BOOST_CHECK_EQUAL(odd.v_stride(), 321);
+}
+
+
+/** Convert some random YUV to XYZ and back again and check that we get roughly what we started with */
+BOOST_AUTO_TEST_CASE(yuv_xyz_round_trip_test)
+{
+	dcp::Size const size(640, 360);
+	dcp::FFmpegImage yuv(size, 0);
+
+	boost::random::mt19937 rng(1);
+	/* Stay well inside the video range so that nothing is clipped on the way round */
+	boost::random::uniform_int_distribution<> luma(64, 192);
+	boost::random::uniform_int_distribution<> chroma(112, 144);
+
+	for (int y = 0; y < size.height; ++y) {
+		for (int x = 0; x < size.width; ++x) {
+			yuv.y()[y * yuv.y_stride() + x] = luma(rng);
+		}
+	}
+
+	/* Make chroma constant within each 2x2 block so that it can survive the round trip */
+	for (int y = 0; y < size.height / 2; ++y) {
+		for (int x = 0; x < size.width / 2; ++x) {
+			yuv.u()[y * yuv.u_stride() + x] = chroma(rng);
+			yuv.v()[y * yuv.v_stride() + x] = chroma(rng);
+		}
+	}
+
+	auto const& conversion = dcp::ColourConversion::rec709_to_xyz();
+	auto xyz = dcp::yuv_to_xyz(yuv, conversion);
+	BOOST_REQUIRE(xyz->size() == size);
+
+	for (int c = 0; c < 3; ++c) {
+		for (int i = 0; i < size.width * size.height; ++i) {
+			BOOST_REQUIRE(xyz->data(c)[i] >= 0 && xyz->data(c)[i] <= 4095);
+		}
+	}
+
+	auto back = dcp::xyz_to_yuv(xyz, conversion);
+	BOOST_REQUIRE(back.size() == size);
+
+	/* Luma is affected by the chroma of its neighbours after the chroma averaging, so allow a bit more slack there */
+	for (int y = 0; y < size.height; ++y) {
+		for (int x = 0; x < size.width; ++x) {
+			BOOST_REQUIRE(std::abs(yuv.y()[y * yuv.y_stride() + x] - back.y()[y * back.y_stride() + x]) <= 3);
+		}
+	}
+
+	for (int y = 0; y < size.height / 2; ++y) {
+		for (int x = 0; x < size.width / 2; ++x) {
+			BOOST_REQUIRE(std::abs(yuv.u()[y * yuv.u_stride() + x] - back.u()[y * back.u_stride() + x]) <= 3);
+			BOOST_REQUIRE(std::abs(yuv.v()[y * yuv.v_stride() + x] - back.v()[y * back.v_stride() + x]) <= 3);
+		}
+	}
+}
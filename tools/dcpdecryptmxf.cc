@@ -37,26 +37,37 @@
 #include "atmos_asset_writer.h"
 #include "atmos_frame.h"
 #include "crypto_context.h"
+#include "dcp_assert.h"
 #include "decrypted_kdm.h"
 #include "encrypted_kdm.h"
 #include "exceptions.h"
 #include "key.h"
 #include "mono_j2k_picture_asset.h"
 #include "mono_j2k_picture_asset_writer.h"
+#include "mono_j2k_picture_frame.h"
 #include "sound_asset.h"
 #include "sound_asset_writer.h"
+#include "sound_frame.h"
 #include "util.h"
 #include "version.h"
 #include <asdcp/AS_DCP.h>
 #include <getopt.h>
+#include <condition_variable>
+#include <exception>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 
 using std::cerr;
 using std::cout;
+using std::map;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 using boost::optional;
 
 
@@ -75,17 +86,93 @@ help (string n)
 	     << "  -i, --ignore-hmac  don't raise an error if HMACs don't agree\n";
 }
 
-template <class T, class U>
-void copy (T const& in, shared_ptr<U> writer, bool ignore_hmac)
+/** Read (and decrypt, if required) all the frames of in using a pool of threads,
+ *  each with its own reader, and pass them to write in order.
+ */
+template <class T, class W>
+void copy (T const& in, bool ignore_hmac, W write)
 {
-	auto reader = in.start_read();
-	reader->set_check_hmac (!ignore_hmac);
-	for (int64_t i = 0; i < in.intrinsic_duration(); ++i) {
-		auto frame = reader->get_frame (i);
-		writer->write (frame->data(), frame->size());
+	using FramePtr = decltype(in.start_read()->get_frame(0));
+
+	int const threads = std::max(1U, std::thread::hardware_concurrency());
+	int64_t const frames = in.intrinsic_duration();
+	/* Don't let the readers get too far ahead of the writer */
+	int64_t const window = threads * 4;
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	map<int64_t, FramePtr> ready;
+	int64_t next_read = 0;
+	int64_t next_write = 0;
+	std::exception_ptr error;
+
+	auto fail = [&]() {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!error) {
+			error = std::current_exception();
+		}
+		condition.notify_all();
+	};
+
+	auto read = [&]() {
+		try {
+			auto reader = in.start_read();
+			reader->set_check_hmac(!ignore_hmac);
+			while (true) {
+				int64_t index;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					condition.wait(lock, [&]() { return error || next_read >= frames || next_read < next_write + window; });
+					if (error || next_read >= frames) {
+						return;
+					}
+					index = next_read++;
+				}
+				auto frame = reader->get_frame(index);
+				std::lock_guard<std::mutex> lock(mutex);
+				ready[index] = frame;
+				condition.notify_all();
+			}
+		} catch (...) {
+			fail();
+		}
+	};
+
+	vector<std::thread> pool;
+	for (int i = 0; i < threads; ++i) {
+		pool.push_back(std::thread(read));
 	}
-	writer->finalize();
-};
+
+	try {
+		for (int64_t i = 0; i < frames; ++i) {
+			FramePtr frame;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [&]() { return error || ready.find(i) != ready.end(); });
+				if (error) {
+					break;
+				}
+				auto iter = ready.find(i);
+				frame = iter->second;
+				ready.erase(iter);
+			}
+			write(frame);
+			std::lock_guard<std::mutex> lock(mutex);
+			next_write = i + 1;
+			condition.notify_all();
+		}
+	} catch (...) {
+		fail();
+	}
+
+	for (auto& thread: pool) {
+		thread.join();
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
 
 
 int
@@ -227,7 +314,10 @@ main (int argc, char* argv[])
 				in.atmos_version()
 				);
 			auto writer = out.start_write(output_file.get());
-			copy (in, writer, ignore_hmac);
+			copy(in, ignore_hmac, [writer](shared_ptr<const dcp::AtmosFrame> frame) {
+				writer->write(frame->data(), frame->size());
+			});
+			writer->finalize();
 			break;
 		}
 		case Type::PICTURE:
@@ -235,8 +325,14 @@ main (int argc, char* argv[])
 			dcp::MonoJ2KPictureAsset in (input_file);
 			add_key (in, decrypted_kdm);
 			dcp::MonoJ2KPictureAsset out (in.edit_rate(), dcp::Standard::SMPTE);
-			auto writer = out.start_write(output_file.get(), dcp::Behaviour::MAKE_NEW);
-			copy (in, writer, ignore_hmac);
+			auto writer = std::dynamic_pointer_cast<dcp::MonoJ2KPictureAssetWriter>(out.start_write(output_file.get(), dcp::Behaviour::MAKE_NEW));
+			DCP_ASSERT(writer);
+			/* The frames came out of a valid MXF so there's no need to parse them again */
+			writer->copy_descriptor_from(in);
+			copy(in, ignore_hmac, [writer](shared_ptr<const dcp::MonoJ2KPictureFrame> frame) {
+				writer->write_pass_through(frame->data(), frame->size());
+			});
+			writer->finalize();
 			break;
 		}
 		case Type::SOUND:
@@ -246,10 +342,7 @@ main (int argc, char* argv[])
 			/* XXX: this is all a bit of a hack */
 			dcp::SoundAsset out(in.edit_rate(), in.sampling_rate(), in.channels(), dcp::LanguageTag(in.language().get_value_or("en-GB")), dcp::Standard::SMPTE);
 			auto writer = out.start_write(output_file.get(), {}, dcp::SoundAsset::AtmosSync::DISABLED, dcp::SoundAsset::MCASubDescriptors::DISABLED);
-			auto reader = in.start_read();
-			reader->set_check_hmac(!ignore_hmac);
-			for (int64_t i = 0; i < in.intrinsic_duration(); ++i) {
-				auto frame = reader->get_frame(i);
+			copy(in, ignore_hmac, [writer](shared_ptr<const dcp::SoundFrame> frame) {
 				std::vector<int32_t*> pointers(frame->channels());
 				for (auto channel = 0; channel < frame->channels(); ++channel) {
 					pointers[channel] = new int32_t[frame->samples()];
@@ -261,7 +354,7 @@ main (int argc, char* argv[])
 				for (auto channel = 0; channel < frame->channels(); ++channel) {
 					delete[] pointers[channel];
 				}
-			}
+			});
 			writer->finalize();
 			break;
 		}
@@ -78,6 +78,7 @@ help (string n)
 	     << "      --key                         hexadecimal key to use to decrypt MXFs\n"
 	     << "      --ignore-missing-assets       ignore missing asset files\n"
 	     << "      --export-differing-subtitles  export the first pair of differing image subtitles to the current working directory\n"
+	     << "      --trust-hashes                assume that picture and sound assets with the same hashes in their PKLs are the same\n"
 	     << "\n"
 	     << "The <DCP>s are the DCP directories to compare.\n"
 	     << "Comparison is of metadata and content, ignoring timestamps\n"
@@ -153,10 +154,11 @@ main (int argc, char* argv[])
 			{ "key", required_argument, 0, 'D'},
 			{ "reel-annotation-texts", no_argument, 0, 'E'},
 			{ "export-differing-subtitles", no_argument, 0, 'F' },
+			{ "trust-hashes", no_argument, 0, 'G' },
 			{ 0, 0, 0, 0 }
 		};
 
-		int c = getopt_long (argc, argv, "Vhvm:s:adACD:EF", long_options, &option_index);
+		int c = getopt_long (argc, argv, "Vhvm:s:adACD:EFG", long_options, &option_index);
 
 		if (c == -1) {
 			break;
@@ -200,6 +202,9 @@ main (int argc, char* argv[])
 		case 'F':
 			options.export_differing_texts = true;
 			break;
+		case 'G':
+			options.trust_known_hashes = true;
+			break;
 		}
 	}
 
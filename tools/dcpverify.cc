@@ -75,6 +75,7 @@ help (string n)
 	     << "  --no-asset-hash-check                        don't check asset hashes\n"
 	     << "  --asset-hash-check-maximum-size <size-in-MB> only check hashes for assets smaller than this size (in MB)\n"
 	     << "  --no-picture-details-check                   don't check details of picture assets (J2K bitstream etc.)\n"
+	     << "  --picture-details-every-nth-frame <n>        only check details of every nth frame of picture assets\n"
 	     << "  -o <filename>                                write report to filename "
 #ifdef LIBDCP_HAVE_HARU
 	" (.txt, .htm, .html or .pdf)\n"
@@ -137,11 +138,12 @@ main (int argc, char* argv[])
 			{ "no-asset-hash-check", no_argument, 0, 'C' },
 			{ "no-picture-details-check", no_argument, 0, 'E' },
 			{ "asset-hash-check-maximum-size", required_argument, 0, 'D' },
+			{ "picture-details-every-nth-frame", required_argument, 0, 'F' },
 			{ "quiet", no_argument, 0, 'q' },
 			{ 0, 0, 0, 0 }
 		};
 
-		int c = getopt_long (argc, argv, "VhABCD:Eqo:", long_options, &option_index);
+		int c = getopt_long (argc, argv, "VhABCD:EF:qo:", long_options, &option_index);
 
 		if (c == -1) {
 			break;
@@ -171,6 +173,9 @@ main (int argc, char* argv[])
 		case 'E':
 			verification_options.check_picture_details = false;
 			break;
+		case 'F':
+			verification_options.picture_sampling = dcp::PictureSampling::every_nth_frame(std::max(1, dcp::raw_convert<int>(optarg)));
+			break;
 		case 'q':
 			quiet = true;
 			break;